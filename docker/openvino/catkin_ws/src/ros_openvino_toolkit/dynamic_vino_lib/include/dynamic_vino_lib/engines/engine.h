@@ -23,6 +23,11 @@
 
 #pragma once
 
+#include <functional>
+#include <mutex>
+#include <string>
+#include <vector>
+
 #include "dynamic_vino_lib/models/base_model.h"
 #include "inference_engine.hpp"
 
@@ -37,31 +42,95 @@ class Engine
 {
  public:
   /**
-   * @brief Create an NetworkEngine instance
-   * from a inference plugin and an inference network.
+   * @brief Create an NetworkEngine instance whose requests are scheduled by
+   * the InferenceScheduler on the instances of a device, sharing the network
+   * loaded there with the other engines of the same model.
+   * @param[in] device The name of target device (CPU, GPU, FPGA, MYRIAD).
+   * @param[in] request_num The number of infer requests, spread over the
+   * instances of the device.
+   * @param[in] dynamic_batch Whether to load the network with dynamic
+   * batching.
+   * @param[in] priority Requests of higher priority are started first when
+   * the device is busy.
    */
-  Engine(InferenceEngine::InferencePlugin, Models::BaseModel::Ptr);
+  Engine(const std::string& device, Models::BaseModel::Ptr, int request_num,
+         bool dynamic_batch, int priority);
   /**
-   * @brief Get the inference request this instance holds.
-   * @return The inference request this instance holds.
+   * @brief Get the first inference request this instance holds.
+   * @return The first inference request this instance holds.
    */
   inline InferenceEngine::InferRequest::Ptr& getRequest()
   {
-    return request_;
+    return requests_[0];
+  }
+  /**
+   * @brief Get the inference request with the given id.
+   * @param[in] request_id Id of the request, in [0, getRequestNum()).
+   * @return The inference request with the given id.
+   */
+  inline InferenceEngine::InferRequest::Ptr& getRequest(int request_id)
+  {
+    return requests_[request_id];
   }
   /**
-   * @brief Set a callback function for the infer request.
-   * @param[in] callbackToSet A lambda function as callback function.
-   * The callback function will be called when request is finished.
+   * @brief Get the number of inference requests this instance holds.
    */
-  template <typename T>
-  void setCompletionCallback(const T& callbackToSet)
+  inline int getRequestNum() const
   {
-    request_->SetCompletionCallback(callbackToSet);
+    return static_cast<int>(requests_.size());
   }
+  /**
+   * @brief Whether the network is loaded with dynamic batching.
+   */
+  inline bool isDynamicBatch() const
+  {
+    return dynamic_batch_;
+  }
+  /**
+   * @brief Take an idle request out of the pool, on the least loaded
+   * instance of the device.
+   * @return Id of the acquired request, or -1 if all requests are busy.
+   */
+  int acquireRequest();
+  /**
+   * @brief Grow the pool by one request, on the least loaded instance of the
+   * device, and acquire it. Must not be called while requests of the engine
+   * are running, as running requests are looked up by id without locking.
+   * @return Id of the added request.
+   */
+  int addRequest();
+  /**
+   * @brief Give a request acquired by acquireRequest back to the pool.
+   * @param[in] request_id Id of the request to be released.
+   */
+  void releaseRequest(int request_id);
+  /**
+   * @brief Start an acquired request, at once or when the scheduler lets it.
+   * @param[in] request_id Id of the request to be started.
+   */
+  void startRequest(int request_id);
+  /**
+   * @brief Set a callback function for all the infer requests.
+   * @param[in] callbackToSet The callback function, called with the id of
+   * the request when it is finished.
+   */
+  void setCompletionCallback(const std::function<void(int)>& callbackToSet);
 
  private:
-  InferenceEngine::InferRequest::Ptr request_;
+  void setRequestCallback(int request_id);
+
+  /**< networks loaded on the instances of the device, the requests are
+   * created on >**/
+  std::vector<InferenceEngine::ExecutableNetwork> networks_;
+  std::vector<int> network_instances_;
+  std::vector<InferenceEngine::InferRequest::Ptr> requests_;
+  std::vector<bool> requests_busy_;
+  std::mutex requests_mutex_;
+  bool dynamic_batch_ = false;
+  int priority_ = 0;
+  /**< scheduler instance each request is created on >**/
+  std::vector<int> request_instances_;
+  std::function<void(int)> callback_;
 };
 }  // namespace Engines
 
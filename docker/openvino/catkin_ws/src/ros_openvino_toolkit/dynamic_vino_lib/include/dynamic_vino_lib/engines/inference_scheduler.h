@@ -0,0 +1,177 @@
+/*
+ * Copyright (c) 2018 Intel Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * @brief A header file with declaration for InferenceScheduler class
+ * @file inference_scheduler.h
+ */
+#ifndef DYNAMIC_VINO_LIB_ENGINES_INFERENCE_SCHEDULER_H
+#define DYNAMIC_VINO_LIB_ENGINES_INFERENCE_SCHEDULER_H
+
+#pragma once
+
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <queue>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#include "dynamic_vino_lib/models/base_model.h"
+#include "inference_engine.hpp"
+
+namespace Engines
+{
+/**
+ * @class InferenceScheduler
+ * @brief This class owns the inference devices of the process and schedules
+ * the infer requests of all the pipelines on them.
+ *
+ * A device may have several instances, e.g. one per Neural Compute Stick for
+ * MYRIAD, where the plugin boots a free stick for each copy of a network it
+ * loads. A model is loaded once on every instance of a device, and the loaded
+ * networks are shared by all the engines using the model there. At most queue depth requests are started on an instance
+ * at once, further ones wait in the scheduler and are started by priority.
+ */
+class InferenceScheduler
+{
+ public:
+  /**
+   * @brief A network loaded on an instance of a device.
+   */
+  struct LoadedNetwork
+  {
+    int instance;
+    InferenceEngine::ExecutableNetwork network;
+  };
+
+  /**
+   * @brief Get the singleton instance of InferenceScheduler class.
+   * The instance will be created when first call.
+   * @return The reference of InferenceScheduler instance.
+   */
+  static InferenceScheduler& getInstance()
+  {
+    static InferenceScheduler scheduler_;
+    return scheduler_;
+  }
+  /**
+   * @brief Set how the devices are created, before the first network is
+   * loaded. Later calls are ignored once a device is created, with a
+   * warning if they ask for other settings.
+   * @param[in] myriad_device_num Number of MYRIAD instances.
+   * @param[in] queue_depth Max number of requests started on an instance.
+   * @param[in] custom_cpu_library Absolute path to CPU library with user
+   * layers.
+   * @param[in] custom_cldnn_library clDNN custom kernels path.
+   * @param[in] performance_count Enable per-layer performance report.
+   */
+  void configure(int myriad_device_num, int queue_depth,
+                 const std::string& custom_cpu_library,
+                 const std::string& custom_cldnn_library,
+                 bool performance_count);
+  /**
+   * @brief Get the networks of the model loaded on every instance of the
+   * device, loading them at the first call for the model and the device.
+   * @param[in] device The name of target device (CPU, GPU, FPGA, MYRIAD).
+   * @param[in] model The model, shared by the pipelines using it.
+   * @param[in] dynamic_batch Whether to load the network with dynamic
+   * batching. Falls back to static batch if the plugin rejects it.
+   * @param[out] dynamic_batch_loaded Whether the networks are loaded with
+   * dynamic batching.
+   */
+  std::vector<LoadedNetwork> loadNetwork(const std::string& device,
+                                         const Models::BaseModel::Ptr& model,
+                                         bool dynamic_batch,
+                                         bool& dynamic_batch_loaded);
+  /**
+   * @brief Get the number of requests started on or waiting for the
+   * instance.
+   */
+  int getLoad(int instance);
+  /**
+   * @brief Start the request on its instance, or queue it if the instance
+   * is busy. Queued requests of higher priority are started first, the ones
+   * of the same priority in order.
+   * @param[in] instance The instance the network of the request is loaded on.
+   * @param[in] priority The priority of the request.
+   * @param[in] request The request.
+   */
+  void startRequest(int instance, int priority,
+                    const InferenceEngine::InferRequest::Ptr& request);
+  /**
+   * @brief Tell the scheduler that a request started on the instance is
+   * finished, which starts the next queued request if any. Called by the
+   * completion callback of the request.
+   */
+  void finishRequest(int instance);
+
+ private:
+  struct QueuedRequest
+  {
+    int priority;
+    uint64_t sequence;
+    InferenceEngine::InferRequest::Ptr request;
+    bool operator<(const QueuedRequest& other) const
+    {
+      /**< the top of the queue is the highest priority, queued first >**/
+      return priority < other.priority ||
+             (priority == other.priority && sequence > other.sequence);
+    }
+  };
+  struct Instance
+  {
+    std::string device;
+    int running = 0;
+    std::priority_queue<QueuedRequest> queued;
+  };
+
+  InferenceScheduler(){};
+  InferenceScheduler(InferenceScheduler const&);
+  void operator=(InferenceScheduler const&);
+  /**
+   * @brief Get the ids of the instances of the device, creating them and the
+   * plugin of the device at the first call for it. Requires mutex_ to be
+   * held.
+   */
+  const std::vector<int>& getDeviceInstances(const std::string& device);
+
+  int myriad_device_num_ = 1;
+  int queue_depth_ = 2;
+  std::string custom_cpu_library_;
+  std::string custom_cldnn_library_;
+  bool performance_count_ = false;
+
+  std::mutex mutex_;
+  uint64_t sequence_ = 0;
+  std::vector<Instance> instances_;
+  std::map<std::string, InferenceEngine::InferencePlugin> plugins_;
+  std::map<std::string, std::vector<int>> device_instances_;
+  /**< networks loaded by model, device and batch mode, with the model kept
+   * alive for the key to stay unique >**/
+  typedef std::tuple<const Models::BaseModel*, std::string, bool> NetworkKey;
+  struct LoadedModel
+  {
+    Models::BaseModel::Ptr model;
+    bool dynamic_batch;
+    std::vector<LoadedNetwork> networks;
+  };
+  std::map<NetworkKey, LoadedModel> networks_;
+};
+}  // namespace Engines
+
+#endif  // DYNAMIC_VINO_LIB_ENGINES_INFERENCE_SCHEDULER_H
@@ -21,13 +21,20 @@
 #ifndef DYNAMIC_VINO_LIB_INFERENCES_BASE_INFERENCE_H
 #define DYNAMIC_VINO_LIB_INFERENCES_BASE_INFERENCE_H
 
+#include <chrono>
+#include <functional>
+#include <map>
 #include <memory>
+#include <mutex>
 #include <string>
+#include <vector>
 
 #include "dynamic_vino_lib/engines/engine.h"
 #include "dynamic_vino_lib/slog.h"
+#include "dynamic_vino_lib/task_arena.h"
 #include "inference_engine.hpp"
 #include "opencv2/opencv.hpp"
+#include "samples/image_to_blob.hpp"
 
 namespace Outputs
 {
@@ -35,6 +42,8 @@ class BaseOutput;
 }
 /**
  * @brief Load a frame into the input blob(memory).
+ * The frame is resized, split into planes and scaled by one fused kernel
+ * writing straight into the blob memory.
  * @param[in] orig_image frame to be put.
  * @param[in] blob Blob that points to memory.
  * @param[in] scale_factor Scale factor for loading.
@@ -45,32 +54,55 @@ void matU8ToBlob(const cv::Mat& orig_image, InferenceEngine::Blob::Ptr& blob,
                  float scale_factor = 1.0, int batch_index = 0)
 {
   InferenceEngine::SizeVector blob_size = blob->getTensorDesc().getDims();
-  // const size_t width = blob_size[3];
   const int width = blob_size[3];
-  // const size_t height = blob_size[2];
   const int height = blob_size[2];
-  // const size_t channels = blob_size[1];
   const int channels = blob_size[1];
-  T* blob_data = blob->buffer().as<T*>();
-
-  cv::Mat resized_image(orig_image);
-  if (width != orig_image.size().width || height != orig_image.size().height)
+  if (orig_image.channels() != channels)
   {
-    cv::resize(orig_image, resized_image, cv::Size(width, height));
+    throw std::logic_error("Number of channels of the frame(" +
+                           std::to_string(orig_image.channels()) +
+                           ") does not match the input blob(" +
+                           std::to_string(channels) + ")");
   }
-  int batchOffset = batch_index * width * height * channels;
+  T* blob_data = blob->buffer().as<T*>() +
+                 static_cast<size_t>(batch_index) * width * height * channels;
+
+  image_to_blob::resizeToPlanar<T>(orig_image.data, orig_image.step,
+                                   orig_image.cols, orig_image.rows, channels,
+                                   blob_data, width, height, scale_factor);
+}
 
-  for (int c = 0; c < channels; c++)
+/**
+ * @brief Wrap a U8 frame into a NHWC blob without copying it, like
+ * wrapMat2Blob of the samples. A frame which is a ROI of a larger one is
+ * wrapped as a ROI blob of the larger frame.
+ * @param[in] frame Frame to be wrapped, it must outlive the blob.
+ * @return The blob, or nullptr if the rows of the (larger) frame are not
+ * contiguous.
+ */
+inline InferenceEngine::Blob::Ptr wrapMatToBlob(const cv::Mat& frame)
+{
+  cv::Size whole_size;
+  cv::Point offset;
+  frame.locateROI(whole_size, offset);
+  const size_t channels = frame.channels();
+  if (frame.depth() != CV_8U || frame.step[0] != whole_size.width * channels)
   {
-    for (int h = 0; h < height; h++)
-    {
-      for (int w = 0; w < width; w++)
-      {
-        blob_data[batchOffset + c * width * height + h * width + w] =
-            resized_image.at<cv::Vec3b>(h, w)[c] * scale_factor;
-      }
-    }
+    return nullptr;
   }
+  InferenceEngine::TensorDesc desc(
+      InferenceEngine::Precision::U8,
+      {1, channels, static_cast<size_t>(whole_size.height),
+       static_cast<size_t>(whole_size.width)},
+      InferenceEngine::Layout::NHWC);
+  InferenceEngine::Blob::Ptr blob = InferenceEngine::make_shared_blob<uint8_t>(
+      desc, const_cast<uint8_t*>(frame.datastart));
+  if (frame.cols == whole_size.width && frame.rows == whole_size.height)
+  {
+    return blob;
+  }
+  InferenceEngine::ROI roi(0, offset.x, offset.y, frame.cols, frame.rows);
+  return InferenceEngine::make_shared_blob(blob, roi);
 }
 
 namespace dynamic_vino_lib
@@ -85,9 +117,15 @@ class Result
   friend class BaseInference;
   explicit Result(const cv::Rect& location);
   inline const cv::Rect getLocation() const { return location_; }
+  /**
+   * @brief Get the index of the input frame this result belongs to, in a
+   * pipeline infering the frames of several input channels together.
+   */
+  inline const int getFrameIndex() const { return frame_index_; }
 
  private:
   cv::Rect location_;
+  int frame_index_ = 0;
 };
 
 /**
@@ -120,6 +158,15 @@ class BaseInference
   {
     return enqueued_frames;
   }
+  /**
+   * @brief Get the number of infer requests holding the enqueued frames,
+   * i.e. the number of requests started by the next submitRequest.
+   * Frames beyond the max batch size are put into further requests.
+   */
+  inline const int getEnqueuedRequestNum() const
+  {
+    return static_cast<int>(enqueue_requests_.size());
+  }
   /**
    * @brief Enqueue a frame to this class.
    * The frame will be buffered but not infered yet.
@@ -146,6 +193,60 @@ class BaseInference
    * @return Whether the Inference object fetches a result this time
    */
   virtual bool fetchResults();
+  /**
+   * @brief Fetch the results of a finished infer request by fetchResults, and
+   * give the request back to the request pool of the engine.
+   * @param[in] request_id Id of the finished request, as passed to the
+   * completion callback of the engine.
+   * @return Whether the results of all the requests started by the last
+   * submitRequest are fetched.
+   */
+  bool collectResults(int request_id);
+  /**
+   * @brief Get the milliseconds since the given request was started by
+   * submitRequest, i.e. its time on the device when called upon completion.
+   * @param[in] request_id Id of the request.
+   */
+  double getRequestElapsedMs(int request_id) const;
+  /**
+   * @brief Accumulate the per-layer performance counts of every finished
+   * request. The plugin must be created with performance counting enabled.
+   */
+  inline void enablePerformanceCount(bool enable)
+  {
+    enable_performance_count_ = enable;
+  }
+  /**
+   * @brief Set the task arena the enqueued frames are loaded into the input
+   * blobs on, in parallel. They are loaded one after another if not set.
+   */
+  inline void setTaskArena(const std::shared_ptr<TaskArena>& task_arena)
+  {
+    task_arena_ = task_arena;
+  }
+  /**
+   * @brief Set the index of the input frame the frames enqueued from now on
+   * belong to. Their results keep it, see Result::getFrameIndex.
+   */
+  inline void setEnqueueFrameIndex(int frame_index)
+  {
+    enqueue_frame_index_ = frame_index;
+  }
+  /**
+   * @brief Only hand the results of the given input frame to outputs in
+   * observeOutput, -1 for all results.
+   */
+  inline void setOutputFrameIndex(int frame_index)
+  {
+    output_frame_index_ = frame_index;
+  }
+  /**
+   * @brief Get the per-layer performance counts averaged over all the
+   * requests finished so far, in the format of
+   * InferRequest::GetPerformanceCounts.
+   */
+  std::map<std::string, InferenceEngine::InferenceEngineProfileInfo>
+  getPerformanceCounts();
   /**
    * @brief Get the length of the buffer result array.
    */
@@ -172,31 +273,171 @@ class BaseInference
   bool enqueue(const cv::Mat& frame, const cv::Rect&, float scale_factor,
                int batch_index, const std::string& input_name)
   {
-    if (enqueued_frames == max_batch_size_)
+    int request_index = batch_index / max_batch_size_;
+    while (getEnqueuedRequestNum() <= request_index)
     {
-      slog::warn << "Number of " << getName() << "input more than maximum("
-                 << max_batch_size_ << ") processed by inference" << slog::endl;
-      return false;
+      int request_id = engine_->acquireRequest();
+      if (request_id < 0)
+      {
+        /**< all the requests hold frames of this batch, none is running:
+         * the pool grows to the number of frames instead of dropping them >**/
+        request_id = engine_->addRequest();
+        growRequestBuffers();
+        slog::info << "Number of " << getName() << " input more than "
+                   << max_batch_size_ * (engine_->getRequestNum() - 1)
+                   << ", infer requests increased to "
+                   << engine_->getRequestNum() << slog::endl;
+      }
+      enqueue_requests_.push_back(request_id);
+    }
+    int request_id = enqueue_requests_[request_index];
+    if (auto_resize_)
+    {
+      /**< the request reads the frame memory, which is held until the
+       * results are fetched. A frame which can not be wrapped is copied. >**/
+      InferenceEngine::Blob::Ptr frame_blob = wrapMatToBlob(frame);
+      request_frames_[request_id] = frame;
+      if (frame_blob == nullptr)
+      {
+        request_frames_[request_id] = frame.clone();
+        frame_blob = wrapMatToBlob(request_frames_[request_id]);
+      }
+      engine_->getRequest(request_id)->SetBlob(input_name, frame_blob);
+      enqueue_frame_indices_.push_back(enqueue_frame_index_);
+      enqueued_frames += 1;
+      return true;
     }
     InferenceEngine::Blob::Ptr input_blob =
-        engine_->getRequest()->GetBlob(input_name);
-    matU8ToBlob<T>(frame, input_blob, scale_factor, batch_index);
+        engine_->getRequest(request_id)->GetBlob(input_name);
+    /**< frames are resized into the blob by submitRequest, all of them in
+     * parallel. The frame is held until then. >**/
+    int blob_index = batch_index % max_batch_size_;
+    pending_loads_.push_back(
+        [frame, input_blob, scale_factor, blob_index]() mutable
+        {
+          matU8ToBlob<T>(frame, input_blob, scale_factor, blob_index);
+        });
+    enqueue_frame_indices_.push_back(enqueue_frame_index_);
     enqueued_frames += 1;
     return true;
   }
   /**
-   * @brief Set the max batch size for one inference.
+   * @brief Take the max batch size for one inference from the model, and
+   * whether the enqueued frames are handed over to the inference engine in
+   * place, to be resized by it (see BaseModel::setAutoResize).
+   */
+  inline void loadModelProperties(const Models::BaseModel::Ptr& model)
+  {
+    max_batch_size_ = model->getMaxBatchSize();
+    auto_resize_ = model->isAutoResize();
+  }
+  /**
+   * @brief Get the infer request whose results are being fetched.
+   * Only valid inside fetchResults.
+   */
+  inline InferenceEngine::InferRequest::Ptr getResultRequest() const
+  {
+    return engine_->getRequest(result_request_id_);
+  }
+  /**
+   * @brief Get the batch index of the first frame in the request whose
+   * results are being fetched, with respect to all frames enqueued before
+   * the last submitRequest. Only valid inside fetchResults.
+   */
+  inline int getResultBatchBegin() const
+  {
+    return request_batch_begin_[result_request_id_];
+  }
+  /**
+   * @brief Get the number of frames in the request whose results are being
+   * fetched. Only valid inside fetchResults.
+   */
+  inline int getResultBatchSize() const
+  {
+    return request_batch_size_[result_request_id_];
+  }
+  /**
+   * @brief Tag a result created by enqueue with the input frame set by
+   * setEnqueueFrameIndex.
+   */
+  inline void setEnqueuedFrame(Result& result) const
+  {
+    result.frame_index_ = enqueue_frame_index_;
+  }
+  /**
+   * @brief Tag a result with the input frame of the given item of the request
+   * whose results are being fetched. Only valid inside fetchResults.
+   * @param[in] batch_item Index of the frame within the request.
+   */
+  inline void setFetchedFrame(Result& result, int batch_item) const
+  {
+    result.frame_index_ =
+        submit_frame_indices_[getResultBatchBegin() + batch_item];
+  }
+  /**
+   * @brief Select the results to hand to outputs, as set by
+   * setOutputFrameIndex.
+   * @param[in] results All the results of the inference.
+   * @param[out] selected Buffer of the selected results if not all of them.
+   * @return Either results or selected.
    */
-  inline void setMaxBatchSize(int max_batch_size)
+  template <typename T>
+  const std::vector<T>& selectOutputResults(const std::vector<T>& results,
+                                            std::vector<T>& selected) const
   {
-    max_batch_size_ = max_batch_size;
+    if (output_frame_index_ < 0)
+    {
+      return results;
+    }
+    selected.clear();
+    for (auto& result : results)
+    {
+      if (result.getFrameIndex() == output_frame_index_)
+      {
+        selected.push_back(result);
+      }
+    }
+    return selected;
   }
 
  private:
+  /**
+   * @brief Size the buffers kept per request to the requests of the engine.
+   */
+  void growRequestBuffers();
+
   std::shared_ptr<Engines::Engine> engine_;
   int max_batch_size_ = 1;
   int enqueued_frames = 0;
-  bool results_fetched_ = false;
+  /**< requests the enqueued frames are loaded into, in batch order >**/
+  std::vector<int> enqueue_requests_;
+  /**< input frame of each enqueued frame, in batch order, and of each frame
+   * of the last submitRequest >**/
+  int enqueue_frame_index_ = 0;
+  int output_frame_index_ = -1;
+  std::vector<int> enqueue_frame_indices_;
+  std::vector<int> submit_frame_indices_;
+  /**< loads of the enqueued frames into the input blobs >**/
+  std::vector<std::function<void()>> pending_loads_;
+  std::shared_ptr<TaskArena> task_arena_;
+  /**< first batch index and number of frames of each request, by id >**/
+  std::vector<int> request_batch_begin_;
+  std::vector<int> request_batch_size_;
+  /**< requests started by the last submitRequest, not fetched yet >**/
+  int unfetched_requests_ = 0;
+  /**< finished request being fetched, -1 if none >**/
+  int result_request_id_ = -1;
+  std::mutex fetch_mutex_;
+  /**< time each request was started at, by id >**/
+  std::vector<std::chrono::high_resolution_clock::time_point> request_start_;
+  bool enable_performance_count_ = false;
+  bool auto_resize_ = false;
+  /**< frames the requests read with auto resize, by id >**/
+  std::vector<cv::Mat> request_frames_;
+  /**< per-layer counts summed over perf_count_requests_ requests >**/
+  std::map<std::string, InferenceEngine::InferenceEngineProfileInfo>
+      perf_counts_;
+  int perf_count_requests_ = 0;
 };
 }  // namespace dynamic_vino_lib
 
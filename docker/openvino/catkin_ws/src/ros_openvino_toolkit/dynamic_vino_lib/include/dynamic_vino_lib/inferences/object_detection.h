@@ -39,6 +39,7 @@ namespace dynamic_vino_lib {
 class ObjectDetectionResult : public Result {
  public:
   friend class ObjectDetection;
+  friend class ObjectDetectionYolo;
   explicit ObjectDetectionResult(const cv::Rect& location);
   std::string getLabel() const { return label_; }
   /**
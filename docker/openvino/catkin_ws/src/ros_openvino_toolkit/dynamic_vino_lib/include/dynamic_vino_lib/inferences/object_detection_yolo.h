@@ -0,0 +1,114 @@
+/*
+ * Copyright (c) 2018 Intel Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/**
+ * @brief A header file with declaration for ObjectDetectionYolo Class
+ * @file object_detection_yolo.h
+ */
+#ifndef DYNAMIC_VINO_LIB_INFERENCES_OBJECT_DETECTION_YOLO_H
+#define DYNAMIC_VINO_LIB_INFERENCES_OBJECT_DETECTION_YOLO_H
+#include <memory>
+#include <vector>
+#include <string>
+#include "dynamic_vino_lib/models/object_detection_yolo_model.h"
+#include "dynamic_vino_lib/engines/engine.h"
+#include "dynamic_vino_lib/inferences/base_inference.h"
+#include "dynamic_vino_lib/inferences/object_detection.h"
+#include "inference_engine.hpp"
+#include "opencv2/opencv.hpp"
+#include "samples/nms.hpp"
+// namespace
+namespace dynamic_vino_lib {
+/**
+ * @class ObjectDetectionYolo
+ * @brief Class to load a YOLO model and perform object detection. The results
+ * are the same as the ones of ObjectDetection, for the same outputs.
+ */
+class ObjectDetectionYolo : public BaseInference {
+ public:
+  using Result = dynamic_vino_lib::ObjectDetectionResult;
+  /**
+   * @param[in] show_output_thresh Min confidence of the detections.
+   * @param[in] iou_thresh Detections of a class overlapping a more confident
+   * one of the same class by this intersection over union are suppressed.
+   */
+  ObjectDetectionYolo(double show_output_thresh, double iou_thresh = 0.4);
+  ~ObjectDetectionYolo() override;
+  /**
+   * @brief Load the YOLO object detection model.
+   */
+  void loadNetwork(std::shared_ptr<Models::ObjectDetectionYoloModel>);
+  /**
+   * @brief Enqueue a frame to this class.
+   * The frame will be buffered but not infered yet.
+   * @param[in] frame The frame to be enqueued.
+   * @param[in] input_frame_loc The location of the enqueued frame with respect
+   * to the frame generated by the input device.
+   * @return Whether this operation is successful.
+   */
+  bool enqueue(const cv::Mat&, const cv::Rect&) override;
+  /**
+   * @brief Start inference for all buffered frames.
+   * @return Whether this operation is successful.
+   */
+  bool submitRequest() override;
+  /**
+   * @brief Decode the boxes of the region outputs whose objectness is above
+   * the threshold, then suppress overlapping boxes of the same class, for
+   * each frame of the request.
+   * @return Whether the Inference object fetches a result this time
+   */
+  bool fetchResults() override;
+  /**
+   * @brief Get the length of the buffer result array.
+   * @return The length of the buffer result array.
+   */
+  const int getResultsLength() const override;
+  /**
+   * @brief Get the location of result with respect
+   * to the frame generated by the input device.
+   * @param[in] idx The index of the result.
+   */
+  const dynamic_vino_lib::Result* getLocationResult(int idx) const override;
+  /**
+   * @brief Show the observed detection result either through image window
+     or ROS topic.
+   */
+  const void observeOutput(const std::shared_ptr<Outputs::BaseOutput>& output);
+  /**
+   * @brief Get the name of the Inference instance.
+   * @return The name of the Inference instance.
+   */
+  const std::string getName() const override;
+ private:
+  void decodeRegion(const Models::ObjectDetectionYoloModel::Region& region,
+                    const float* blob);
+  void suppressOverlaps(int item);
+
+  std::shared_ptr<Models::ObjectDetectionYoloModel> valid_model_;
+  std::vector<Result> results_;
+  /**< buffers of fetchResults, kept to reuse their memory >**/
+  std::vector<int> cells_;
+  /**< candidate boxes, corners relative to the frame size >**/
+  nms::BoxSet boxes_;
+  nms::Suppressor suppressor_;
+  std::vector<int> kept_;
+  int width_ = 0;
+  int height_ = 0;
+  double show_output_thresh_ = 0;
+  double iou_thresh_ = 0;
+};
+}  // namespace dynamic_vino_lib
+#endif  // DYNAMIC_VINO_LIB_INFERENCES_OBJECT_DETECTION_YOLO_H
@@ -0,0 +1,105 @@
+/*
+ * Copyright (c) 2018 Intel Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * @brief A header file with declaration for PersonGallery Class
+ * @file person_gallery.h
+ */
+#ifndef DYNAMIC_VINO_LIB_INFERENCES_PERSON_GALLERY_H
+#define DYNAMIC_VINO_LIB_INFERENCES_PERSON_GALLERY_H
+
+#include <chrono>
+#include <string>
+#include <vector>
+
+namespace dynamic_vino_lib
+{
+/**
+ * @class PersonGallery
+ * @brief The persons recorded by person reidentification, each as the
+ * L2-normalized embedding of its last appearance. Embeddings are stored
+ * contiguously so that a frame's worth of queries is matched against the
+ * gallery in one pass. The gallery is bounded: persons not seen for max_age
+ * seconds are dropped, and the least recently seen person makes room for a
+ * new one when it is full.
+ */
+class PersonGallery
+{
+ public:
+  typedef std::chrono::steady_clock Clock;
+  /**
+   * @param[in] capacity Max number of recorded persons, 0 for no limit.
+   * @param[in] max_age Seconds after which a person not seen is dropped,
+   * 0 to keep persons until evicted by capacity.
+   */
+  explicit PersonGallery(int capacity = 0, double max_age = 0);
+  /**
+   * @brief Match a batch of embeddings against the recorded persons. Each
+   * recorded person is matched to at most one embedding, pairs are taken in
+   * the order of descending cosine similarity. Matched persons take the new
+   * embedding, unmatched embeddings are recorded as new persons.
+   * @param[in] embeddings count embeddings of dim floats each, row by row,
+   * not necessarily normalized.
+   * @param[in] count Number of embeddings.
+   * @param[in] dim Length of each embedding.
+   * @param[in] threshold Min cosine similarity of a match.
+   * @return Id of the person of each embedding.
+   */
+  std::vector<int> match(const float* embeddings, int count, int dim,
+                         float threshold);
+  /**
+   * @brief Save the recorded persons to a binary file.
+   * @return Whether the file is written.
+   */
+  bool save(const std::string& path) const;
+  /**
+   * @brief Replace the recorded persons with the ones in a file written by
+   * save. Loaded persons count as just seen.
+   * @return Whether the file is read.
+   */
+  bool load(const std::string& path);
+  inline int size() const
+  {
+    return static_cast<int>(ids_.size());
+  }
+  inline int getDim() const
+  {
+    return dim_;
+  }
+
+ private:
+  void dropExpired(const Clock::time_point& now);
+  /**
+   * @brief Remove the person at index by moving the last one into its place.
+   */
+  void remove(int index);
+  int add(const float* normalized, const Clock::time_point& now);
+
+  int capacity_;
+  double max_age_;
+  int dim_ = 0;
+  int next_id_ = 0;
+  /**< size() * dim_ normalized embeddings, row by row >**/
+  std::vector<float> embeddings_;
+  std::vector<int> ids_;
+  std::vector<Clock::time_point> last_seen_;
+  /**< scratch buffers reused by match >**/
+  std::vector<float> queries_;
+  std::vector<float> similarities_;
+};
+}  // namespace dynamic_vino_lib
+
+#endif  // DYNAMIC_VINO_LIB_INFERENCES_PERSON_GALLERY_H
@@ -24,6 +24,7 @@
 #include "dynamic_vino_lib/models/person_reidentification_model.h"
 #include "dynamic_vino_lib/engines/engine.h"
 #include "dynamic_vino_lib/inferences/base_inference.h"
+#include "dynamic_vino_lib/inferences/person_gallery.h"
 #include "inference_engine.hpp"
 #include "opencv2/opencv.hpp"
 // namespace
@@ -51,7 +52,20 @@ class PersonReidentification : public BaseInference
 {
 public:
   using Result = dynamic_vino_lib::PersonReidentificationResult;
-  explicit PersonReidentification(double);
+  /**
+   * @param[in] match_thresh Min cosine similarity to a recorded person for
+   * being identified as the person.
+   * @param[in] gallery_capacity Max number of recorded persons, 0 for no
+   * limit.
+   * @param[in] gallery_max_age Seconds after which a person not seen is
+   * forgotten, 0 for never.
+   * @param[in] gallery_path File the recorded persons are loaded from and
+   * saved to on destruction, empty for none.
+   */
+  explicit PersonReidentification(double match_thresh,
+                                  int gallery_capacity = 0,
+                                  double gallery_max_age = 0,
+                                  const std::string& gallery_path = "");
   ~PersonReidentification() override;
   /**
    * @brief Load the face detection model.
@@ -107,7 +121,8 @@ public:
   float calcSimilarity(const std::vector<float> &, const std::vector<float> &);
   /**
    * @brief Try to find the matched person from the recorded persons, if there are not,
-   * record it in the recorded persons.
+   * record it in the recorded persons. ROIs infered by the pipeline are
+   * matched a frame at a time instead, see PersonGallery::match.
    * @return The id of the matched person (or the new person).
    */
   std::string findMatchPerson(const std::vector<float> &);
@@ -115,7 +130,11 @@ public:
 private:
   std::shared_ptr<Models::PersonReidentificationModel> valid_model_;
   std::vector<Result> results_;
-  std::vector<std::vector<float>> recorded_persons_;
+  /**< embeddings of the enqueued ROIs, matched at once when all fetched >**/
+  std::vector<float> embeddings_;
+  int fetched_embeddings_ = 0;
+  PersonGallery gallery_;
+  std::string gallery_path_;
   double match_thresh_ = 0;
 };
 }  // namespace dynamic_vino_lib
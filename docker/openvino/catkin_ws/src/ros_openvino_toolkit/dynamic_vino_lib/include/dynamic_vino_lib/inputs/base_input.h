@@ -21,7 +21,11 @@
 #ifndef DYNAMIC_VINO_LIB_INPUTS_BASE_INPUT_H
 #define DYNAMIC_VINO_LIB_INPUTS_BASE_INPUT_H
 
+#include <ros/ros.h>
+#include <std_msgs/Header.h>
 #include <opencv2/opencv.hpp>
+#include <memory>
+#include <string>
 #include "dynamic_vino_lib/inputs/ros_handler.h"
 
 /**
@@ -57,6 +61,15 @@ class BaseInputDevice : public Ros2Handler
    * @return Whether the next frame is successfully read.
    */
   virtual bool read(cv::Mat* frame) = 0;
+  /**
+   * @brief Whether the frame just read was not read before. Devices which
+   * may return the same frame again, e.g. topic subscribers with no new
+   * message, override it so that pipelines do not infer a frame twice.
+   */
+  virtual bool isNewFrame()
+  {
+    return true;
+  }
   virtual void config() = 0;  //< TODO
   virtual ~BaseInputDevice() = default;
   /**
@@ -123,12 +136,34 @@ class BaseInputDevice : public Ros2Handler
   {
     return frame_id_;
   }
+  /**
+   * @brief Get the header of the frame just read. Devices without their own
+   * timestamps stamp the frame with the current time.
+   * @return The header of the frame just read.
+   */
+  virtual std_msgs::Header getHeader()
+  {
+    std_msgs::Header header;
+    header.stamp = ros::Time::now();
+    header.frame_id = frame_id_;
+    return header;
+  }
+  /**
+   * @brief Get the owner of the memory of the frame just read, for devices
+   * whose frames do not own their memory, e.g. frames sharing the buffer of
+   * an image message. The frame is valid as long as the owner is held.
+   * @return The owner, or nullptr if the frame owns its memory.
+   */
+  virtual std::shared_ptr<const void> getFrameOwner()
+  {
+    return nullptr;
+  }
 
  private:
   size_t width_ = 0;
   size_t height_ = 0;
   bool is_init_ = false;
-  std::string frame_id_;
+  std::string frame_id_ = "default_camera";
 };
 }  // namespace Input
 #endif  // DYNAMIC_VINO_LIB_INPUTS_BASE_INPUT_H
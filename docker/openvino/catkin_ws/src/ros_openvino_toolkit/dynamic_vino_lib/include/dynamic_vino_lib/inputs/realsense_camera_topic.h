@@ -22,13 +22,16 @@
 #ifndef DYNAMIC_VINO_LIB_INPUTS_REALSENSE_CAMERA_TOPIC_H
 #define DYNAMIC_VINO_LIB_INPUTS_REALSENSE_CAMERA_TOPIC_H
 
+#include <cv_bridge/cv_bridge.h>
 #include <image_transport/image_transport.h>
 #include <nodelet/nodelet.h>
 #include <ros/ros.h>
 #include <sensor_msgs/Image.h>
 #include <opencv2/opencv.hpp>
 
+#include <atomic>
 #include <memory>
+#include <string>
 
 #include "dynamic_vino_lib/inputs/base_input.h"
 
@@ -37,11 +40,27 @@ namespace Input
 /**
  * @class RealSenseCameraTopic
  * @brief Class for recieving a realsense camera topic as input.
+ * Frames share the memory of the received image messages. The subscriber
+ * only swaps the latest message into a lock-free slot, messages not read
+ * in time are dropped without being converted.
  */
 class RealSenseCameraTopic : public BaseInputDevice
 {
  public:
-  RealSenseCameraTopic();
+  /**
+   * @param[in] topic The image topic to subscribe to.
+   */
+  explicit RealSenseCameraTopic(const std::string& topic = kDefaultTopic);
+  /**
+   * @brief Subscribe with the given node handle, e.g. the one of a nodelet.
+   * Its callbacks are served by the owner of the node handle, read() does
+   * not spin them.
+   * @param[in] nh The node handle to subscribe with.
+   * @param[in] topic The image topic to subscribe to.
+   */
+  explicit RealSenseCameraTopic(const ros::NodeHandle& nh,
+                                const std::string& topic = kDefaultTopic);
+  ~RealSenseCameraTopic();
   bool initialize() override;
   bool initialize(int t) override
   {
@@ -51,14 +70,43 @@ class RealSenseCameraTopic : public BaseInputDevice
   {
     return true;
   };
+  /**
+   * @brief Read the latest received frame, or the last read one if no new
+   * frame has arrived. The frame refers to the image message, see
+   * getFrameOwner.
+   */
   bool read(cv::Mat* frame) override;
+  /**
+   * @brief Whether a new frame had arrived for the last read().
+   */
+  bool isNewFrame() override
+  {
+    return new_frame_;
+  }
+  /**
+   * @brief Get the header of the image message of the frame just read.
+   */
+  std_msgs::Header getHeader() override;
+  /**
+   * @brief Get the image message of the frame just read, which holds the
+   * memory of the frame.
+   */
+  std::shared_ptr<const void> getFrameOwner() override;
   void config() override;
 
+  static constexpr const char* kDefaultTopic = "/camera/color/image_raw";
+
  private:
   ros::NodeHandle nh_;
+  std::string topic_;
+  /**< whether read() spins the global callback queue for the subscriber >**/
+  bool spin_;
   image_transport::Subscriber sub_;
-  cv::Mat image;
-  cv::Mat last_image;
+  /**< latest received frame not read yet, owned by whoever swaps it out >**/
+  std::atomic<cv_bridge::CvImageConstPtr*> latest_frame_;
+  /**< frame just read >**/
+  cv_bridge::CvImageConstPtr current_frame_;
+  bool new_frame_ = false;
 
   void cb(const sensor_msgs::ImageConstPtr& image_msg);
 };
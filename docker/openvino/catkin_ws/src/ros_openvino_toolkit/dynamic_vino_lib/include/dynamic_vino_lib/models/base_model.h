@@ -31,6 +31,7 @@
 namespace Engines
 {
 class Engine;
+class InferenceScheduler;
 }
 
 namespace Models
@@ -50,7 +51,8 @@ class BaseModel
    * @param[in] model_loc The location of model' s .xml file
    * (model' s bin file should be the same as .xml file except for extension)
    * @param[in] input_num The number of input the network should have.
-   * @param[in] output_num The number of output the network should have.
+   * @param[in] output_num The number of output the network should have, 0
+   * for any number.
    * @param[in] batch_size The number of batch size the network should have.
    * @return Whether the input device is successfully turned on.
    */
@@ -72,6 +74,22 @@ class BaseModel
   {
     return max_batch_size_;
   }
+  /**
+   * @brief Let the inference engine resize the input, fed with U8 NHWC blobs
+   * of any size, instead of the host. The batch size is then 1.
+   * Must be set before modelInit.
+   */
+  inline void setAutoResize(bool auto_resize)
+  {
+    auto_resize_ = auto_resize;
+  }
+  /**
+   * @brief Get whether the inference engine resizes the input.
+   */
+  inline const bool isAutoResize() const
+  {
+    return auto_resize_;
+  }
   /**
    * @brief Initialize the model. During the process the class will check
    * the network input, output size, check layer property and
@@ -101,15 +119,18 @@ class BaseModel
 
  private:
   friend class Engines::Engine;
+  friend class Engines::InferenceScheduler;
 
   void checkNetworkSize(unsigned int, unsigned int,
                         InferenceEngine::CNNNetReader::Ptr);
+  void setAutoResizeProperty(InferenceEngine::CNNNetReader::Ptr);
   InferenceEngine::CNNNetReader::Ptr net_reader_;
   std::vector<std::string> labels_;
   int input_num_;
   int output_num_;
   std::string model_loc_;
   int max_batch_size_;
+  bool auto_resize_ = false;
 };
 }  // namespace Models
 
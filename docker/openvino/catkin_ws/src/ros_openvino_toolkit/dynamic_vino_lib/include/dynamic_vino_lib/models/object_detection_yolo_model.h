@@ -0,0 +1,67 @@
+/*
+ * Copyright (c) 2018 Intel Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/**
+ * @brief A header file with declaration for ObjectDetectionYoloModel Class
+ * @file object_detection_yolo_model.h
+ */
+#ifndef DYNAMIC_VINO_LIB_MODELS_OBJECT_DETECTION_YOLO_MODEL_H
+#define DYNAMIC_VINO_LIB_MODELS_OBJECT_DETECTION_YOLO_MODEL_H
+#include <string>
+#include <vector>
+#include "dynamic_vino_lib/models/base_model.h"
+namespace Models {
+/**
+ * @class ObjectDetectionYoloModel
+ * @brief This class generates the YOLO object detection model, whose outputs
+ * are RegionYolo layers (YOLOv2, YOLOv3 and their tiny versions).
+ */
+class ObjectDetectionYoloModel : public BaseModel {
+ public:
+  /**
+   * @brief Parameters of one RegionYolo output.
+   */
+  struct Region {
+    std::string output;
+    int num = 0;       /**< number of anchors per cell >**/
+    int coords = 4;
+    int classes = 0;
+    int height = 0;    /**< number of cells in a column >**/
+    int width = 0;     /**< number of cells in a row >**/
+    /**< (width, height) of the anchors used by this output, in pixels of
+     * the network input >**/
+    std::vector<float> anchors;
+  };
+  ObjectDetectionYoloModel(const std::string&, int, int, int);
+  inline const std::string getInputName() { return input_; }
+  inline const int getInputWidth() { return input_width_; }
+  inline const int getInputHeight() { return input_height_; }
+  inline const std::vector<Region>& getRegions() { return regions_; }
+  /**
+   * @brief Get the name of this detection model.
+   * @return Name of the model.
+   */
+  const std::string getModelName() const override;
+ protected:
+  void checkLayerProperty(const InferenceEngine::CNNNetReader::Ptr&) override;
+  void setLayerProperty(InferenceEngine::CNNNetReader::Ptr) override;
+
+  std::string input_;
+  int input_width_ = 0;
+  int input_height_ = 0;
+  std::vector<Region> regions_;
+};
+}  // namespace Models
+#endif  // DYNAMIC_VINO_LIB_MODELS_OBJECT_DETECTION_YOLO_MODEL_H
@@ -22,6 +22,7 @@
 #ifndef DYNAMIC_VINO_LIB_OUTPUTS_BASE_OUTPUT_H
 #define DYNAMIC_VINO_LIB_OUTPUTS_BASE_OUTPUT_H
 
+#include <std_msgs/Header.h>
 #include <string>
 #include <vector>
 
@@ -104,10 +105,28 @@ class BaseOutput
   virtual void feedFrame(const cv::Mat& frame)
   {
   }
+  /**
+   * @brief Set the header of the input frame the coming results belong to,
+   * called before feedFrame.
+   * @param[in] header The header of the frame read from the input device.
+   */
+  void setHeader(const std_msgs::Header& header)
+  {
+    header_ = header;
+  }
   /**
    * @brief Show all the contents generated by the accept functions.
    */
   virtual void handleOutput() = 0;
+  /**
+   * @brief Whether the output may be handled by any thread of the task arena
+   * of the pipeline. Outputs returning false are only run by the pipeline
+   * thread, e.g. the ones driving a GUI toolkit.
+   */
+  virtual bool isThreadSafe() const
+  {
+    return true;
+  }
 
   void setPipeline(Pipeline* const pipeline);
   virtual void setServiceResponse(
@@ -132,6 +151,7 @@ class BaseOutput
 
  protected:
   cv::Mat frame_;
+  std_msgs::Header header_;
   Pipeline* pipeline_;
 };
 }  // namespace Outputs
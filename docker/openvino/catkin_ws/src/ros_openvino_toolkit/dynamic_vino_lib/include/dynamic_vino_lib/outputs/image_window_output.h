@@ -52,6 +52,13 @@ class ImageWindowOutput : public BaseOutput
    * functions with image window.
    */
   void handleOutput() override;
+  /**
+   * @brief HighGUI windows have to be driven from a single thread.
+   */
+  bool isThreadSafe() const override
+  {
+    return false;
+  }
   /**
    * @brief Generate image window output content according to
    * the face detection result.
@@ -55,6 +55,12 @@ class RosTopicOutput : public BaseOutput
 {
  public:
   RosTopicOutput();
+  /**
+   * @brief Advertise the result topics with the given node handle, e.g. the
+   * one of a nodelet.
+   * @param[in] nh The node handle to advertise with.
+   */
+  explicit RosTopicOutput(const ros::NodeHandle& nh);
   /**
    * @brief Calculate the camera matrix of a frame.
    * @param[in] A frame.
@@ -62,7 +68,9 @@ class RosTopicOutput : public BaseOutput
   void feedFrame(const cv::Mat&) override;
   /**
    * @brief Publish all the detected infomations generated by the accept
-   * functions with ros topic.
+   * functions with ros topic. The messages are published by pointer and
+   * never modified afterwards, so subscribers in the same process receive
+   * them without serialization.
    */
   void handleOutput() override;
   /**
@@ -111,25 +119,24 @@ class RosTopicOutput : public BaseOutput
 
 
  private:
-  std_msgs::Header getHeader();
   const std::string topic_name_;
   cv::Mat frame_;
   ros::NodeHandle nh_;
  protected:
   ros::Publisher pub_face_;
-  std::shared_ptr<object_msgs::ObjectsInBoxes> faces_msg_ptr_;
+  object_msgs::ObjectsInBoxes::Ptr faces_msg_ptr_;
   ros::Publisher pub_emotion_;
-  std::shared_ptr<people_msgs::EmotionsStamped> emotions_msg_ptr_;
+  people_msgs::EmotionsStamped::Ptr emotions_msg_ptr_;
   ros::Publisher pub_age_gender_;
-  std::shared_ptr<people_msgs::AgeGenderStamped> age_gender_msg_ptr_;
+  people_msgs::AgeGenderStamped::Ptr age_gender_msg_ptr_;
   ros::Publisher pub_headpose_;
-  std::shared_ptr<people_msgs::HeadPoseStamped> headpose_msg_ptr_;
+  people_msgs::HeadPoseStamped::Ptr headpose_msg_ptr_;
   ros::Publisher pub_object_;
-  std::shared_ptr<object_msgs::ObjectsInBoxes> object_msg_ptr_;
+  object_msgs::ObjectsInBoxes::Ptr object_msg_ptr_;
   ros::Publisher pub_person_reid_;
-  std::shared_ptr<people_msgs::ReidentificationStamped> person_reid_msg_ptr_;
+  people_msgs::ReidentificationStamped::Ptr person_reid_msg_ptr_;
   ros::Publisher pub_segmented_object_;
-  std::shared_ptr<people_msgs::ObjectsInMasks> segmented_object_msg_ptr_;
+  people_msgs::ObjectsInMasks::Ptr segmented_object_msg_ptr_;
 
 };
 }  // namespace Outputs
@@ -39,6 +39,12 @@ class RvizOutput : public BaseOutput
 {
 public:
   RvizOutput();
+  /**
+   * @brief Advertise the image topic with the given node handle, e.g. the
+   * one of a nodelet.
+   * @param[in] nh The node handle to advertise with.
+   */
+  explicit RvizOutput(const ros::NodeHandle& nh);
   /**
    * @brief Construct frame for rviz
    * @param[in] A frame.
@@ -46,7 +52,8 @@ public:
   void feedFrame(const cv::Mat &) override;
   /**
    * @brief Show all the contents generated by the accept
-   * functions with rviz.
+   * functions with rviz. A new image message is published by pointer each
+   * time, subscribers in the same process share it without a copy.
    */
   void handleOutput() override;
   /**
@@ -99,10 +106,8 @@ public:
    */
 
 private:
-  std_msgs::Header getHeader();
   ros::NodeHandle nh_;
   ros::Publisher pub_image_;
-  sensor_msgs::Image::Ptr image_topic_;
   std::shared_ptr<Outputs::ImageWindowOutput> image_window_output_;
 };
 }  // namespace Outputs
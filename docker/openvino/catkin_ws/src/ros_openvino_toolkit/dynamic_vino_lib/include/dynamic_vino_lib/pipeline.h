@@ -22,31 +22,70 @@
 #define DYNAMIC_VINO_LIB_PIPELINE_H
 
 #include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
 #include <future>
 #include <map>
 #include <memory>
 #include <mutex>
 #include <set>
 #include <string>
+#include <utility>
+#include <vector>
 
 #include "dynamic_vino_lib/inferences/base_inference.h"
 #include "dynamic_vino_lib/inputs/standard_camera.h"
 #include "dynamic_vino_lib/outputs/base_output.h"
 #include "dynamic_vino_lib/pipeline_params.h"
+#include "dynamic_vino_lib/pipeline_profiler.h"
+#include "dynamic_vino_lib/rate_controller.h"
+#include "dynamic_vino_lib/task_arena.h"
 #include "opencv2/opencv.hpp"
 
+/**
+ * @struct FrameContext
+ * @brief Per-frame state carried from the input device through inferences
+ * to outputs. Owning it per frame (instead of in the pipeline) allows the
+ * next frame to be captured while the current one is still being infered.
+ */
+struct FrameContext
+{
+  /**< new frames read from the channels of the input device, infered
+   * together. A result belongs to the frame of its Result::getFrameIndex >**/
+  std::vector<cv::Mat> frames;
+  /**< header of each frame from its channel, stamps the outputs of it >**/
+  std::vector<std_msgs::Header> headers;
+  /**< owner of the memory of each frame, e.g. its image message, held as
+   * long as the frame is in use >**/
+  std::vector<std::shared_ptr<const void>> frame_owners;
+  /**< when the frames were read from the input device >**/
+  std::chrono::high_resolution_clock::time_point read_time;
+  /**< number of infer requests of this frame not finished yet >**/
+  int pending_requests = 0;
+  /**< whether inferences run on the results of other inferences are
+   * infered for this frame >**/
+  bool run_secondary = true;
+  /**< (inference, output) pairs whose results are ready for this frame >**/
+  std::vector<std::pair<std::string, std::string>> ready_outputs;
+  std::mutex mutex;
+  std::condition_variable cv;
+};
+
 /**
  * @class Pipeline
  * @brief This class is a pipeline class that stores the topology of
  * the input device, output device and networks and make inference. One pipeline
- * should have only one input device.
+ * should have only one input device, which may have several channels (e.g.
+ * several cameras) whose frames are infered in the same batch.
  */
 class Pipeline
 {
  public:
   explicit Pipeline(const std::string& name = "pipeline");
   /**
-   * @brief Add input device to the pipeline.
+   * @brief Add input device to the pipeline. Adding another device with the
+   * same name adds it as another channel of the input.
    * @param[in] name name of the current input device.
    * @param[in] input_device the input device instance to be added.
    * @return whether the add operation is successful
@@ -103,13 +142,23 @@ class Pipeline
   /**
    * @brief Do the inference once.
    * Data flow from input device to inference network, then to output device.
+   * In pipelined mode the frame read by this call is infered in background,
+   * while the outputs of the previous frame are handled. Frames already
+   * infered or skipped by the rate controller are not infered.
    */
   void runOnce();
+  /**
+   * @brief Wait for the frame still in flight (pipelined mode only) and
+   * hand its results to the outputs.
+   */
+  void flush();
   /**
    * @brief The callback function provided for all the inference network in the
    * pipeline.
+   * @param[in] detection_name name of the inference whose request finished.
+   * @param[in] request_id id of the finished request in the engine's pool.
    */
-  void callback(const std::string& detection_name);
+  void callback(const std::string& detection_name, int request_id);
   /**
    * @brief Set the inference network to call the callback function as soon as
    * each inference is
@@ -124,7 +173,18 @@ class Pipeline
   };
   std::shared_ptr<Input::BaseInputDevice> getInputDevice()
   {
-    return input_device_;
+    return input_devices_.empty() ? nullptr : input_devices_[0];
+  }
+  /**
+   * @brief Set how long the channels of the input are waited for a new
+   * frame each, after the first one read. Channels without a new frame by
+   * then are not infered this time.
+   * @param[in] max_wait_ms Deadline in milliseconds, 0 to only take the
+   * frames already received.
+   */
+  void setMaxWait(double max_wait_ms)
+  {
+    max_wait_ms_ = max_wait_ms;
   }
   
   /**
@@ -138,11 +198,57 @@ class Pipeline
   {
     return name_to_output_map_;
   }
+  std::map<std::string, std::shared_ptr<dynamic_vino_lib::BaseInference>>
+  getInferenceHandle()
+  {
+    return name_to_detection_map_;
+  }
+  /**
+   * @brief Get the durations of the stages of this pipeline: "input/<input>",
+   * "enqueue/<inference>", "inference/<inference>", "fetch/<inference>",
+   * "output/<output>", "frame/processing" (from read to outputs handled) and
+   * "frame/capture_to_output" (from the stamp of the frame to outputs
+   * handled).
+   */
+  dynamic_vino_lib::PipelineProfiler& getProfiler()
+  {
+    return profiler_;
+  }
+  /**
+   * @brief Get the controller deciding which frames are infered.
+   */
+  dynamic_vino_lib::RateController& getRateController()
+  {
+    return rate_controller_;
+  }
+  /**
+   * @brief Get the arena the tasks of this pipeline run on: loading ROIs
+   * into input blobs, submitting the inferences of one parent, handling the
+   * outputs.
+   */
+  dynamic_vino_lib::TaskArena& getTaskArena()
+  {
+    return *task_arena_;
+  }
 
  private:
-  void initInferenceCounter();
-  void increaseInferenceCounter();
-  void decreaseInferenceCounter();
+  bool readFrames(const std::shared_ptr<FrameContext>& context);
+  void submitFrame(const std::shared_ptr<FrameContext>& context);
+  void waitFrame(const std::shared_ptr<FrameContext>& context);
+  void deliverResults(const std::shared_ptr<FrameContext>& context);
+  void handleOutputs(const std::shared_ptr<FrameContext>& context);
+  void handleFrameOutputs();
+  void submitResults(
+      const std::shared_ptr<FrameContext>& context,
+      const std::shared_ptr<dynamic_vino_lib::BaseInference>& detection_ptr,
+      const std::string& next_name);
+  void forEachOutput(
+      const std::function<void(const std::string&,
+                               const std::shared_ptr<Outputs::BaseOutput>&)>&
+          func);
+  void increaseInferenceCounter(const std::shared_ptr<FrameContext>& context,
+                                int request_num);
+  void decreaseInferenceCounter(const std::shared_ptr<FrameContext>& context);
   bool isLegalConnect(const std::string parent, const std::string child);
   int getCatagoryOrder(const std::string name);
   void countFPS();
@@ -159,8 +265,10 @@ class Pipeline
   int total_inference_ = 0;
   std::shared_ptr<PipelineParams> params_;
 
-  std::shared_ptr<Input::BaseInputDevice> input_device_;
+  /**< channels of the input device >**/
+  std::vector<std::shared_ptr<Input::BaseInputDevice>> input_devices_;
   std::string input_device_name_;
+  double max_wait_ms_ = 0;
   std::multimap<std::string, std::string> next_;
   std::map<std::string, std::shared_ptr<dynamic_vino_lib::BaseInference>>
       name_to_detection_map_;
@@ -168,14 +276,15 @@ class Pipeline
       name_to_output_map_;
 
   std::set<std::string> output_names_;
-  int width_ = 0;
-  int height_ = 0;
-  cv::Mat frame_;
-  // for multi threads
-  std::atomic<int> counter_;
-  std::mutex counter_mutex_;
-  std::condition_variable cv_;
+  // frame whose infer requests are currently running on the device
+  std::shared_ptr<FrameContext> infer_context_;
   int fps_ = 0;
+  int fps_frame_count_ = 0;
+  std::chrono::high_resolution_clock::time_point fps_start_ =
+      std::chrono::high_resolution_clock::now();
+  dynamic_vino_lib::PipelineProfiler profiler_;
+  dynamic_vino_lib::RateController rate_controller_;
+  std::shared_ptr<dynamic_vino_lib::TaskArena> task_arena_;
 };
 
 #endif  // DYNAMIC_VINO_LIB_PIPELINE_H_
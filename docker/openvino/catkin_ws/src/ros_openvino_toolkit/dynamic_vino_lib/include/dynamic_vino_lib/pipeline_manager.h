@@ -29,6 +29,7 @@
 #include <set>
 #include <string>
 
+#include <ros/ros.h>
 #include <vino_param_lib/param_manager.h>
 #include "dynamic_vino_lib/pipeline.h"
 
@@ -48,6 +49,13 @@ class PipelineManager {
     return manager_;
   };
 
+  /**
+  * @brief Set the node handle that ROS topic inputs and outputs of the
+  * pipelines created afterwards subscribe and advertise with, e.g. the
+  * node handle of a nodelet. They use their own node handles if not set.
+  * @param[in] nh The node handle.
+  */
+  void setNodeHandle(const ros::NodeHandle& nh);
   std::shared_ptr<Pipeline> createPipeline(
       const Params::ParamManager::PipelineParams& params);
   void removePipeline(const std::string& name);
@@ -84,7 +92,17 @@ class PipelineManager {
   PipelineManager(PipelineManager const&);
   void operator=(PipelineManager const&);
   void threadPipeline(const char* name);
-  std::map<std::string, std::shared_ptr<Input::BaseInputDevice>>
+  /**
+   * @brief Publish the FPS and the stage durations of the pipeline since the
+   * last call on /diagnostics.
+   */
+  void publishDiagnostics(const std::string& name, PipelineData& data);
+  /**
+   * @brief Print the stage durations of the pipeline since it started, and
+   * the per-layer performance counts of its inferences if enabled.
+   */
+  void reportPipeline(const std::string& name, PipelineData& data);
+  std::multimap<std::string, std::shared_ptr<Input::BaseInputDevice>>
   parseInputDevice(const Params::ParamManager::PipelineParams& params);
   std::map<std::string, std::shared_ptr<Outputs::BaseOutput>> parseOutput(
       const Params::ParamManager::PipelineParams& params);
@@ -100,12 +118,53 @@ class PipelineManager {
       const Params::ParamManager::InferenceParams& infer);
   std::shared_ptr<dynamic_vino_lib::BaseInference> createObjectDetection(
       const Params::ParamManager::InferenceParams& infer);
+  std::shared_ptr<dynamic_vino_lib::BaseInference> createObjectDetectionYolo(
+      const Params::ParamManager::InferenceParams& infer);
   std::shared_ptr<dynamic_vino_lib::BaseInference> createObjectSegmentation(
       const Params::ParamManager::InferenceParams& infer);
   std::shared_ptr<dynamic_vino_lib::BaseInference> createPersonReidentification(
       const Params::ParamManager::InferenceParams& infer);
+  /**
+   * @brief Get the max batch size of a per-ROI inference from its params.
+   * ROIs beyond it are infered by further requests.
+   */
+  int getBatchSize(const Params::ParamManager::InferenceParams& infer);
+  /**
+   * @brief Get the number of frames the input of the pipeline provides at a
+   * time, the max batch size of the inferences run on the frames.
+   */
+  int getChannelNum(const Params::ParamManager::PipelineParams& params);
+  /**
+   * @brief The inference engine resizes one frame per request with auto
+   * resize, so the frames of a batch are spread over as many requests.
+   */
+  void fitAutoResize(Params::ParamManager::InferenceParams& infer);
+  bool isDynamicBatchSupported(const std::string& device);
+  /**
+   * @brief Get the initialized model of the file and preprocessing of the
+   * inference params and the given batch size, shared by all the pipelines
+   * using it so that the scheduler loads its network once per device.
+   */
+  template <typename ModelT>
+  std::shared_ptr<ModelT> getModel(
+      const Params::ParamManager::InferenceParams& infer, int input_num,
+      int output_num, int batch) {
+    std::string key = infer.model + "@" + std::to_string(batch) +
+                      (infer.auto_resize ? "@auto_resize" : "");
+    auto model = std::dynamic_pointer_cast<ModelT>(models_[key]);
+    if (model == nullptr) {
+      model = std::make_shared<ModelT>(infer.model, input_num, output_num,
+                                       batch);
+      model->setAutoResize(infer.auto_resize);
+      model->modelInit();
+      models_[key] = model;
+    }
+    return model;
+  }
   std::map<std::string, PipelineData> pipelines_;
-  std::map<std::string, InferenceEngine::InferencePlugin> plugins_for_devices_;
+  std::map<std::string, Models::BaseModel::Ptr> models_;
+  std::shared_ptr<ros::NodeHandle> node_handle_;
+  ros::Publisher diagnostics_pub_;
 };
 
 #endif  // DYNAMIC_VINO_LIB__PIPELINE_MANAGER_HPP_
\ No newline at end of file
@@ -53,6 +53,7 @@ const char kInferTpye_AgeGenderRecognition[] = "AgeGenderRecognition";
 const char kInferTpye_EmotionRecognition[] = "EmotionRecognition";
 const char kInferTpye_HeadPoseEstimation[] = "HeadPoseEstimation";
 const char kInferTpye_ObjectDetection[] = "ObjectDetection";
+const char kInferTpye_ObjectDetectionYolo[] = "ObjectDetectionYolo";
 const char kInferTpye_ObjectSegmentation[] = "ObjectSegmentation";
 const char kInferTpye_PersonReidentification[] = "PersonReidentification";
 
@@ -73,6 +74,11 @@ class PipelineParams
   void update(const Params::ParamManager::PipelineParams& params);
   bool isOutputTo(std::string& name);
   bool isGetFps();
+  /**
+   * @brief Whether the next frame is read and infered while the outputs of
+   * the current one are still being handled.
+   */
+  bool isPipelined();
 
   const std::string kInputType_Image = "Image";
   const std::string kOutputTpye_RViz = "RViz";
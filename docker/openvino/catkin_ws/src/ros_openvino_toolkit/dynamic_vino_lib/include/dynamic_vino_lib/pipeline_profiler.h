@@ -0,0 +1,178 @@
+/*
+ * Copyright (c) 2018 Intel Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * @brief a header file with declaration of PipelineProfiler class
+ * @file pipeline_profiler.h
+ */
+#ifndef DYNAMIC_VINO_LIB_PIPELINE_PROFILER_H
+#define DYNAMIC_VINO_LIB_PIPELINE_PROFILER_H
+
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace dynamic_vino_lib
+{
+/**
+ * @class LatencyHistogram
+ * @brief Histogram of durations in milliseconds with log spaced buckets, four
+ * per octave from 10us to about 10s. Percentiles are exact to a bucket, i.e.
+ * within 10% of the real value, whatever the number of samples.
+ */
+class LatencyHistogram
+{
+ public:
+  LatencyHistogram();
+  /**
+   * @brief Add one duration to the histogram.
+   * @param[in] ms The duration in milliseconds.
+   */
+  void add(double ms);
+  void reset();
+  inline uint64_t count() const
+  {
+    return count_;
+  }
+  inline double mean() const
+  {
+    return count_ > 0 ? sum_ / count_ : 0.0;
+  }
+  inline double min() const
+  {
+    return count_ > 0 ? min_ : 0.0;
+  }
+  inline double max() const
+  {
+    return count_ > 0 ? max_ : 0.0;
+  }
+  /**
+   * @brief Get the duration below which the given ratio of samples are.
+   * @param[in] ratio The ratio in [0, 1], e.g. 0.99 for the 99th percentile.
+   * @return The duration in milliseconds, 0 if the histogram is empty.
+   */
+  double percentile(double ratio) const;
+
+ private:
+  static const int kBucketsPerOctave = 4;
+  static const int kBucketNum = 80;
+  static constexpr double kFirstBucketMs = 0.01;
+
+  std::vector<uint64_t> buckets_;
+  uint64_t count_ = 0;
+  double sum_ = 0.0;
+  double min_ = 0.0;
+  double max_ = 0.0;
+};
+
+/**
+ * @class PipelineProfiler
+ * @brief Collects the durations of the stages of one pipeline (input read,
+ * enqueue, device inference, result fetch, output handling, ...) by stage
+ * name. Stages are recorded from the pipeline thread and from the completion
+ * callbacks of the inference engines at the same time, so it is thread safe.
+ */
+class PipelineProfiler
+{
+ public:
+  typedef std::chrono::high_resolution_clock Clock;
+
+  struct StageSummary
+  {
+    std::string name;
+    uint64_t count = 0;
+    double mean = 0.0;
+    double min = 0.0;
+    double p50 = 0.0;
+    double p90 = 0.0;
+    double p99 = 0.0;
+    double max = 0.0;
+  };
+
+  /**
+   * @brief Record one duration of a stage.
+   * @param[in] stage Name of the stage, e.g. "inference/FaceDetection".
+   * @param[in] ms The duration in milliseconds.
+   */
+  void record(const std::string& stage, double ms);
+  /**
+   * @brief Record the time elapsed since the given start point.
+   */
+  void record(const std::string& stage, const Clock::time_point& start);
+  /**
+   * @brief Summarize all durations recorded since the pipeline started.
+   */
+  std::vector<StageSummary> summarize() const;
+  /**
+   * @brief Summarize the durations recorded since the last call, and start
+   * a new window. Used for periodic reporting, e.g. ROS diagnostics.
+   */
+  std::vector<StageSummary> takeWindow();
+  /**
+   * @brief Print summarize() as a table.
+   */
+  void report(std::ostream& stream) const;
+
+  /**
+   * @brief Get the milliseconds elapsed since the given time point.
+   */
+  static inline double elapsedMs(const Clock::time_point& start)
+  {
+    typedef std::chrono::duration<double, std::milli> ms;
+    return std::chrono::duration_cast<ms>(Clock::now() - start).count();
+  }
+
+ private:
+  struct Stage
+  {
+    LatencyHistogram total;
+    LatencyHistogram window;
+  };
+  static StageSummary summarize(const std::string& name,
+                                const LatencyHistogram& histogram);
+
+  std::map<std::string, Stage> stages_;
+  mutable std::mutex mutex_;
+};
+
+/**
+ * @class ScopedStageTimer
+ * @brief Record the lifetime of the instance as one duration of a stage.
+ */
+class ScopedStageTimer
+{
+ public:
+  ScopedStageTimer(PipelineProfiler& profiler, const std::string& stage)
+    : profiler_(profiler), stage_(stage), start_(PipelineProfiler::Clock::now())
+  {
+  }
+  ~ScopedStageTimer()
+  {
+    profiler_.record(stage_, start_);
+  }
+
+ private:
+  PipelineProfiler& profiler_;
+  std::string stage_;
+  PipelineProfiler::Clock::time_point start_;
+};
+}  // namespace dynamic_vino_lib
+
+#endif  // DYNAMIC_VINO_LIB_PIPELINE_PROFILER_H
@@ -0,0 +1,120 @@
+/*
+ * Copyright (c) 2018 Intel Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * @brief a header file with declaration of RateController class
+ * @file rate_controller.h
+ */
+#ifndef DYNAMIC_VINO_LIB_RATE_CONTROLLER_H
+#define DYNAMIC_VINO_LIB_RATE_CONTROLLER_H
+
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+
+namespace dynamic_vino_lib
+{
+/**
+ * @class RateController
+ * @brief Decides which frames of a pipeline are infered, so that the results
+ * stay fresh when the device or the CPU can not keep up with the input.
+ *
+ * Frames closer than the period of the max rate to the last infered frame
+ * are skipped. With a latency budget, the latency from reading a frame to
+ * its results being ready is tracked: over budget, secondary inferences (the
+ * ones run on the results of another inference) are skipped first, then the
+ * period between infered frames is stretched until the latency is back
+ * under budget. Stretching goes on only while it lowers the latency; a
+ * stretch that does not is undone, so a budget below the time the device
+ * takes per frame only disables the secondary inferences. Well under budget,
+ * the period shrinks back and the secondary inferences are enabled again.
+ */
+class RateController
+{
+ public:
+  typedef std::chrono::high_resolution_clock Clock;
+
+  /**
+   * @brief Set the targets of the controller and reset its state.
+   * @param[in] max_rate Max number of frames infered per second, 0 for no
+   * limit.
+   * @param[in] latency_budget_ms Latency budget in milliseconds, 0 to
+   * disable the adaptation.
+   */
+  void configure(double max_rate, double latency_budget_ms);
+  /**
+   * @brief Decide whether the frame read at the given time is infered. The
+   * frame is counted as skipped if not.
+   */
+  bool admit(const Clock::time_point& read_time);
+  /**
+   * @brief Feed the latency of an infered frame, from read to results ready.
+   * Called from the completion callbacks of the inference engines.
+   */
+  void recordLatency(double ms);
+  /**
+   * @brief Whether inferences run on the results of other inferences are
+   * infered for the frames admitted now.
+   */
+  bool isSecondaryEnabled();
+  /**
+   * @brief Get the number of frames skipped since the last call.
+   */
+  uint64_t takeSkippedFrames();
+
+ private:
+  /**< weight of a new sample in the smoothed latency >**/
+  static constexpr double kLatencySmoothing = 0.2;
+  /**< the period shrinks and secondary inferences come back below this
+   * ratio of the budget >**/
+  static constexpr double kRecoverRatio = 0.7;
+  static constexpr double kPeriodGrowth = 1.5;
+  static constexpr double kPeriodShrink = 0.8;
+  static constexpr double kMaxPeriodMs = 1000.0;
+  /**< a stretch has to lower the latency below this ratio of the latency
+   * before it for the stretching to go on >**/
+  static constexpr double kStretchGainRatio = 0.95;
+  /**< frames up to this ratio of the period early are admitted, so that
+   * jitter of the input does not halve the rate >**/
+  static constexpr double kEarlyRatio = 0.1;
+  /**< number of latency samples between two adaptations, for the smoothed
+   * latency to reflect the previous one >**/
+  static const int kAdaptInterval = 5;
+
+  double min_period_ms_ = 0.0;
+  double budget_ms_ = 0.0;
+  double period_ms_ = 0.0;
+  double latency_ms_ = 0.0;
+  bool has_latency_ = false;
+  bool secondary_enabled_ = true;
+  int samples_since_adapt_ = 0;
+  /**< the last adaptation stretched the period from unstretched_period_ms_
+   * at a latency of stretch_latency_ms_ >**/
+  bool stretched_ = false;
+  double unstretched_period_ms_ = 0.0;
+  double stretch_latency_ms_ = 0.0;
+  /**< stretching stopped at a latency of stall_latency_ms_, as it did not
+   * lower the latency >**/
+  bool stalled_ = false;
+  double stall_latency_ms_ = 0.0;
+  bool has_admitted_ = false;
+  Clock::time_point next_due_;
+  uint64_t skipped_frames_ = 0;
+  std::mutex mutex_;
+};
+}  // namespace dynamic_vino_lib
+
+#endif  // DYNAMIC_VINO_LIB_RATE_CONTROLLER_H
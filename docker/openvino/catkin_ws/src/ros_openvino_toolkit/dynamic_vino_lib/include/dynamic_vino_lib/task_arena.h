@@ -0,0 +1,70 @@
+/*
+ * Copyright (c) 2018 Intel Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * @brief a header file with declaration of TaskArena class
+ * @file task_arena.h
+ */
+#ifndef DYNAMIC_VINO_LIB_TASK_ARENA_H
+#define DYNAMIC_VINO_LIB_TASK_ARENA_H
+
+#include <functional>
+#include <memory>
+
+namespace dynamic_vino_lib
+{
+/**
+ * @class TaskArena
+ * @brief Runs the tasks of a pipeline (resizing ROIs, submitting child
+ * inferences, handling outputs) on a bounded number of threads, like the
+ * TbbArenaWrapper of the multichannel demo. With TBB, the tasks run in a
+ * work-stealing task arena of their own, so that a pipeline does not take
+ * more cores than its budget. Without TBB, or with a budget of one thread,
+ * they run one after another on the calling thread.
+ */
+class TaskArena
+{
+ public:
+  TaskArena();
+  ~TaskArena();
+  /**
+   * @brief Set the max number of threads running the tasks, the calling
+   * thread included.
+   * @param[in] thread_num Number of threads, 0 for one per core.
+   */
+  void configure(int thread_num);
+  /**
+   * @brief Get the max number of threads running the tasks, 0 for one per
+   * core.
+   */
+  int getThreadNum() const
+  {
+    return thread_num_;
+  }
+  /**
+   * @brief Run func(0) ... func(n - 1) as parallel tasks and wait for all of
+   * them. Can be called from within a task.
+   */
+  void parallelFor(int n, const std::function<void(int)>& func);
+
+ private:
+  class Impl;
+  std::unique_ptr<Impl> impl_;
+  int thread_num_ = 1;
+};
+}  // namespace dynamic_vino_lib
+
+#endif  // DYNAMIC_VINO_LIB_TASK_ARENA_H
@@ -19,10 +19,122 @@
  * @file engine.cpp
  */
 #include "dynamic_vino_lib/engines/engine.h"
+#include "dynamic_vino_lib/engines/inference_scheduler.h"
+#include "dynamic_vino_lib/slog.h"
 
-Engines::Engine::Engine(InferenceEngine::InferencePlugin plg,
-                        const Models::BaseModel::Ptr base_model)
+Engines::Engine::Engine(const std::string& device,
+                        const Models::BaseModel::Ptr base_model,
+                        int request_num, bool dynamic_batch, int priority)
+  : priority_(priority)
 {
-  request_ = (plg.LoadNetwork(base_model->net_reader_->getNetwork(), {}))
-                 .CreateInferRequestPtr();
+  auto networks = InferenceScheduler::getInstance().loadNetwork(
+      device, base_model, dynamic_batch, dynamic_batch_);
+  if (request_num < 1)
+  {
+    slog::warn << "Invalid number of infer requests(" << request_num
+               << "), use 1 instead." << slog::endl;
+    request_num = 1;
+  }
+  for (auto& loaded : networks)
+  {
+    networks_.push_back(loaded.network);
+    network_instances_.push_back(loaded.instance);
+  }
+  for (int i = 0; i < request_num; ++i)
+  {
+    requests_.push_back(networks_[i % networks_.size()].CreateInferRequestPtr());
+    request_instances_.push_back(network_instances_[i % networks_.size()]);
+  }
+  requests_busy_.assign(request_num, false);
+}
+
+int Engines::Engine::acquireRequest()
+{
+  std::lock_guard<std::mutex> lk(requests_mutex_);
+  int acquired = -1;
+  int acquired_load = 0;
+  for (size_t i = 0; i < requests_busy_.size(); ++i)
+  {
+    if (requests_busy_[i])
+    {
+      continue;
+    }
+    int load =
+        InferenceScheduler::getInstance().getLoad(request_instances_[i]);
+    if (acquired < 0 || load < acquired_load)
+    {
+      acquired = static_cast<int>(i);
+      acquired_load = load;
+    }
+  }
+  if (acquired >= 0)
+  {
+    requests_busy_[acquired] = true;
+  }
+  return acquired;
+}
+
+int Engines::Engine::addRequest()
+{
+  std::lock_guard<std::mutex> lk(requests_mutex_);
+  size_t network = 0;
+  int network_load = 0;
+  for (size_t i = 0; i < networks_.size(); ++i)
+  {
+    int load =
+        InferenceScheduler::getInstance().getLoad(network_instances_[i]);
+    if (i == 0 || load < network_load)
+    {
+      network = i;
+      network_load = load;
+    }
+  }
+  int request_id = static_cast<int>(requests_.size());
+  requests_.push_back(networks_[network].CreateInferRequestPtr());
+  request_instances_.push_back(network_instances_[network]);
+  requests_busy_.push_back(true);
+  if (callback_)
+  {
+    setRequestCallback(request_id);
+  }
+  return request_id;
+}
+
+void Engines::Engine::releaseRequest(int request_id)
+{
+  std::lock_guard<std::mutex> lk(requests_mutex_);
+  if (request_id >= 0 && request_id < static_cast<int>(requests_busy_.size()))
+  {
+    requests_busy_[request_id] = false;
+  }
+}
+
+void Engines::Engine::startRequest(int request_id)
+{
+  InferenceScheduler::getInstance().startRequest(
+      request_instances_[request_id], priority_, requests_[request_id]);
+}
+
+void Engines::Engine::setCompletionCallback(
+    const std::function<void(int)>& callbackToSet)
+{
+  std::lock_guard<std::mutex> lk(requests_mutex_);
+  callback_ = callbackToSet;
+  for (size_t i = 0; i < requests_.size(); ++i)
+  {
+    setRequestCallback(static_cast<int>(i));
+  }
+}
+
+void Engines::Engine::setRequestCallback(int request_id)
+{
+  int instance = request_instances_[request_id];
+  std::function<void(int)> callbackToSet = callback_;
+  std::function<void(void)> callb = [callbackToSet, request_id, instance]()
+  {
+    /**< free the device slot before the results are processed >**/
+    InferenceScheduler::getInstance().finishRequest(instance);
+    callbackToSet(request_id);
+  };
+  requests_[request_id]->SetCompletionCallback(callb);
 }
@@ -0,0 +1,189 @@
+/*
+ * Copyright (c) 2018 Intel Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * @brief a header file with definition of InferenceScheduler class
+ * @file inference_scheduler.cpp
+ */
+#include "dynamic_vino_lib/engines/inference_scheduler.h"
+#include "dynamic_vino_lib/factory.h"
+#include "dynamic_vino_lib/slog.h"
+
+void Engines::InferenceScheduler::configure(
+    int myriad_device_num, int queue_depth,
+    const std::string& custom_cpu_library,
+    const std::string& custom_cldnn_library, bool performance_count)
+{
+  std::lock_guard<std::mutex> lk(mutex_);
+  if (myriad_device_num < 1)
+  {
+    slog::warn << "Invalid number of MYRIAD devices(" << myriad_device_num
+               << "), use 1 instead." << slog::endl;
+    myriad_device_num = 1;
+  }
+  if (queue_depth < 1)
+  {
+    slog::warn << "Invalid device queue depth(" << queue_depth
+               << "), use 1 instead." << slog::endl;
+    queue_depth = 1;
+  }
+  /**< the settings are shared by the pipelines of the process, a pipeline
+   * configured later can not change them once devices are created >**/
+  if (!device_instances_.empty())
+  {
+    if (myriad_device_num != myriad_device_num_ ||
+        queue_depth != queue_depth_ ||
+        custom_cpu_library != custom_cpu_library_ ||
+        custom_cldnn_library != custom_cldnn_library_ ||
+        performance_count != performance_count_)
+    {
+      slog::warn << "Devices are created already, the new Common settings "
+                 << "(myriad_device_num " << myriad_device_num
+                 << ", device_queue_depth " << queue_depth
+                 << ") are ignored, keeping myriad_device_num "
+                 << myriad_device_num_ << ", device_queue_depth "
+                 << queue_depth_ << "." << slog::endl;
+    }
+    return;
+  }
+  myriad_device_num_ = myriad_device_num;
+  queue_depth_ = queue_depth;
+  custom_cpu_library_ = custom_cpu_library;
+  custom_cldnn_library_ = custom_cldnn_library;
+  performance_count_ = performance_count;
+}
+
+const std::vector<int>& Engines::InferenceScheduler::getDeviceInstances(
+    const std::string& device)
+{
+  auto it = device_instances_.find(device);
+  if (it != device_instances_.end())
+  {
+    return it->second;
+  }
+  plugins_[device] = *Factory::makePluginByName(
+      device, custom_cpu_library_, custom_cldnn_library_, performance_count_);
+  int instance_num = device == "MYRIAD" ? myriad_device_num_ : 1;
+  std::vector<int>& ids = device_instances_[device];
+  for (int i = 0; i < instance_num; ++i)
+  {
+    ids.push_back(static_cast<int>(instances_.size()));
+    instances_.emplace_back();
+    instances_.back().device = device;
+  }
+  slog::info << "Scheduling inferences on " << instance_num << " " << device
+             << " device(s), " << queue_depth_ << " request(s) each"
+             << slog::endl;
+  return ids;
+}
+
+std::vector<Engines::InferenceScheduler::LoadedNetwork>
+Engines::InferenceScheduler::loadNetwork(const std::string& device,
+                                         const Models::BaseModel::Ptr& model,
+                                         bool dynamic_batch,
+                                         bool& dynamic_batch_loaded)
+{
+  std::lock_guard<std::mutex> lk(mutex_);
+  dynamic_batch = dynamic_batch && model->getMaxBatchSize() > 1;
+  NetworkKey key(model.get(), device, dynamic_batch);
+  auto it = networks_.find(key);
+  if (it != networks_.end())
+  {
+    dynamic_batch_loaded = it->second.dynamic_batch;
+    return it->second.networks;
+  }
+
+  const std::vector<int>& ids = getDeviceInstances(device);
+  InferenceEngine::InferencePlugin& plugin = plugins_[device];
+  LoadedModel& loaded = networks_[key];
+  loaded.model = model;
+  loaded.dynamic_batch = false;
+  if (dynamic_batch)
+  {
+    try
+    {
+      loaded.networks.push_back({ids[0], plugin.LoadNetwork(
+          model->net_reader_->getNetwork(),
+          {{InferenceEngine::PluginConfigParams::KEY_DYN_BATCH_ENABLED,
+            InferenceEngine::PluginConfigParams::YES}})});
+      loaded.dynamic_batch = true;
+    }
+    catch (const std::exception& e)
+    {
+      slog::warn << "Dynamic batch is not supported for "
+                 << model->getModelName() << ", use static batch "
+                 << model->getMaxBatchSize() << ": " << e.what()
+                 << slog::endl;
+    }
+  }
+  std::map<std::string, std::string> config;
+  if (loaded.dynamic_batch)
+  {
+    config[InferenceEngine::PluginConfigParams::KEY_DYN_BATCH_ENABLED] =
+        InferenceEngine::PluginConfigParams::YES;
+  }
+  for (size_t i = loaded.networks.size(); i < ids.size(); ++i)
+  {
+    loaded.networks.push_back(
+        {ids[i], plugin.LoadNetwork(model->net_reader_->getNetwork(), config)});
+  }
+  slog::info << "Loaded " << model->getModelName() << " on " << ids.size()
+             << " " << device << " device(s)" << slog::endl;
+  dynamic_batch_loaded = loaded.dynamic_batch;
+  return loaded.networks;
+}
+
+int Engines::InferenceScheduler::getLoad(int instance)
+{
+  std::lock_guard<std::mutex> lk(mutex_);
+  return instances_[instance].running +
+         static_cast<int>(instances_[instance].queued.size());
+}
+
+void Engines::InferenceScheduler::startRequest(
+    int instance, int priority,
+    const InferenceEngine::InferRequest::Ptr& request)
+{
+  {
+    std::lock_guard<std::mutex> lk(mutex_);
+    Instance& target = instances_[instance];
+    if (target.running >= queue_depth_)
+    {
+      target.queued.push({priority, sequence_++, request});
+      return;
+    }
+    target.running++;
+  }
+  request->StartAsync();
+}
+
+void Engines::InferenceScheduler::finishRequest(int instance)
+{
+  InferenceEngine::InferRequest::Ptr next;
+  {
+    std::lock_guard<std::mutex> lk(mutex_);
+    Instance& target = instances_[instance];
+    if (target.queued.empty())
+    {
+      target.running--;
+      return;
+    }
+    /**< the finished request hands its slot to the next one >**/
+    next = target.queued.top().request;
+    target.queued.pop();
+  }
+  next->StartAsync();
+}
@@ -21,6 +21,7 @@
 
 #include <memory>
 #include <string>
+#include <vector>
 
 #include "dynamic_vino_lib/inferences/age_gender_detection.h"
 #include "dynamic_vino_lib/outputs/base_output.h"
@@ -43,7 +44,7 @@ void dynamic_vino_lib::AgeGenderDetection::loadNetwork(
     std::shared_ptr<Models::AgeGenderDetectionModel> network)
 {
   valid_model_ = network;
-  setMaxBatchSize(network->getMaxBatchSize());
+  loadModelProperties(network);
 }
 
 bool dynamic_vino_lib::AgeGenderDetection::enqueue(
@@ -58,6 +59,7 @@ bool dynamic_vino_lib::AgeGenderDetection::enqueue(
       valid_model_->getInputName());
   if (!succeed) return false;
   Result r(input_frame_loc);
+  setEnqueuedFrame(r);
   results_.emplace_back(r);
   return true;
 }
@@ -71,16 +73,18 @@ bool dynamic_vino_lib::AgeGenderDetection::fetchResults()
 {
   bool can_fetch = dynamic_vino_lib::BaseInference::fetchResults();
   if (!can_fetch) return false;
-  auto request = getEngine()->getRequest();
+  auto request = getResultRequest();
   InferenceEngine::Blob::Ptr genderBlob =
       request->GetBlob(valid_model_->getOutputGenderName());
   InferenceEngine::Blob::Ptr ageBlob =
       request->GetBlob(valid_model_->getOutputAgeName());
 
-  for (size_t i = 0; i < results_.size(); ++i)
+  int begin = getResultBatchBegin();
+  for (int i = 0; i < getResultBatchSize(); ++i)
   {
-    results_[i].age_ = ageBlob->buffer().as<float*>()[i] * 100;
-    results_[i].male_prob_ = genderBlob->buffer().as<float*>()[i * 2 + 1];
+    results_[begin + i].age_ = ageBlob->buffer().as<float*>()[i] * 100;
+    results_[begin + i].male_prob_ =
+        genderBlob->buffer().as<float*>()[i * 2 + 1];
   }
   return true;
 }
@@ -106,6 +110,7 @@ const void dynamic_vino_lib::AgeGenderDetection::observeOutput(
 {
   if (output != nullptr)
   {
-    output->accept(results_);
+    std::vector<Result> selected;
+    output->accept(selectOutputResults(results_, selected));
   }
 }
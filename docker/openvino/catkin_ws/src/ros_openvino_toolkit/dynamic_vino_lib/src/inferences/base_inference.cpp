@@ -19,7 +19,13 @@
  * @file base_inference.cpp
  */
 
+#include <algorithm>
+#include <chrono>
+#include <functional>
+#include <map>
 #include <memory>
+#include <string>
+#include <vector>
 
 #include "dynamic_vino_lib/inferences/base_inference.h"
 
@@ -38,21 +44,121 @@ void dynamic_vino_lib::BaseInference::loadEngine(
     const std::shared_ptr<Engines::Engine> engine)
 {
   engine_ = engine;
+  growRequestBuffers();
+}
+
+void dynamic_vino_lib::BaseInference::growRequestBuffers()
+{
+  size_t request_num = engine_->getRequestNum();
+  request_batch_begin_.resize(request_num, 0);
+  request_batch_size_.resize(request_num, 0);
+  request_start_.resize(request_num,
+                        std::chrono::high_resolution_clock::now());
+  request_frames_.resize(request_num);
 }
 
 bool dynamic_vino_lib::BaseInference::submitRequest()
 {
-  if (engine_->getRequest() == nullptr) return false;
   if (!enqueued_frames) return false;
+  std::vector<std::function<void()>> loads;
+  loads.swap(pending_loads_);
+  auto load = [&loads](int i)
+  {
+    loads[i]();
+  };
+  if (task_arena_ != nullptr)
+  {
+    task_arena_->parallelFor(static_cast<int>(loads.size()), load);
+  }
+  else
+  {
+    for (size_t i = 0; i < loads.size(); ++i)
+    {
+      load(static_cast<int>(i));
+    }
+  }
+  std::vector<int> requests;
+  requests.swap(enqueue_requests_);
+  for (size_t i = 0; i < requests.size(); ++i)
+  {
+    int begin = static_cast<int>(i) * max_batch_size_;
+    request_batch_begin_[requests[i]] = begin;
+    request_batch_size_[requests[i]] =
+        std::min(max_batch_size_, enqueued_frames - begin);
+  }
+  {
+    std::lock_guard<std::mutex> lk(fetch_mutex_);
+    unfetched_requests_ = static_cast<int>(requests.size());
+  }
+  submit_frame_indices_.swap(enqueue_frame_indices_);
+  enqueue_frame_indices_.clear();
   enqueued_frames = 0;
-  results_fetched_ = false;
-  engine_->getRequest()->StartAsync();
+  for (auto request_id : requests)
+  {
+    auto request = engine_->getRequest(request_id);
+    if (engine_->isDynamicBatch())
+    {
+      request->SetBatch(request_batch_size_[request_id]);
+    }
+    request_start_[request_id] = std::chrono::high_resolution_clock::now();
+    engine_->startRequest(request_id);
+  }
   return true;
 }
 
 bool dynamic_vino_lib::BaseInference::fetchResults()
 {
-  if (results_fetched_) return false;
-  results_fetched_ = true;
-  return true;
+  return result_request_id_ >= 0;
+}
+
+bool dynamic_vino_lib::BaseInference::collectResults(int request_id)
+{
+  /**< requests of one submit may finish at the same time, their results are
+   * fetched one after another into the same result buffer >**/
+  std::lock_guard<std::mutex> lk(fetch_mutex_);
+  result_request_id_ = request_id;
+  bool fetched = fetchResults();
+  result_request_id_ = -1;
+  if (enable_performance_count_)
+  {
+    for (auto& layer : engine_->getRequest(request_id)->GetPerformanceCounts())
+    {
+      auto it = perf_counts_.find(layer.first);
+      if (it == perf_counts_.end())
+      {
+        perf_counts_.insert(layer);
+        continue;
+      }
+      it->second.realTime_uSec += layer.second.realTime_uSec;
+      it->second.cpu_uSec += layer.second.cpu_uSec;
+    }
+    ++perf_count_requests_;
+  }
+  request_frames_[request_id].release();
+  engine_->releaseRequest(request_id);
+  --unfetched_requests_;
+  return fetched && unfetched_requests_ == 0;
+}
+
+double dynamic_vino_lib::BaseInference::getRequestElapsedMs(
+    int request_id) const
+{
+  typedef std::chrono::duration<double, std::milli> ms;
+  return std::chrono::duration_cast<ms>(
+             std::chrono::high_resolution_clock::now() -
+             request_start_[request_id])
+      .count();
+}
+
+std::map<std::string, InferenceEngine::InferenceEngineProfileInfo>
+dynamic_vino_lib::BaseInference::getPerformanceCounts()
+{
+  std::lock_guard<std::mutex> lk(fetch_mutex_);
+  auto counts = perf_counts_;
+  for (auto& layer : counts)
+  {
+    layer.second.realTime_uSec /= std::max(perf_count_requests_, 1);
+    layer.second.cpu_uSec /= std::max(perf_count_requests_, 1);
+  }
+  return counts;
 }
@@ -22,6 +22,7 @@
 
 #include <memory>
 #include <string>
+#include <vector>
 
 #include "dynamic_vino_lib/inferences/emotions_detection.h"
 #include "dynamic_vino_lib/outputs/base_output.h"
@@ -45,7 +46,7 @@ void dynamic_vino_lib::EmotionsDetection::loadNetwork(
     const std::shared_ptr<Models::EmotionDetectionModel> network)
 {
   valid_model_ = network;
-  setMaxBatchSize(network->getMaxBatchSize());
+  loadModelProperties(network);
 }
 
 bool dynamic_vino_lib::EmotionsDetection::enqueue(
@@ -65,6 +66,7 @@ bool dynamic_vino_lib::EmotionsDetection::enqueue(
     return false;
   }
   Result r(input_frame_loc);
+  setEnqueuedFrame(r);
   results_.emplace_back(r);
   return true;
 }
@@ -81,7 +83,7 @@ bool dynamic_vino_lib::EmotionsDetection::fetchResults()
   int label_length = static_cast<int>(valid_model_->getLabels().size());
   std::string output_name = valid_model_->getOutputName();
   InferenceEngine::Blob::Ptr emotions_blob =
-      getEngine()->getRequest()->GetBlob(output_name);
+      getResultRequest()->GetBlob(output_name);
   /** emotions vector must have the same size as number of channels
       in model output. Default output format is NCHW so we check index 1 */
 
@@ -101,13 +103,15 @@ bool dynamic_vino_lib::EmotionsDetection::fetchResults()
   /** we identify an index of the most probable emotion in output array
       for idx image to return appropriate emotion name */
   auto emotions_values = emotions_blob->buffer().as<float*>();
-  for (unsigned int idx = 0; idx < results_.size(); ++idx)
+  int begin = getResultBatchBegin();
+  for (int idx = 0; idx < getResultBatchSize(); ++idx)
   {
-    auto output_idx_pos = emotions_values + idx;
+    auto output_idx_pos = emotions_values + idx * label_length;
     int64 max_prob_emotion_idx =
         std::max_element(output_idx_pos, output_idx_pos + label_length) -
         output_idx_pos;
-    results_[idx].label_ = valid_model_->getLabels()[max_prob_emotion_idx];
+    results_[begin + idx].label_ =
+        valid_model_->getLabels()[max_prob_emotion_idx];
   }
 
   return true;
@@ -134,6 +138,7 @@ const void dynamic_vino_lib::EmotionsDetection::observeOutput(
 {
   if (output != nullptr)
   {
-    output->accept(results_);
+    std::vector<Result> selected;
+    output->accept(selectOutputResults(results_, selected));
   }
 }
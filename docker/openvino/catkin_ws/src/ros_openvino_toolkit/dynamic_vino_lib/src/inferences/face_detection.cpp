@@ -50,7 +50,7 @@ void dynamic_vino_lib::FaceDetection::loadNetwork(
   valid_model_ = network;
   max_proposal_count_ = network->getMaxProposalCount();
   object_size_ = network->getObjectSize();
-  setMaxBatchSize(network->getMaxBatchSize());
+  loadModelProperties(network);
 }
 
 bool dynamic_vino_lib::FaceDetection::enqueue(const cv::Mat& frame,
@@ -62,15 +62,15 @@ bool dynamic_vino_lib::FaceDetection::enqueue(const cv::Mat& frame,
     width_ = frame.cols;
     height_ = frame.rows;
   }
-  if (!dynamic_vino_lib::BaseInference::enqueue<u_int8_t>(
-          frame, input_frame_loc, 1, 0, valid_model_->getInputName()))
+  /**< frames of several input channels are infered in one batch, the
+   * results of the last frames are reset with the first one >**/
+  if (getEnqueuedNum() == 0)
   {
-    return false;
+    results_.clear();
   }
-  Result r(input_frame_loc);
-  results_.clear();
-  results_.emplace_back(r);
-  return true;
+  return dynamic_vino_lib::BaseInference::enqueue<u_int8_t>(
+      frame, input_frame_loc, 1, getEnqueuedNum(),
+      valid_model_->getInputName());
 }
 
 bool dynamic_vino_lib::FaceDetection::submitRequest()
@@ -83,14 +83,23 @@ bool dynamic_vino_lib::FaceDetection::fetchResults()
 {
   bool can_fetch = dynamic_vino_lib::BaseInference::fetchResults();
   if (!can_fetch) return false;
-  bool found_result = false;
-  results_.clear();
-  InferenceEngine::InferRequest::Ptr request = getEngine()->getRequest();
+  InferenceEngine::InferRequest::Ptr request = getResultRequest();
   std::string output = valid_model_->getOutputName();
   const float* detections = request->GetBlob(output)->buffer().as<float*>();
   for (int i = 0; i < max_proposal_count_; i++)
   {
     float image_id = detections[i * object_size_ + 0];
+    // the end of the list is only marked by image_id, the rest of the slot
+    // and the slots after it are stale
+    if (image_id < 0)
+    {
+      break;
+    }
+    // items beyond the enqueued frames hold stale detections
+    if (image_id >= getResultBatchSize())
+    {
+      continue;
+    }
     cv::Rect r;
     auto label_num = static_cast<size_t>(detections[i * object_size_ + 1]);
     std::vector<std::string>& labels = valid_model_->getLabels();
@@ -109,15 +118,9 @@ bool dynamic_vino_lib::FaceDetection::fetchResults()
     {
       continue;
     }
-
-    if (image_id < 0)
-    {
-      break;
-    }
-    found_result = true;
+    setFetchedFrame(result, static_cast<int>(image_id));
     results_.emplace_back(result);
   }
-  if (!found_result) results_.clear();
 
   return true;
 }
@@ -143,6 +146,7 @@ const void dynamic_vino_lib::FaceDetection::observeOutput(
 {
   if (output != nullptr)
   {
-    output->accept(results_);
+    std::vector<Result> selected;
+    output->accept(selectOutputResults(results_, selected));
   }
 }
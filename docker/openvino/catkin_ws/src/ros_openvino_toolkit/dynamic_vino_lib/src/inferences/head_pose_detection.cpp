@@ -23,6 +23,7 @@
 #include "dynamic_vino_lib/inferences/head_pose_detection.h"
 #include <memory>
 #include <string>
+#include <vector>
 #include "dynamic_vino_lib/outputs/base_output.h"
 
 // HeadPoseResult
@@ -43,7 +44,7 @@ void dynamic_vino_lib::HeadPoseDetection::loadNetwork(
     std::shared_ptr<Models::HeadPoseDetectionModel> network)
 {
   valid_model_ = network;
-  setMaxBatchSize(network->getMaxBatchSize());
+  loadModelProperties(network);
 }
 
 bool dynamic_vino_lib::HeadPoseDetection::enqueue(
@@ -58,6 +59,7 @@ bool dynamic_vino_lib::HeadPoseDetection::enqueue(
       valid_model_->getInputName());
   if (!succeed) return false;
   Result r(input_frame_loc);
+  setEnqueuedFrame(r);
   results_.emplace_back(r);
   return true;
 }
@@ -71,7 +73,7 @@ bool dynamic_vino_lib::HeadPoseDetection::fetchResults()
 {
   bool can_fetch = dynamic_vino_lib::BaseInference::fetchResults();
   if (!can_fetch) return false;
-  auto request = getEngine()->getRequest();
+  auto request = getResultRequest();
   InferenceEngine::Blob::Ptr angle_r =
       request->GetBlob(valid_model_->getOutputOutputAngleR());
   InferenceEngine::Blob::Ptr angle_p =
@@ -79,11 +81,12 @@ bool dynamic_vino_lib::HeadPoseDetection::fetchResults()
   InferenceEngine::Blob::Ptr angle_y =
       request->GetBlob(valid_model_->getOutputOutputAngleY());
 
-  for (int i = 0; i < getResultsLength(); ++i)
+  int begin = getResultBatchBegin();
+  for (int i = 0; i < getResultBatchSize(); ++i)
   {
-    results_[i].angle_r_ = angle_r->buffer().as<float*>()[i];
-    results_[i].angle_p_ = angle_p->buffer().as<float*>()[i];
-    results_[i].angle_y_ = angle_y->buffer().as<float*>()[i];
+    results_[begin + i].angle_r_ = angle_r->buffer().as<float*>()[i];
+    results_[begin + i].angle_p_ = angle_p->buffer().as<float*>()[i];
+    results_[begin + i].angle_y_ = angle_y->buffer().as<float*>()[i];
   }
   return true;
 }
@@ -109,6 +112,7 @@ const void dynamic_vino_lib::HeadPoseDetection::observeOutput(
 {
   if (output != nullptr)
   {
-    output->accept(results_);
+    std::vector<Result> selected;
+    output->accept(selectOutputResults(results_, selected));
   }
 }
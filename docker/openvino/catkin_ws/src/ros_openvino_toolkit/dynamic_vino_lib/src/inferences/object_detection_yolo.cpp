@@ -0,0 +1,191 @@
+/*
+ * Copyright (c) 2018 Intel Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/**
+ * @brief a header file with definition of ObjectDetectionYolo class
+ * @file object_detection_yolo.cpp
+ */
+#include <cmath>
+#include <memory>
+#include <string>
+#include <vector>
+#include "dynamic_vino_lib/inferences/object_detection_yolo.h"
+#include "dynamic_vino_lib/outputs/base_output.h"
+#include "dynamic_vino_lib/slog.h"
+
+#if defined(__SSE2__)
+#define OBJECT_DETECTION_YOLO_SSE2
+#include <emmintrin.h>
+#endif
+
+namespace {
+/**
+ * @brief Append the indices of the values above the threshold. Most cells of
+ * a region output hold no object, so they are rejected four at a time.
+ */
+void findAboveThreshold(const float* values, int size, float threshold,
+                        std::vector<int>& indices) {
+  int i = 0;
+#ifdef OBJECT_DETECTION_YOLO_SSE2
+  const __m128 thresholds = _mm_set1_ps(threshold);
+  for (; i + 16 <= size; i += 16) {
+    int mask =
+        _mm_movemask_ps(_mm_cmpgt_ps(_mm_loadu_ps(values + i), thresholds)) |
+        _mm_movemask_ps(_mm_cmpgt_ps(_mm_loadu_ps(values + i + 4), thresholds))
+            << 4 |
+        _mm_movemask_ps(_mm_cmpgt_ps(_mm_loadu_ps(values + i + 8), thresholds))
+            << 8 |
+        _mm_movemask_ps(_mm_cmpgt_ps(_mm_loadu_ps(values + i + 12), thresholds))
+            << 12;
+    for (int bit = i; mask != 0; ++bit, mask >>= 1) {
+      if (mask & 1) {
+        indices.push_back(bit);
+      }
+    }
+  }
+#endif
+  for (; i < size; ++i) {
+    if (values[i] > threshold) {
+      indices.push_back(i);
+    }
+  }
+}
+}  // namespace
+
+// ObjectDetectionYolo
+dynamic_vino_lib::ObjectDetectionYolo::ObjectDetectionYolo(
+    double show_output_thresh, double iou_thresh)
+    : dynamic_vino_lib::BaseInference(),
+      show_output_thresh_(show_output_thresh),
+      iou_thresh_(iou_thresh) {}
+dynamic_vino_lib::ObjectDetectionYolo::~ObjectDetectionYolo() = default;
+void dynamic_vino_lib::ObjectDetectionYolo::loadNetwork(
+    const std::shared_ptr<Models::ObjectDetectionYoloModel> network) {
+  valid_model_ = network;
+  loadModelProperties(network);
+}
+bool dynamic_vino_lib::ObjectDetectionYolo::enqueue(
+    const cv::Mat& frame, const cv::Rect& input_frame_loc) {
+  if (width_ == 0 && height_ == 0) {
+    width_ = frame.cols;
+    height_ = frame.rows;
+  }
+  /**< frames of several input channels are infered in one batch, the
+   * results of the last frames are reset with the first one >**/
+  if (getEnqueuedNum() == 0) {
+    results_.clear();
+  }
+  return dynamic_vino_lib::BaseInference::enqueue<u_int8_t>(
+      frame, input_frame_loc, 1, getEnqueuedNum(),
+      valid_model_->getInputName());
+}
+bool dynamic_vino_lib::ObjectDetectionYolo::submitRequest() {
+  return dynamic_vino_lib::BaseInference::submitRequest();
+}
+bool dynamic_vino_lib::ObjectDetectionYolo::fetchResults() {
+  bool can_fetch = dynamic_vino_lib::BaseInference::fetchResults();
+  if (!can_fetch) return false;
+  InferenceEngine::InferRequest::Ptr request = getResultRequest();
+  for (int item = 0; item < getResultBatchSize(); ++item) {
+    boxes_.clear();
+    for (auto& region : valid_model_->getRegions()) {
+      const size_t item_size = static_cast<size_t>(region.num) *
+                               (region.coords + 1 + region.classes) *
+                               region.height * region.width;
+      const float* blob =
+          request->GetBlob(region.output)->buffer().as<float*>();
+      decodeRegion(region, blob + item * item_size);
+    }
+    suppressOverlaps(item);
+  }
+  return true;
+}
+void dynamic_vino_lib::ObjectDetectionYolo::decodeRegion(
+    const Models::ObjectDetectionYoloModel::Region& region, const float* blob) {
+  const int cells = region.height * region.width;
+  const int entries = region.coords + 1 + region.classes;
+  const float threshold = static_cast<float>(show_output_thresh_);
+  const float input_width = static_cast<float>(valid_model_->getInputWidth());
+  const float input_height = static_cast<float>(valid_model_->getInputHeight());
+  for (int n = 0; n < region.num; ++n) {
+    // planes of one anchor: x, y, w, h, objectness, then one per class
+    const float* anchor_blob = blob + n * entries * cells;
+    const float* objectness = anchor_blob + region.coords * cells;
+    // a class probability is the objectness times a value <= 1, so cells
+    // below the threshold can not hold any detection
+    cells_.clear();
+    findAboveThreshold(objectness, cells, threshold, cells_);
+    for (int cell : cells_) {
+      int row = cell / region.width;
+      int col = cell % region.width;
+      float x = (col + anchor_blob[cell]) / region.width;
+      float y = (row + anchor_blob[cells + cell]) / region.height;
+      float w = std::exp(anchor_blob[2 * cells + cell]) *
+                region.anchors[2 * n] / input_width;
+      float h = std::exp(anchor_blob[3 * cells + cell]) *
+                region.anchors[2 * n + 1] / input_height;
+      const float* class_probs = anchor_blob + (region.coords + 1) * cells;
+      for (int j = 0; j < region.classes; ++j) {
+        float prob = objectness[cell] * class_probs[j * cells + cell];
+        if (prob <= threshold) {
+          continue;
+        }
+        boxes_.add(x - w / 2, y - h / 2, x + w / 2, y + h / 2, prob, j);
+      }
+    }
+  }
+}
+void dynamic_vino_lib::ObjectDetectionYolo::suppressOverlaps(int item) {
+  // a box is only suppressed by the kept boxes of its own class
+  nms::Params params;
+  params.iou_threshold = static_cast<float>(iou_thresh_);
+  params.inclusive = true;
+  params.class_aware = true;
+  suppressor_.run(boxes_, params, kept_);
+
+  std::vector<std::string>& labels = valid_model_->getLabels();
+  for (int idx : kept_) {
+    cv::Rect r;
+    r.x = static_cast<int>(boxes_.x0[idx] * width_);
+    r.y = static_cast<int>(boxes_.y0[idx] * height_);
+    r.width = static_cast<int>(boxes_.x1[idx] * width_) - r.x;
+    r.height = static_cast<int>(boxes_.y1[idx] * height_) - r.y;
+    Result result(r);
+    auto label_num = static_cast<unsigned int>(boxes_.label[idx]);
+    result.label_ = label_num < labels.size()
+                        ? labels[label_num]
+                        : std::string("label #") + std::to_string(label_num);
+    result.confidence_ = boxes_.score[idx];
+    setFetchedFrame(result, item);
+    results_.emplace_back(result);
+  }
+}
+const int dynamic_vino_lib::ObjectDetectionYolo::getResultsLength() const {
+  return static_cast<int>(results_.size());
+}
+const dynamic_vino_lib::Result*
+dynamic_vino_lib::ObjectDetectionYolo::getLocationResult(int idx) const {
+  return &(results_[idx]);
+}
+const std::string dynamic_vino_lib::ObjectDetectionYolo::getName() const {
+  return valid_model_->getModelName();
+}
+const void dynamic_vino_lib::ObjectDetectionYolo::observeOutput(
+    const std::shared_ptr<Outputs::BaseOutput>& output) {
+  if (output != nullptr) {
+    std::vector<Result> selected;
+    output->accept(selectOutputResults(results_, selected));
+  }
+}
@@ -44,7 +44,7 @@ void dynamic_vino_lib::ObjectSegmentation::loadNetwork(
   const std::shared_ptr<Models::ObjectSegmentationModel> network)
 {
   valid_model_ = network;
-  setMaxBatchSize(network->getMaxBatchSize());
+  loadModelProperties(network);
 }
 
 bool dynamic_vino_lib::ObjectSegmentation::enqueue(
@@ -55,15 +55,13 @@ bool dynamic_vino_lib::ObjectSegmentation::enqueue(
     width_ = frame.cols;
     height_ = frame.rows;
   }
-  if (!dynamic_vino_lib::BaseInference::enqueue<u_int8_t>(frame, input_frame_loc, 1, 0,
-    valid_model_->getInputName()))
-  {
-    return false;
+  /**< frames of several input channels are infered one request each, the
+   * results of the last frames are reset with the first one >**/
+  if (getEnqueuedNum() == 0) {
+    results_.clear();
   }
-  Result r(input_frame_loc);
-  results_.clear();
-  results_.emplace_back(r);
-  return true;
+  return dynamic_vino_lib::BaseInference::enqueue<u_int8_t>(frame, input_frame_loc, 1,
+           getEnqueuedNum(), valid_model_->getInputName());
 }
 
 bool dynamic_vino_lib::ObjectSegmentation::submitRequest()
@@ -77,9 +75,7 @@ bool dynamic_vino_lib::ObjectSegmentation::fetchResults()
   if (!can_fetch) {
     return false;
   }
-  bool found_result = false;
-  results_.clear();
-  InferenceEngine::InferRequest::Ptr request = getEngine()->getRequest();
+  InferenceEngine::InferRequest::Ptr request = getResultRequest();
   std::string detection_output = valid_model_->getDetectionOutputName();
   std::string mask_output = valid_model_->getMaskOutputName();
   const auto do_blob = request->GetBlob(detection_output.c_str());
@@ -99,6 +95,9 @@ bool dynamic_vino_lib::ObjectSegmentation::fetchResults()
     if (batch < 0) {
       break;
     }
+    if (batch >= getResultBatchSize()) {
+      continue;
+    }
     float prob = box_info[2];
     if (prob > show_output_thresh_) {
       float x1 = std::min(std::max(0.0f, box_info[3] * width_), static_cast<float>(width_));
@@ -119,13 +118,10 @@ bool dynamic_vino_lib::ObjectSegmentation::fetchResults()
       result.label_ = class_id < labels.size() ? labels[class_id] :
         std::string("label #") + std::to_string(class_id);
       result.mask_ = resized_mask_mat;
-      found_result = true;
+      setFetchedFrame(result, static_cast<int>(batch));
       results_.emplace_back(result);
     }
   }
-  if (!found_result) {
-    results_.clear();
-  }
   return true;
 }
 
@@ -149,6 +145,7 @@ const void dynamic_vino_lib::ObjectSegmentation::observeOutput(
   const std::shared_ptr<Outputs::BaseOutput> & output)
 {
   if (output != nullptr) {
-    output->accept(results_);
+    std::vector<Result> selected;
+    output->accept(selectOutputResults(results_, selected));
   }
 }
@@ -0,0 +1,229 @@
+/*
+ * Copyright (c) 2018 Intel Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * @brief a header file with declaration of PersonGallery class
+ * @file person_gallery.cpp
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#include "dynamic_vino_lib/inferences/person_gallery.h"
+#include "samples/embedding_distance.hpp"
+
+namespace
+{
+const char kGalleryMagic[4] = {'P', 'G', 'A', 'L'};
+const int32_t kGalleryVersion = 1;
+}  // namespace
+
+dynamic_vino_lib::PersonGallery::PersonGallery(int capacity, double max_age)
+  : capacity_(std::max(capacity, 0)), max_age_(std::max(max_age, 0.0))
+{
+}
+
+std::vector<int> dynamic_vino_lib::PersonGallery::match(
+    const float* embeddings, int count, int dim, float threshold)
+{
+  if (dim_ == 0)
+  {
+    dim_ = dim;
+  }
+  if (dim != dim_)
+  {
+    throw std::logic_error("embedding of length " + std::to_string(dim) +
+                           " can't be matched against a gallery of length " +
+                           std::to_string(dim_));
+  }
+  Clock::time_point now = Clock::now();
+  dropExpired(now);
+
+  /**< with normalized embeddings cosine similarity is a dot product >**/
+  queries_.assign(embeddings, embeddings + count * dim);
+  for (int q = 0; q < count; ++q)
+  {
+    embedding_distance::normalize(&queries_[q * dim], dim);
+  }
+
+  int gallery_size = size();
+  similarities_.resize(static_cast<size_t>(count) * gallery_size);
+  for (int g = 0; g < gallery_size; ++g)
+  {
+    const float* person = &embeddings_[static_cast<size_t>(g) * dim];
+    for (int q = 0; q < count; ++q)
+    {
+      similarities_[q * gallery_size + g] =
+          embedding_distance::dot(&queries_[q * dim], person, dim);
+    }
+  }
+
+  std::vector<std::tuple<float, int, int>> candidates;
+  for (int q = 0; q < count; ++q)
+  {
+    for (int g = 0; g < gallery_size; ++g)
+    {
+      float similarity = similarities_[q * gallery_size + g];
+      if (similarity > threshold)
+      {
+        candidates.emplace_back(similarity, q, g);
+      }
+    }
+  }
+  std::sort(candidates.begin(), candidates.end(),
+            [](const std::tuple<float, int, int>& a,
+               const std::tuple<float, int, int>& b)
+            {
+              return std::get<0>(a) > std::get<0>(b);
+            });
+
+  std::vector<int> ids(count, -1);
+  std::vector<bool> person_matched(gallery_size, false);
+  for (auto& candidate : candidates)
+  {
+    int q = std::get<1>(candidate);
+    int g = std::get<2>(candidate);
+    if (ids[q] >= 0 || person_matched[g])
+    {
+      continue;
+    }
+    person_matched[g] = true;
+    ids[q] = ids_[g];
+    std::copy(&queries_[q * dim], &queries_[q * dim] + dim,
+              &embeddings_[static_cast<size_t>(g) * dim]);
+    last_seen_[g] = now;
+  }
+  /**< new persons are added after matching, as adding may evict and move
+   * recorded persons >**/
+  for (int q = 0; q < count; ++q)
+  {
+    if (ids[q] < 0)
+    {
+      ids[q] = add(&queries_[q * dim], now);
+    }
+  }
+  return ids;
+}
+
+void dynamic_vino_lib::PersonGallery::dropExpired(const Clock::time_point& now)
+{
+  if (max_age_ <= 0)
+  {
+    return;
+  }
+  auto max_age = std::chrono::duration_cast<Clock::duration>(
+      std::chrono::duration<double>(max_age_));
+  for (int i = size() - 1; i >= 0; --i)
+  {
+    if (now - last_seen_[i] > max_age)
+    {
+      remove(i);
+    }
+  }
+}
+
+void dynamic_vino_lib::PersonGallery::remove(int index)
+{
+  int last = size() - 1;
+  if (index != last)
+  {
+    std::copy(embeddings_.begin() + static_cast<size_t>(last) * dim_,
+              embeddings_.end(),
+              embeddings_.begin() + static_cast<size_t>(index) * dim_);
+    ids_[index] = ids_[last];
+    last_seen_[index] = last_seen_[last];
+  }
+  embeddings_.resize(static_cast<size_t>(last) * dim_);
+  ids_.pop_back();
+  last_seen_.pop_back();
+}
+
+int dynamic_vino_lib::PersonGallery::add(const float* normalized,
+                                         const Clock::time_point& now)
+{
+  if (capacity_ > 0 && size() >= capacity_)
+  {
+    remove(static_cast<int>(
+        std::min_element(last_seen_.begin(), last_seen_.end()) -
+        last_seen_.begin()));
+  }
+  embeddings_.insert(embeddings_.end(), normalized, normalized + dim_);
+  ids_.push_back(next_id_);
+  last_seen_.push_back(now);
+  return next_id_++;
+}
+
+bool dynamic_vino_lib::PersonGallery::save(const std::string& path) const
+{
+  std::ofstream file(path, std::ios::binary);
+  if (!file)
+  {
+    return false;
+  }
+  int32_t header[] = {kGalleryVersion, dim_, size(), next_id_};
+  file.write(kGalleryMagic, sizeof(kGalleryMagic));
+  file.write(reinterpret_cast<const char*>(header), sizeof(header));
+  file.write(reinterpret_cast<const char*>(ids_.data()),
+             ids_.size() * sizeof(int32_t));
+  file.write(reinterpret_cast<const char*>(embeddings_.data()),
+             embeddings_.size() * sizeof(float));
+  return static_cast<bool>(file);
+}
+
+bool dynamic_vino_lib::PersonGallery::load(const std::string& path)
+{
+  std::ifstream file(path, std::ios::binary);
+  char magic[sizeof(kGalleryMagic)];
+  int32_t header[4];
+  if (!file.read(magic, sizeof(magic)) ||
+      std::memcmp(magic, kGalleryMagic, sizeof(magic)) != 0 ||
+      !file.read(reinterpret_cast<char*>(header), sizeof(header)) ||
+      header[0] != kGalleryVersion || header[1] < 0 || header[2] < 0)
+  {
+    return false;
+  }
+  int dim = header[1];
+  int count = header[2];
+  std::vector<int> ids(count);
+  std::vector<float> embeddings(static_cast<size_t>(count) * dim);
+  if (!file.read(reinterpret_cast<char*>(ids.data()),
+                 ids.size() * sizeof(int32_t)) ||
+      !file.read(reinterpret_cast<char*>(embeddings.data()),
+                 embeddings.size() * sizeof(float)))
+  {
+    return false;
+  }
+  dim_ = dim;
+  next_id_ = header[3];
+  ids_.swap(ids);
+  embeddings_.swap(embeddings);
+  last_seen_.assign(ids_.size(), Clock::now());
+  /**< a smaller capacity than the gallery was saved with keeps the persons
+   * added last >**/
+  while (capacity_ > 0 && size() > capacity_)
+  {
+    remove(static_cast<int>(std::min_element(ids_.begin(), ids_.end()) -
+                            ids_.begin()));
+  }
+  return true;
+}
@@ -17,12 +17,14 @@
  * PersonReidentificationResult class
  * @file person_reidentification.cpp
  */
+#include <algorithm>
 #include <memory>
 #include <string>
 #include <vector>
 #include "dynamic_vino_lib/inferences/person_reidentification.h"
 #include "dynamic_vino_lib/outputs/base_output.h"
 #include "dynamic_vino_lib/slog.h"
+#include "samples/embedding_distance.hpp"
 
 // PersonReidentificationResult
 dynamic_vino_lib::PersonReidentificationResult::PersonReidentificationResult(
@@ -30,15 +32,33 @@ dynamic_vino_lib::PersonReidentificationResult::PersonReidentificationResult(
 : Result(location) {}
 
 // PersonReidentification
-dynamic_vino_lib::PersonReidentification::PersonReidentification(double match_thresh)
-: match_thresh_(match_thresh), dynamic_vino_lib::BaseInference() {}
+dynamic_vino_lib::PersonReidentification::PersonReidentification(
+  double match_thresh, int gallery_capacity, double gallery_max_age,
+  const std::string & gallery_path)
+: dynamic_vino_lib::BaseInference(), gallery_(gallery_capacity, gallery_max_age),
+  gallery_path_(gallery_path), match_thresh_(match_thresh)
+{
+  if (!gallery_path_.empty()) {
+    if (gallery_.load(gallery_path_)) {
+      slog::info << "Loaded " << gallery_.size() << " persons from " <<
+        gallery_path_ << slog::endl;
+    } else {
+      slog::warn << "No person gallery loaded from " << gallery_path_ << slog::endl;
+    }
+  }
+}
 
-dynamic_vino_lib::PersonReidentification::~PersonReidentification() = default;
+dynamic_vino_lib::PersonReidentification::~PersonReidentification()
+{
+  if (!gallery_path_.empty() && !gallery_.save(gallery_path_)) {
+    slog::err << "Failed to save person gallery to " << gallery_path_ << slog::endl;
+  }
+}
 void dynamic_vino_lib::PersonReidentification::loadNetwork(
   const std::shared_ptr<Models::PersonReidentificationModel> network)
 {
   valid_model_ = network;
-  setMaxBatchSize(network->getMaxBatchSize());
+  loadModelProperties(network);
 }
 
 bool dynamic_vino_lib::PersonReidentification::enqueue(
@@ -46,13 +66,15 @@ bool dynamic_vino_lib::PersonReidentification::enqueue(
 {
   if (getEnqueuedNum() == 0) {
     results_.clear();
+    fetched_embeddings_ = 0;
   }
   if (!dynamic_vino_lib::BaseInference::enqueue<u_int8_t>(
-      frame, input_frame_loc, 1, 0, valid_model_->getInputName()))
+      frame, input_frame_loc, 1, getResultsLength(), valid_model_->getInputName()))
   {
     return false;
   }
   Result r(input_frame_loc);
+  setEnqueuedFrame(r);
   results_.emplace_back(r);
   return true;
 }
@@ -66,18 +88,25 @@ bool dynamic_vino_lib::PersonReidentification::fetchResults()
 {
   bool can_fetch = dynamic_vino_lib::BaseInference::fetchResults();
   if (!can_fetch) {return false;}
-  bool found_result = false;
-  InferenceEngine::InferRequest::Ptr request = getEngine()->getRequest();
+  InferenceEngine::InferRequest::Ptr request = getResultRequest();
   std::string output = valid_model_->getOutputName();
-  const float * output_values = request->GetBlob(output)->buffer().as<float *>();
-  for (int i = 0; i < getResultsLength(); i++) {
-    std::vector<float> new_person = std::vector<float>(
-      output_values + 256 * i, output_values + 256 * i + 256);
-    std::string person_id = findMatchPerson(new_person);
-    results_[i].person_id_ = person_id;
-    found_result = true;
+  InferenceEngine::Blob::Ptr output_blob = request->GetBlob(output);
+  const float * output_values = output_blob->buffer().as<float *>();
+  int dim = static_cast<int>(output_blob->size()) / valid_model_->getMaxBatchSize();
+  int begin = getResultBatchBegin();
+  embeddings_.resize(results_.size() * dim);
+  std::copy(output_values, output_values + getResultBatchSize() * dim,
+    embeddings_.begin() + begin * dim);
+  fetched_embeddings_ += getResultBatchSize();
+  /**< the ROIs of a frame are matched together once the last request of it
+   * is fetched, so that two ROIs never get the same person >**/
+  if (fetched_embeddings_ == getResultsLength()) {
+    std::vector<int> ids = gallery_.match(
+      embeddings_.data(), getResultsLength(), dim, static_cast<float>(match_thresh_));
+    for (int i = 0; i < getResultsLength(); i++) {
+      results_[i].person_id_ = "No." + std::to_string(ids[i]);
+    }
   }
-  if (!found_result) {results_.clear();}
   return true;
 }
 
@@ -89,43 +118,22 @@ float dynamic_vino_lib::PersonReidentification::calcSimilarity(
             "person_a size = " + std::to_string(person_a.size()) +
             "person_b size = " + std::to_string(person_b.size()));
   }
-  float mul_sum, denom_a, denom_b, value_a, value_b;
-  mul_sum = denom_a = denom_b = value_a = value_b = 0;
-  for (auto i = 0; i < person_a.size(); i++) {
-    value_a = person_a[i];
-    value_b = person_b[i];
-    mul_sum += value_a * value_b;
-    denom_a += value_a * value_a;
-    denom_b += value_b * value_b;
-  }
+  float denom_a = embedding_distance::squaredNorm(person_a.data(), person_a.size());
+  float denom_b = embedding_distance::squaredNorm(person_b.data(), person_b.size());
   if (denom_a == 0 || denom_b == 0) {
     throw std::logic_error("cosine similarity is not defined whenever one or both "
             "input vectors are zero-vectors.");
   }
-  return mul_sum / (sqrt(denom_a) * sqrt(denom_b));
+  return embedding_distance::dot(person_a.data(), person_b.data(), person_a.size()) /
+         (sqrt(denom_a) * sqrt(denom_b));
 }
 
 std::string dynamic_vino_lib::PersonReidentification::findMatchPerson(
   const std::vector<float> & new_person)
 {
-  auto size = recorded_persons_.size();
-  std::string id = "No.";
-  float best_match_sim = 0;
-  int best_match_ind = -1;
-  for (auto i = 0; i < size; ++i) {
-    float cos_sim = calcSimilarity(new_person, recorded_persons_[i]);
-    if (cos_sim > best_match_sim) {
-      best_match_sim = cos_sim;
-      best_match_ind = i;
-    }
-  }
-  if (best_match_sim > match_thresh_) {
-    recorded_persons_[best_match_ind] = new_person;
-    return id + std::to_string(best_match_ind);
-  } else {
-    recorded_persons_.push_back(new_person);
-    return id + std::to_string(size);
-  }
+  std::vector<int> ids = gallery_.match(new_person.data(), 1,
+      static_cast<int>(new_person.size()), static_cast<float>(match_thresh_));
+  return "No." + std::to_string(ids[0]);
 }
 
 const int dynamic_vino_lib::PersonReidentification::getResultsLength() const
@@ -148,6 +156,7 @@ const void dynamic_vino_lib::PersonReidentification::observeOutput(
   const std::shared_ptr<Outputs::BaseOutput> & output)
 {
   if (output != nullptr) {
-    output->accept(results_);
+    std::vector<Result> selected;
+    output->accept(selectOutputResults(results_, selected));
   }
 }
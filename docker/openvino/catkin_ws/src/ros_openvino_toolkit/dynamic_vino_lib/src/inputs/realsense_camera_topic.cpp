@@ -25,46 +25,95 @@
 
 #include <cv_bridge/cv_bridge.h>
 
-#define INPUT_TOPIC "/camera/color/image_raw"
+constexpr const char* Input::RealSenseCameraTopic::kDefaultTopic;
 
-Input::RealSenseCameraTopic::RealSenseCameraTopic()
+Input::RealSenseCameraTopic::RealSenseCameraTopic(const std::string& topic)
+    : topic_(topic), spin_(true), latest_frame_(nullptr)
 {
 }
 
+Input::RealSenseCameraTopic::RealSenseCameraTopic(const ros::NodeHandle& nh,
+                                                  const std::string& topic)
+    : nh_(nh), topic_(topic), spin_(false), latest_frame_(nullptr)
+{
+}
+
+Input::RealSenseCameraTopic::~RealSenseCameraTopic()
+{
+  delete latest_frame_.exchange(nullptr);
+}
+
 bool Input::RealSenseCameraTopic::initialize()
 {
   slog::info << "before cameraTOpic init" << slog::endl;
   
   std::shared_ptr<image_transport::ImageTransport> it =
 	        std::make_shared<image_transport::ImageTransport>(nh_);
-  sub_ = it->subscribe("/camera/color/image_raw", 1, &RealSenseCameraTopic::cb,
-		                           this); 
+  sub_ = it->subscribe(topic_, 1, &RealSenseCameraTopic::cb, this);
+  slog::info << "Subscribed to camera topic " << topic_ << slog::endl;
   return true;
 }
 
 void Input::RealSenseCameraTopic::cb(
     const sensor_msgs::ImageConstPtr& image_msg)
 {
-  image = cv_bridge::toCvCopy(image_msg, "bgr8")->image;
+  cv_bridge::CvImageConstPtr cv_image;
+  try
+  {
+    // shares the message buffer, converts only if the encoding is not bgr8
+    cv_image = cv_bridge::toCvShare(image_msg, "bgr8");
+  }
+  catch (cv_bridge::Exception& e)
+  {
+    slog::err << "cv_bridge exception: " << e.what() << slog::endl;
+    return;
+  }
+  auto dropped =
+      latest_frame_.exchange(new cv_bridge::CvImageConstPtr(cv_image));
+  delete dropped;
 }
 
 bool Input::RealSenseCameraTopic::read(cv::Mat* frame)
 {
-  ros::spinOnce();
+  if (spin_)
+  {
+    ros::spinOnce();
+  }
+  std::unique_ptr<cv_bridge::CvImageConstPtr> latest(
+      latest_frame_.exchange(nullptr));
+  new_frame_ = latest != nullptr;
+  if (latest != nullptr)
+  {
+    current_frame_ = *latest;
+  }
   //nothing in topics from begining
-  if (image.empty() && last_image.empty())
+  if (current_frame_ == nullptr)
   {
     slog::warn << "No data received in CameraTopic instance" << slog::endl;
     return false;
   }
-  if(image.empty()) {
-	  *frame = last_image;
+  *frame = current_frame_->image;
+  return true;
+}
+
+std_msgs::Header Input::RealSenseCameraTopic::getHeader()
+{
+  if (current_frame_ == nullptr)
+  {
+    return BaseInputDevice::getHeader();
   }
-  else
+  return current_frame_->header;
+}
+
+std::shared_ptr<const void> Input::RealSenseCameraTopic::getFrameOwner()
+{
+  if (current_frame_ == nullptr)
   {
-	  *frame = image;
+    return nullptr;
   }
-  return true;
+  /**< the message is held by a boost pointer, the deleter keeps a copy >**/
+  cv_bridge::CvImageConstPtr owner = current_frame_;
+  return std::shared_ptr<const void>(owner.get(), [owner](const void*) {});
 }
 
 void Input::RealSenseCameraTopic::config()
@@ -47,6 +47,12 @@ void Models::BaseModel::modelInit()
   slog::info << "Loading network files" << slog::endl;
   // Read network model
   net_reader_->ReadNetwork(model_loc_);
+  /**< the inference engine preprocesses one image per request >**/
+  if (auto_resize_ && max_batch_size_ > 1)
+  {
+    throw std::logic_error("Batch size " + std::to_string(max_batch_size_) +
+                           " is not supported with auto resize!");
+  }
   // Set batch size to given max_batch_size_
   slog::info << "Batch size is set to  " << max_batch_size_ << slog::endl;
   net_reader_->getNetwork().setBatchSize(max_batch_size_);
@@ -64,6 +70,10 @@ void Models::BaseModel::modelInit()
   checkNetworkSize(input_num_, output_num_, net_reader_);
   checkLayerProperty(net_reader_);
   setLayerProperty(net_reader_);
+  if (auto_resize_)
+  {
+    setAutoResizeProperty(net_reader_);
+  }
 }
 
 void Models::BaseModel::checkNetworkSize(
@@ -82,10 +92,25 @@ void Models::BaseModel::checkNetworkSize(
   slog::info << "Checking output size" << slog::endl;
   InferenceEngine::OutputsDataMap output_info(
       net_reader->getNetwork().getOutputsInfo());
-  if (output_info.size() != output_size)
+  if (output_size > 0 && output_info.size() != output_size)
   {
     throw std::logic_error(getModelName() +
                            "network should have only one output");
   }
   // InferenceEngine::DataPtr& output_data_ptr = output_info.begin()->second;
 }
+
+void Models::BaseModel::setAutoResizeProperty(
+    InferenceEngine::CNNNetReader::Ptr net_reader)
+{
+  slog::info << "Input is resized by the inference engine" << slog::endl;
+  InferenceEngine::InputsDataMap input_info_map(
+      net_reader->getNetwork().getInputsInfo());
+  for (auto& input : input_info_map)
+  {
+    input.second->setPrecision(InferenceEngine::Precision::U8);
+    input.second->getPreProcess().setResizeAlgorithm(
+        InferenceEngine::ResizeAlgorithm::RESIZE_BILINEAR);
+    input.second->getInputData()->setLayout(InferenceEngine::Layout::NHWC);
+  }
+}
@@ -0,0 +1,115 @@
+/*
+ * Copyright (c) 2018 Intel Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/**
+ * @brief a header file with definition of ObjectDetectionYoloModel class
+ * @file object_detection_yolo_model.cpp
+ */
+#include <string>
+#include <vector>
+#include "dynamic_vino_lib/models/object_detection_yolo_model.h"
+#include "dynamic_vino_lib/slog.h"
+// Validated YOLO Object Detection Network
+Models::ObjectDetectionYoloModel::ObjectDetectionYoloModel(
+    const std::string& model_loc, int input_num, int output_num,
+    int max_batch_size)
+    : BaseModel(model_loc, input_num, output_num, max_batch_size) {}
+void Models::ObjectDetectionYoloModel::setLayerProperty(
+    InferenceEngine::CNNNetReader::Ptr net_reader) {
+  // set input property
+  InferenceEngine::InputsDataMap input_info_map(
+      net_reader->getNetwork().getInputsInfo());
+  if (input_info_map.size() != 1) {
+    throw std::logic_error("This sample accepts networks having only one input");
+  }
+  InferenceEngine::InputInfo::Ptr input_info = input_info_map.begin()->second;
+  input_info->setPrecision(InferenceEngine::Precision::U8);
+  input_info->getInputData()->setLayout(InferenceEngine::Layout::NCHW);
+  // set output property
+  InferenceEngine::OutputsDataMap output_info_map(
+      net_reader->getNetwork().getOutputsInfo());
+  for (auto& output : output_info_map) {
+    output.second->setPrecision(InferenceEngine::Precision::FP32);
+  }
+  // set input layer name
+  input_ = input_info_map.begin()->first;
+}
+void Models::ObjectDetectionYoloModel::checkLayerProperty(
+    const InferenceEngine::CNNNetReader::Ptr& net_reader) {
+  InferenceEngine::InputsDataMap input_info_map(
+      net_reader->getNetwork().getInputsInfo());
+  const InferenceEngine::SizeVector input_dims =
+      input_info_map.begin()->second->getInputData()->getTensorDesc().getDims();
+  input_height_ = static_cast<int>(input_dims[2]);
+  input_width_ = static_cast<int>(input_dims[3]);
+
+  slog::info << "Checking YOLO Object Detection outputs" << slog::endl;
+  InferenceEngine::OutputsDataMap output_info_map(
+      net_reader->getNetwork().getOutputsInfo());
+  if (output_info_map.empty()) {
+    throw std::logic_error("YOLO Object Detection network has no output");
+  }
+  regions_.clear();
+  for (auto& output : output_info_map) {
+    const InferenceEngine::CNNLayerPtr layer =
+        net_reader->getNetwork().getLayerByName(output.first.c_str());
+    if (layer->type != "RegionYolo") {
+      throw std::logic_error("YOLO Object Detection network output layer (" +
+                             output.first + ") should be RegionYolo, but was " +
+                             layer->type);
+    }
+    Region region;
+    region.output = output.first;
+    region.coords = layer->GetParamAsInt("coords");
+    region.classes = layer->GetParamAsInt("classes");
+    const InferenceEngine::SizeVector region_dims =
+        layer->insData[0].lock()->getTensorDesc().getDims();
+    region.height = static_cast<int>(region_dims[2]);
+    region.width = static_cast<int>(region_dims[3]);
+    std::vector<float> anchors = layer->GetParamAsFloats("anchors");
+    if (layer->params.find("mask") != layer->params.end()) {
+      // YOLOv3: each output uses the anchors of its mask, in input pixels
+      for (int index : layer->GetParamAsInts("mask")) {
+        region.anchors.push_back(anchors.at(index * 2));
+        region.anchors.push_back(anchors.at(index * 2 + 1));
+      }
+      region.num = static_cast<int>(region.anchors.size() / 2);
+    } else {
+      // YOLOv2: all anchors, in cells
+      region.num = layer->GetParamAsInt("num");
+      for (int n = 0; n < region.num; ++n) {
+        region.anchors.push_back(anchors.at(n * 2) * input_width_ /
+                                 region.width);
+        region.anchors.push_back(anchors.at(n * 2 + 1) * input_height_ /
+                                 region.height);
+      }
+    }
+    if (regions_.size() > 0 && regions_[0].classes != region.classes) {
+      throw std::logic_error(
+          "YOLO Object Detection network outputs should have the same classes");
+    }
+    slog::info << "Checking YOLO Object Detection output ... Name="
+               << region.output << ", cells=" << region.width << "x"
+               << region.height << ", anchors=" << region.num
+               << ", classes=" << region.classes << slog::endl;
+    regions_.push_back(region);
+  }
+  if (getLabels().size() != static_cast<size_t>(regions_[0].classes)) {
+    getLabels().clear();
+  }
+}
+const std::string Models::ObjectDetectionYoloModel::getModelName() const {
+  return "Object Detection YOLO";
+}
@@ -20,12 +20,17 @@
  */
 
 #include "dynamic_vino_lib/outputs/ros_topic_output.h"
-#include <chrono>
+#include <boost/make_shared.hpp>
 #include <memory>
 #include <string>
 #include <vector>
 
 Outputs::RosTopicOutput::RosTopicOutput()
+    : RosTopicOutput(ros::NodeHandle())
+{
+}
+
+Outputs::RosTopicOutput::RosTopicOutput(const ros::NodeHandle& nh) : nh_(nh)
 {
   pub_face_ =
       nh_.advertise<object_msgs::ObjectsInBoxes>("/openvino_toolkit/faces", 16);
@@ -41,14 +46,6 @@ Outputs::RosTopicOutput::RosTopicOutput()
       "/openvino_toolkit/reidentified_persons", 16);
   pub_segmented_object_ = nh_.advertise<people_msgs::ObjectsInMasks>(
       "/openvino_toolkit/segmented_obejcts", 16);
-
-  emotions_msg_ptr_ = NULL;
-  faces_msg_ptr_ = NULL;
-  age_gender_msg_ptr_ = NULL;
-  headpose_msg_ptr_ = NULL;
-  object_msg_ptr_ = NULL;
-  person_reid_msg_ptr_ = NULL;
-  segmented_object_msg_ptr_ = NULL;
 }
 
 void Outputs::RosTopicOutput::feedFrame(const cv::Mat& frame) {}
@@ -57,7 +54,7 @@ void Outputs::RosTopicOutput::feedFrame(const cv::Mat& frame) {}
 void Outputs::RosTopicOutput::accept(
   const std::vector<dynamic_vino_lib::PersonReidentificationResult> & results)
 {
-  person_reid_msg_ptr_ = std::make_shared<people_msgs::ReidentificationStamped>();
+  person_reid_msg_ptr_ = boost::make_shared<people_msgs::ReidentificationStamped>();
   people_msgs::Reidentification person;
   for (auto & r : results) {
     // slog::info << ">";
@@ -74,7 +71,7 @@ void Outputs::RosTopicOutput::accept(
 void Outputs::RosTopicOutput::accept(
   const std::vector<dynamic_vino_lib::ObjectSegmentationResult> & results)
 {
-  segmented_object_msg_ptr_ = std::make_shared<people_msgs::ObjectsInMasks>();
+  segmented_object_msg_ptr_ = boost::make_shared<people_msgs::ObjectsInMasks>();
   people_msgs::ObjectInMask object;
   for (auto & r : results) {
     // slog::info << ">";
@@ -99,7 +96,7 @@ void Outputs::RosTopicOutput::accept(
 void Outputs::RosTopicOutput::accept(
     const std::vector<dynamic_vino_lib::FaceDetectionResult>& results)
 {
-  faces_msg_ptr_ = std::make_shared<object_msgs::ObjectsInBoxes>();
+  faces_msg_ptr_ = boost::make_shared<object_msgs::ObjectsInBoxes>();
 
   object_msgs::ObjectInBox face;
   for (auto r : results)
@@ -118,7 +115,7 @@ void Outputs::RosTopicOutput::accept(
 void Outputs::RosTopicOutput::accept(
     const std::vector<dynamic_vino_lib::EmotionsResult>& results)
 {
-  emotions_msg_ptr_ = std::make_shared<people_msgs::EmotionsStamped>();
+  emotions_msg_ptr_ = boost::make_shared<people_msgs::EmotionsStamped>();
 
   people_msgs::Emotion emotion;
   for (auto r : results)
@@ -136,7 +133,7 @@ void Outputs::RosTopicOutput::accept(
 void Outputs::RosTopicOutput::accept(
     const std::vector<dynamic_vino_lib::AgeGenderResult>& results)
 {
-  age_gender_msg_ptr_ = std::make_shared<people_msgs::AgeGenderStamped>();
+  age_gender_msg_ptr_ = boost::make_shared<people_msgs::AgeGenderStamped>();
 
   people_msgs::AgeGender ag;
   for (auto r : results)
@@ -165,7 +162,7 @@ void Outputs::RosTopicOutput::accept(
 void Outputs::RosTopicOutput::accept(
     const std::vector<dynamic_vino_lib::HeadPoseResult>& results)
 {
-  headpose_msg_ptr_ = std::make_shared<people_msgs::HeadPoseStamped>();
+  headpose_msg_ptr_ = boost::make_shared<people_msgs::HeadPoseStamped>();
 
   people_msgs::HeadPose hp;
   for (auto r : results)
@@ -185,7 +182,7 @@ void Outputs::RosTopicOutput::accept(
 void Outputs::RosTopicOutput::accept(
     const std::vector<dynamic_vino_lib::ObjectDetectionResult>& results)
 {
-  object_msg_ptr_ = std::make_shared<object_msgs::ObjectsInBoxes>();
+  object_msg_ptr_ = boost::make_shared<object_msgs::ObjectsInBoxes>();
 
   object_msgs::ObjectInBox hp;
   for (auto r : results)
@@ -203,87 +200,47 @@ void Outputs::RosTopicOutput::accept(
 
 void Outputs::RosTopicOutput::handleOutput()
 {
-  std_msgs::Header header = getHeader();
-  if (person_reid_msg_ptr_ != nullptr) {
-    people_msgs::ReidentificationStamped person_reid_msg;
-    person_reid_msg.header = header;
-    person_reid_msg.reidentified_vector.swap(person_reid_msg_ptr_->reidentified_vector);
-    pub_person_reid_.publish(person_reid_msg);
+  const std_msgs::Header& header = header_;
+  if (person_reid_msg_ptr_ != nullptr)
+  {
+    person_reid_msg_ptr_->header = header;
+    pub_person_reid_.publish(person_reid_msg_ptr_);
     person_reid_msg_ptr_ = nullptr;
   }
-  if (segmented_object_msg_ptr_ != nullptr) {
-    // slog::info << "publishing faces outputs." << slog::endl;
-    people_msgs::ObjectsInMasks segmented_msg;
-    segmented_msg.header = header;
-    segmented_msg.objects_vector.swap(segmented_object_msg_ptr_->objects_vector);
-    pub_segmented_object_.publish(segmented_msg);
+  if (segmented_object_msg_ptr_ != nullptr)
+  {
+    segmented_object_msg_ptr_->header = header;
+    pub_segmented_object_.publish(segmented_object_msg_ptr_);
     segmented_object_msg_ptr_ = nullptr;
   }
-  if (faces_msg_ptr_ != NULL)
+  if (faces_msg_ptr_ != nullptr)
   {
-    object_msgs::ObjectsInBoxes faces_msg;
-    faces_msg.header = header;
-    faces_msg.objects_vector.swap(faces_msg_ptr_->objects_vector);
-
-    pub_face_.publish(faces_msg);
+    faces_msg_ptr_->header = header;
+    pub_face_.publish(faces_msg_ptr_);
     faces_msg_ptr_ = nullptr;
   }
   if (emotions_msg_ptr_ != nullptr)
   {
-    people_msgs::EmotionsStamped emotions_msg;
-    emotions_msg.header = header;
-    emotions_msg.emotions.swap(emotions_msg_ptr_->emotions);
-
-    pub_emotion_.publish(emotions_msg);
+    emotions_msg_ptr_->header = header;
+    pub_emotion_.publish(emotions_msg_ptr_);
     emotions_msg_ptr_ = nullptr;
   }
   if (age_gender_msg_ptr_ != nullptr)
   {
-    people_msgs::AgeGenderStamped age_gender_msg;
-    age_gender_msg.header = header;
-    age_gender_msg.objects.swap(age_gender_msg_ptr_->objects);
-
-    pub_age_gender_.publish(age_gender_msg);
+    age_gender_msg_ptr_->header = header;
+    pub_age_gender_.publish(age_gender_msg_ptr_);
     age_gender_msg_ptr_ = nullptr;
   }
   if (headpose_msg_ptr_ != nullptr)
   {
-    people_msgs::HeadPoseStamped headpose_msg;
-    headpose_msg.header = header;
-    headpose_msg.headposes.swap(headpose_msg_ptr_->headposes);
-
-    pub_headpose_.publish(headpose_msg);
+    headpose_msg_ptr_->header = header;
+    pub_headpose_.publish(headpose_msg_ptr_);
     headpose_msg_ptr_ = nullptr;
   }
   if (object_msg_ptr_ != nullptr)
   {
-    object_msgs::ObjectsInBoxes object_msg;
-    object_msg.header = header;
-    object_msg.objects_vector.swap(object_msg_ptr_->objects_vector);
-
-    pub_object_.publish(object_msg);
-    object_msg_ptr_ = nullptr;
-  }
-  if (object_msg_ptr_ != nullptr)
-  {
-    object_msgs::ObjectsInBoxes object_msg;
-    object_msg.header = header;
-    object_msg.objects_vector.swap(object_msg_ptr_->objects_vector);
-
-    pub_object_.publish(object_msg);
+    object_msg_ptr_->header = header;
+    pub_object_.publish(object_msg_ptr_);
     object_msg_ptr_ = nullptr;
   }
 }
-
-std_msgs::Header Outputs::RosTopicOutput::getHeader()
-{
-  std_msgs::Header header;
-  header.frame_id = "default_camera";
-
-  std::chrono::high_resolution_clock::time_point tp =
-      std::chrono::high_resolution_clock::now();
-  int64 ns = tp.time_since_epoch().count();
-  header.stamp.sec = ns / 1000000000;
-  header.stamp.nsec = ns % 1000000000;
-  return header;
-}
@@ -25,9 +25,12 @@
 #include "dynamic_vino_lib/pipeline.h"
 #include "dynamic_vino_lib/outputs/rviz_output.h"
 
-Outputs::RvizOutput::RvizOutput()
+Outputs::RvizOutput::RvizOutput() : RvizOutput(ros::NodeHandle())
+{
+}
+
+Outputs::RvizOutput::RvizOutput(const ros::NodeHandle& nh) : nh_(nh)
 {
-  image_topic_ = nullptr;
   pub_image_ = nh_.advertise<sensor_msgs::Image>("/openvino_toolkit/images", 16);
   image_window_output_ = std::make_shared<Outputs::ImageWindowOutput>("WindowForRviz", 950);
 }
@@ -78,23 +81,7 @@ void Outputs::RvizOutput::handleOutput()
   image_window_output_->setPipeline(getPipeline());
   image_window_output_->decorateFrame();
   cv::Mat frame = image_window_output_->getFrame();
-  std_msgs::Header header = getHeader();
-  std::shared_ptr<cv_bridge::CvImage> cv_ptr =
-    std::make_shared<cv_bridge::CvImage>(header, "bgr8", frame);
-   sensor_msgs::Image image_msg;
-  image_topic_ = cv_ptr->toImageMsg();
-//    image_topic_ = std::make_shared<sensor_msgs::Image>(image_msg);
-  pub_image_.publish(image_topic_);
-}
-  std::shared_ptr<sensor_msgs::Image> image_topic_;
-std_msgs::Header Outputs::RvizOutput::getHeader()
-{
-  std_msgs::Header header;
-  header.frame_id = getPipeline()->getInputDevice()->getFrameID();
-
-  std::chrono::high_resolution_clock::time_point tp = std::chrono::high_resolution_clock::now();
-  int64 ns = tp.time_since_epoch().count();
-  header.stamp.sec = ns / 1000000000;
-  header.stamp.nsec = ns % 1000000000;
-  return header;
+  sensor_msgs::ImagePtr image_msg =
+    cv_bridge::CvImage(header_, "bgr8", frame).toImageMsg();
+  pub_image_.publish(image_msg);
 }
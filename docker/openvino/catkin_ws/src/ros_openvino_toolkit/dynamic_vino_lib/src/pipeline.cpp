@@ -19,9 +19,13 @@
  * @file pipeline.cpp
  */
 
+#include <functional>
+#include <map>
 #include <memory>
 #include <string>
+#include <thread>
 #include <utility>
+#include <vector>
 
 #include <vino_param_lib/param_manager.h>
 #include "dynamic_vino_lib/pipeline.h"
@@ -29,15 +33,23 @@
 Pipeline::Pipeline(const std::string& name)
 {
   params_ = std::make_shared<PipelineParams>(name);
-  counter_ = 0;
+  task_arena_ = std::make_shared<dynamic_vino_lib::TaskArena>();
 }
 
 bool Pipeline::add(const std::string& name,
                    std::shared_ptr<Input::BaseInputDevice> input_device)
 {
+  if (!input_devices_.empty() && name != input_device_name_)
+  {
+    slog::err << "one pipeline only supports ONE input device!" << slog::endl;
+    return false;
+  }
+  if (input_devices_.empty())
+  {
+    next_.insert({"", name});
+  }
   input_device_name_ = name;
-  input_device_ = input_device;
-  next_.insert({"", name});
+  input_devices_.push_back(input_device);
   return true;
 }
 
@@ -111,6 +123,7 @@ bool Pipeline::add(const std::string& parent, const std::string& name,
   }
   next_.insert({parent, name});
   name_to_detection_map_[name] = inference;
+  inference->setTaskArena(task_arena_);
   ++total_inference_;
   return true;
 }
@@ -130,6 +143,7 @@ bool Pipeline::add(const std::string& name,
     ++total_inference_;
   }
   name_to_detection_map_[name] = inference;
+  inference->setTaskArena(task_arena_);
 
   return true;
 }
@@ -183,41 +197,239 @@ void Pipeline::addConnect(const std::string & parent, const std::string & name)
 
 void Pipeline::runOnce()
 {
-  initInferenceCounter();
-
-  if (!input_device_->read(&frame_))
+  auto context = std::make_shared<FrameContext>();
+  auto read_start = std::chrono::high_resolution_clock::now();
+  bool has_new_frame = readFrames(context);
+  profiler_.record("input/" + input_device_name_, read_start);
+  context->read_time = std::chrono::high_resolution_clock::now();
+  /**< while no frame is infered, the results of the frame in flight are
+   * handed out instead of waiting for the next infered frame >**/
+  if (!has_new_frame || !rate_controller_.admit(context->read_time))
   {
-    // throw std::logic_error("Failed to get frame from cv::VideoCapture");
-    slog::warn << "Failed to get frame from input_device." << slog::endl;
+    flush();
     return;
   }
+  context->run_secondary = rate_controller_.isSecondaryEnabled();
 
   countFPS();
-  width_ = frame_.cols;
-  height_ = frame_.rows;
-  for (auto& pair : name_to_output_map_)
+
+  if (!params_->isPipelined())
+  {
+    submitFrame(context);
+    flush();
+    return;
+  }
+
+  /**< The new frame is already captured while the previous one is still on
+   * the device. Results of the previous frame must be taken by the outputs
+   * before the new frame is enqueued, as enqueue resets them. >**/
+  std::shared_ptr<FrameContext> previous = infer_context_;
+  if (previous != nullptr)
+  {
+    waitFrame(previous);
+    deliverResults(previous);
+  }
+  submitFrame(context);
+  if (previous != nullptr)
   {
-    pair.second->feedFrame(frame_);
+    handleOutputs(previous);
   }
-  // auto t0 = std::chrono::high_resolution_clock::now();
+}
+
+void Pipeline::flush()
+{
+  std::shared_ptr<FrameContext> context = infer_context_;
+  if (context == nullptr)
+  {
+    return;
+  }
+  waitFrame(context);
+  deliverResults(context);
+  infer_context_ = nullptr;
+  handleOutputs(context);
+}
+
+bool Pipeline::readFrames(const std::shared_ptr<FrameContext>& context)
+{
+  /**< like the gathering of the multichannel demo, channels are polled until
+   * each of them has a new frame or the deadline is reached. Frames arriving
+   * later are infered with the next frames. >**/
+  auto deadline = std::chrono::high_resolution_clock::now() +
+                  std::chrono::microseconds(
+                      static_cast<int64_t>(max_wait_ms_ * 1000));
+  std::vector<bool> waiting(input_devices_.size(), true);
+  bool any_waiting = true;
+  while (any_waiting)
+  {
+    any_waiting = false;
+    for (size_t channel = 0; channel < input_devices_.size(); ++channel)
+    {
+      if (!waiting[channel])
+      {
+        continue;
+      }
+      auto& device = input_devices_[channel];
+      cv::Mat frame;
+      if (!device->read(&frame))
+      {
+        // throw std::logic_error("Failed to get frame from cv::VideoCapture");
+        slog::warn << "Failed to get frame from input_device." << slog::endl;
+        waiting[channel] = false;
+        continue;
+      }
+      if (!device->isNewFrame())
+      {
+        any_waiting = true;
+        continue;
+      }
+      waiting[channel] = false;
+      /**< detections are scaled to the size of the frames of the batch >**/
+      if (!context->frames.empty() && frame.size() != context->frames[0].size())
+      {
+        slog::warn << "Frame of input channel " << channel << " ("
+                   << frame.cols << "x" << frame.rows
+                   << ") does not match the size of the other channels, "
+                   << "skipped." << slog::endl;
+        continue;
+      }
+      context->frames.push_back(frame);
+      context->headers.push_back(device->getHeader());
+      context->frame_owners.push_back(device->getFrameOwner());
+    }
+    if (input_devices_.size() == 1 ||
+        std::chrono::high_resolution_clock::now() >= deadline)
+    {
+      break;
+    }
+    if (any_waiting)
+    {
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+  }
+  return !context->frames.empty();
+}
+
+void Pipeline::submitFrame(const std::shared_ptr<FrameContext>& context)
+{
+  infer_context_ = context;
+  std::vector<std::string> detection_names;
   for (auto pos = next_.equal_range(input_device_name_);
        pos.first != pos.second; ++pos.first)
   {
-    std::string detection_name = pos.first->second;
-    auto detection_ptr = name_to_detection_map_[detection_name];
-    detection_ptr->enqueue(frame_,
-                           cv::Rect(width_ / 2, height_ / 2, width_, height_));
-    increaseInferenceCounter();
+    detection_names.push_back(pos.first->second);
+  }
+  /**< the inferences run on the input are fed and submitted in parallel >**/
+  task_arena_->parallelFor(static_cast<int>(detection_names.size()),
+                           [&](int n)
+  {
+    const std::string& detection_name = detection_names[n];
+    auto detection_ptr = name_to_detection_map_.at(detection_name);
+    dynamic_vino_lib::ScopedStageTimer timer(profiler_,
+                                             "enqueue/" + detection_name);
+    /**< the frames of all channels are put into the same batch, frames
+     * beyond the batch size into further requests >**/
+    for (size_t i = 0; i < context->frames.size(); ++i)
+    {
+      const cv::Mat& frame = context->frames[i];
+      detection_ptr->setEnqueueFrameIndex(static_cast<int>(i));
+      detection_ptr->enqueue(frame, cv::Rect(frame.cols / 2, frame.rows / 2,
+                                             frame.cols, frame.rows));
+    }
+    increaseInferenceCounter(context, detection_ptr->getEnqueuedRequestNum());
     detection_ptr->submitRequest();
+  });
+}
+
+void Pipeline::waitFrame(const std::shared_ptr<FrameContext>& context)
+{
+  std::unique_lock<std::mutex> lock(context->mutex);
+  context->cv.wait(lock, [context]() { return context->pending_requests == 0; });
+}
+
+void Pipeline::deliverResults(const std::shared_ptr<FrameContext>& context)
+{
+  /**< outputs take the frames one after another, each with its own header
+   * and results. All but the last one are handled here, the last one by
+   * handleOutputs. >**/
+  bool demux = context->frames.size() > 1;
+  for (size_t i = 0; i < context->frames.size(); ++i)
+  {
+    if (i > 0)
+    {
+      handleFrameOutputs();
+    }
+    forEachOutput([&](const std::string&,
+                      const std::shared_ptr<Outputs::BaseOutput>& output)
+    {
+      output->setHeader(context->headers[i]);
+      output->feedFrame(context->frames[i]);
+    });
+    for (auto& ready : context->ready_outputs)
+    {
+      auto detection_ptr = name_to_detection_map_[ready.first];
+      detection_ptr->setOutputFrameIndex(demux ? static_cast<int>(i) : -1);
+      detection_ptr->observeOutput(name_to_output_map_[ready.second]);
+    }
   }
-  std::unique_lock<std::mutex> lock(counter_mutex_);
-  cv_.wait(lock, [this]() { return this->counter_ == 0; });
-  // auto t1 = std::chrono::high_resolution_clock::now();
-  // typedef std::chrono::duration<double, std::ratio<1, 1000>> ms;
+}
 
-  for (auto& pair : name_to_output_map_)
+void Pipeline::handleOutputs(const std::shared_ptr<FrameContext>& context)
+{
+  handleFrameOutputs();
+  profiler_.record("frame/processing", context->read_time);
+  for (auto& header : context->headers)
   {
-    pair.second->handleOutput();
+    if (!header.stamp.isZero())
+    {
+      profiler_.record("frame/capture_to_output",
+                       (ros::Time::now() - header.stamp).toSec() * 1000);
+    }
+  }
+}
+
+void Pipeline::handleFrameOutputs()
+{
+  forEachOutput([this](const std::string& name,
+                       const std::shared_ptr<Outputs::BaseOutput>& output)
+  {
+    dynamic_vino_lib::ScopedStageTimer timer(profiler_, "output/" + name);
+    output->handleOutput();
+  });
+}
+
+void Pipeline::forEachOutput(
+    const std::function<void(const std::string&,
+                             const std::shared_ptr<Outputs::BaseOutput>&)>&
+        func)
+{
+  /**< each output only touches its own state, outputs are run as parallel
+   * tasks. The ones which are not thread safe are run by the pipeline thread
+   * afterwards, so that they always run on the same thread >**/
+  std::vector<std::map<std::string,
+                       std::shared_ptr<Outputs::BaseOutput>>::iterator>
+      outputs;
+  std::vector<std::map<std::string,
+                       std::shared_ptr<Outputs::BaseOutput>>::iterator>
+      serial_outputs;
+  for (auto it = name_to_output_map_.begin(); it != name_to_output_map_.end();
+       ++it)
+  {
+    if (it->second->isThreadSafe())
+    {
+      outputs.push_back(it);
+    }
+    else
+    {
+      serial_outputs.push_back(it);
+    }
+  }
+  task_arena_->parallelFor(static_cast<int>(outputs.size()), [&](int i)
+  {
+    func(outputs[i]->first, outputs[i]->second);
+  });
+  for (auto& it : serial_outputs)
+  {
+    func(it->first, it->second);
   }
 }
 
@@ -235,93 +447,120 @@ void Pipeline::setCallback()
   for (auto& pair : name_to_detection_map_)
   {
     std::string detection_name = pair.first;
-    std::function<void(void)> callb;
-    callb = [detection_name, this]()
+    std::function<void(int)> callb;
+    callb = [detection_name, this](int request_id)
     {
-      this->callback(detection_name);
+      this->callback(detection_name, request_id);
       return;
     };
-    pair.second->getEngine()->getRequest()->SetCompletionCallback(callb);
+    pair.second->getEngine()->setCompletionCallback(callb);
   }
 }
-void Pipeline::callback(const std::string& detection_name)
+void Pipeline::callback(const std::string& detection_name, int request_id)
 {
+  /**< infer_context_ is only replaced after all requests of it finished >**/
+  std::shared_ptr<FrameContext> context = infer_context_;
   auto detection_ptr = name_to_detection_map_[detection_name];
-  detection_ptr->fetchResults();
+  profiler_.record("inference/" + detection_name,
+                   detection_ptr->getRequestElapsedMs(request_id));
+  /**< frames beyond the max batch size are infered by several requests, the
+   * results are passed on once all of them have finished >**/
+  bool collected;
+  {
+    dynamic_vino_lib::ScopedStageTimer timer(profiler_,
+                                             "fetch/" + detection_name);
+    collected = detection_ptr->collectResults(request_id);
+  }
+  if (!collected)
+  {
+    decreaseInferenceCounter(context);
+    return;
+  }
   // set output
+  std::vector<std::string> next_detections;
   for (auto pos = next_.equal_range(detection_name); pos.first != pos.second;
        ++pos.first)
   {
     std::string next_name = pos.first->second;
-    // if next is output, then print
+    // if next is output, results are handed to it once the frame finished
     if (output_names_.find(next_name) != output_names_.end())
     {
-      // name_to_output_map_[next_name]->accept(*detection_ptr->getResult());
-      detection_ptr->observeOutput(name_to_output_map_[next_name]);
+      std::lock_guard<std::mutex> lk(context->mutex);
+      context->ready_outputs.emplace_back(detection_name, next_name);
     }
-    else
+    else if (context->run_secondary &&
+             name_to_detection_map_.find(next_name) !=
+                 name_to_detection_map_.end())
     {
-      auto detection_ptr_iter = name_to_detection_map_.find(next_name);
-      if (detection_ptr_iter != name_to_detection_map_.end())
-      {
-        auto next_detection_ptr = detection_ptr_iter->second;
-        for (int i = 0; i < detection_ptr->getResultsLength(); ++i)
-        {
-          const dynamic_vino_lib::Result* prev_result =
-              detection_ptr->getLocationResult(i);
-          auto clippedRect =
-              prev_result->getLocation() & cv::Rect(0, 0, width_, height_);
-          cv::Mat next_input = frame_(clippedRect);
-          next_detection_ptr->enqueue(next_input, prev_result->getLocation());
-        }
-        if (detection_ptr->getResultsLength() > 0)
-        {
-          increaseInferenceCounter();
-          next_detection_ptr->submitRequest();
-        }
-      }
+      next_detections.push_back(next_name);
     }
   }
+  /**< the inferences run on these results are independent of each other,
+   * they are fed and submitted as parallel tasks >**/
+  task_arena_->parallelFor(static_cast<int>(next_detections.size()),
+                           [&](int i)
+  {
+    submitResults(context, detection_ptr, next_detections[i]);
+  });
 
-  decreaseInferenceCounter();
-  cv_.notify_all();
+  decreaseInferenceCounter(context);
 }
 
-void Pipeline::initInferenceCounter()
+void Pipeline::submitResults(
+    const std::shared_ptr<FrameContext>& context,
+    const std::shared_ptr<dynamic_vino_lib::BaseInference>& detection_ptr,
+    const std::string& next_name)
 {
-  std::lock_guard<std::mutex> lk(counter_mutex_);
-  counter_ = 0;
-  cv_.notify_all();
+  auto next_detection_ptr = name_to_detection_map_.at(next_name);
+  dynamic_vino_lib::ScopedStageTimer timer(profiler_, "enqueue/" + next_name);
+  for (int i = 0; i < detection_ptr->getResultsLength(); ++i)
+  {
+    const dynamic_vino_lib::Result* prev_result =
+        detection_ptr->getLocationResult(i);
+    const cv::Mat& frame = context->frames[prev_result->getFrameIndex()];
+    auto clippedRect = prev_result->getLocation() &
+                       cv::Rect(0, 0, frame.cols, frame.rows);
+    cv::Mat next_input = frame(clippedRect);
+    next_detection_ptr->setEnqueueFrameIndex(prev_result->getFrameIndex());
+    next_detection_ptr->enqueue(next_input, prev_result->getLocation());
+  }
+  int request_num = next_detection_ptr->getEnqueuedRequestNum();
+  if (request_num > 0)
+  {
+    increaseInferenceCounter(context, request_num);
+    next_detection_ptr->submitRequest();
+  }
 }
-void Pipeline::increaseInferenceCounter()
+
+void Pipeline::increaseInferenceCounter(
+    const std::shared_ptr<FrameContext>& context, int request_num)
 {
-  std::lock_guard<std::mutex> lk(counter_mutex_);
-  ++counter_;
+  std::lock_guard<std::mutex> lk(context->mutex);
+  context->pending_requests += request_num;
 }
-void Pipeline::decreaseInferenceCounter()
+void Pipeline::decreaseInferenceCounter(
+    const std::shared_ptr<FrameContext>& context)
 {
-  std::lock_guard<std::mutex> lk(counter_mutex_);
-  --counter_;
+  std::lock_guard<std::mutex> lk(context->mutex);
+  if (--context->pending_requests == 0)
+  {
+    rate_controller_.recordLatency(
+        dynamic_vino_lib::PipelineProfiler::elapsedMs(context->read_time));
+  }
+  context->cv.notify_all();
 }
 
 void Pipeline::countFPS()
 {
-  static int fps = 0;
-
-  static auto t_start = std::chrono::high_resolution_clock::now();
-  static int frame_cnt = 0;
-
-  frame_cnt++;
+  fps_frame_count_++;
 
   auto t_end = std::chrono::high_resolution_clock::now();
   typedef std::chrono::duration<double, std::ratio<1, 1000>> ms;
-  ms secondDetection = std::chrono::duration_cast<ms>(t_end - t_start);
+  ms secondDetection = std::chrono::duration_cast<ms>(t_end - fps_start_);
 
   if (secondDetection.count() > 1000) {
-    fps = frame_cnt;
-    setFPS(fps);
-    frame_cnt = 0;
-    t_start = t_end;
+    setFPS(fps_frame_count_);
+    fps_frame_count_ = 0;
+    fps_start_ = t_end;
   }
-
-} 
+}
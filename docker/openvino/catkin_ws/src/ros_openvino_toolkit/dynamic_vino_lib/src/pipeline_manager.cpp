@@ -19,16 +19,20 @@
  * @file pipeline_manager.cpp
  */
 
+#include <algorithm>
 #include <memory>
 #include <string>
 #include <utility>
+#include <vector>
 
+#include <diagnostic_msgs/DiagnosticArray.h>
 #include <vino_param_lib/param_manager.h>
-#include "dynamic_vino_lib/factory.h"
+#include "dynamic_vino_lib/engines/inference_scheduler.h"
 #include "dynamic_vino_lib/inferences/age_gender_detection.h"
 #include "dynamic_vino_lib/inferences/emotions_detection.h"
 #include "dynamic_vino_lib/inferences/face_detection.h"
 #include "dynamic_vino_lib/inferences/head_pose_detection.h"
+#include "dynamic_vino_lib/inferences/object_detection_yolo.h"
 #include "dynamic_vino_lib/inputs/image_input.h"
 #include "dynamic_vino_lib/inputs/realsense_camera.h"
 #include "dynamic_vino_lib/inputs/realsense_camera_topic.h"
@@ -38,6 +42,7 @@
 #include "dynamic_vino_lib/models/emotion_detection_model.h"
 #include "dynamic_vino_lib/models/face_detection_model.h"
 #include "dynamic_vino_lib/models/head_pose_detection_model.h"
+#include "dynamic_vino_lib/models/object_detection_yolo_model.h"
 #include "dynamic_vino_lib/outputs/image_window_output.h"
 #include "dynamic_vino_lib/outputs/ros_topic_output.h"
 #include "dynamic_vino_lib/outputs/rviz_output.h"
@@ -46,6 +51,10 @@
 #include "dynamic_vino_lib/pipeline_manager.h"
 #include "dynamic_vino_lib/pipeline_params.h"
 
+void PipelineManager::setNodeHandle(const ros::NodeHandle& nh) {
+  node_handle_ = std::make_shared<ros::NodeHandle>(nh);
+}
+
 std::shared_ptr<Pipeline> PipelineManager::createPipeline(
     const Params::ParamManager::PipelineParams& params) {
   if (params.name == "") {
@@ -56,8 +65,10 @@ std::shared_ptr<Pipeline> PipelineManager::createPipeline(
   std::shared_ptr<Pipeline> pipeline = std::make_shared<Pipeline>(params.name);
   pipeline->getParameters()->update(params);
 
+  /**< an input may have several channels, e.g. one per camera topic >**/
   auto inputs = parseInputDevice(params);
-  if (inputs.size() != 1) {
+  if (inputs.empty() ||
+      inputs.count(inputs.begin()->first) != inputs.size()) {
     slog::err << "currently one pipeline only supports ONE input."
               << slog::endl;
     return nullptr;
@@ -91,16 +102,20 @@ std::shared_ptr<Pipeline> PipelineManager::createPipeline(
   pipelines_.insert({params.name, data});
 
   pipeline->setCallback();
+  pipeline->getRateController().configure(params.max_rate,
+                                          params.latency_budget);
+  pipeline->setMaxWait(params.max_wait);
+  pipeline->getTaskArena().configure(params.thread_num);
   slog::info << "One Pipeline Created!" << slog::endl;
   pipeline->printPipeline();
   return pipeline;
 
 }
 
-std::map<std::string, std::shared_ptr<Input::BaseInputDevice>>
+std::multimap<std::string, std::shared_ptr<Input::BaseInputDevice>>
 PipelineManager::parseInputDevice(
     const Params::ParamManager::PipelineParams& params) {
-  std::map<std::string, std::shared_ptr<Input::BaseInputDevice>> inputs;
+  std::multimap<std::string, std::shared_ptr<Input::BaseInputDevice>> inputs;
   for (auto& name : params.inputs) {
     slog::info << "Parsing InputDvice: " << name << slog::endl;
     std::shared_ptr<Input::BaseInputDevice> device = nullptr;
@@ -109,8 +124,24 @@ PipelineManager::parseInputDevice(
     } else if (name == kInputType_StandardCamera) {
       device = std::make_shared<Input::StandardCamera>();
     } else if (name == kInputType_CameraTopic) {
-      device = std::make_shared<Input::RealSenseCameraTopic>();
-      std::cout <<"register yaml"<<std::endl;
+      /**< one channel per topic, infered in the same batch >**/
+      std::vector<std::string> topics = params.input_topics;
+      if (topics.empty()) {
+        topics.push_back(Input::RealSenseCameraTopic::kDefaultTopic);
+      }
+      for (auto& topic : topics) {
+        std::shared_ptr<Input::BaseInputDevice> channel;
+        if (node_handle_ != nullptr) {
+          channel = std::make_shared<Input::RealSenseCameraTopic>(
+              *node_handle_, topic);
+        } else {
+          channel = std::make_shared<Input::RealSenseCameraTopic>(topic);
+        }
+        channel->initialize();
+        inputs.insert({name, channel});
+        slog::info << " ... Adding one Input device: " << name << "("
+                   << topic << ")" << slog::endl;
+      }
     } else if (name == kInputType_Video) {
       if (params.input_meta != "") {
         device = std::make_shared<Input::Video>(params.input_meta);
@@ -139,11 +170,19 @@ PipelineManager::parseOutput(
     slog::info << "Parsing Output: " << name << slog::endl;
     std::shared_ptr<Outputs::BaseOutput> object = nullptr;
     if (name == kOutputTpye_RosTopic) {
-      object = std::make_shared<Outputs::RosTopicOutput>();
+      if (node_handle_ != nullptr) {
+        object = std::make_shared<Outputs::RosTopicOutput>(*node_handle_);
+      } else {
+        object = std::make_shared<Outputs::RosTopicOutput>();
+      }
     } else if (name == kOutputTpye_ImageWindow) {
       object = std::make_shared<Outputs::ImageWindowOutput>("Results");
     } else if (name == kOutputTpye_RViz) {
-      object = std::make_shared<Outputs::RvizOutput>();
+      if (node_handle_ != nullptr) {
+        object = std::make_shared<Outputs::RvizOutput>(*node_handle_);
+      } else {
+        object = std::make_shared<Outputs::RvizOutput>();
+      }
     } else if (name == kOutputTpye_RosService) {
       object = std::make_shared<Outputs::RosServiceOutput>();
     }
@@ -159,27 +198,36 @@ PipelineManager::parseOutput(
 std::map<std::string, std::shared_ptr<dynamic_vino_lib::BaseInference>>
 PipelineManager::parseInference(
     const Params::ParamManager::PipelineParams& params) {
-  /**< update plugins for devices >**/
+  /**< devices are created by the scheduler when first used >**/
   auto pcommon = Params::ParamManager::getInstance().getCommon();
   std::string FLAGS_l = pcommon.custom_cpu_library;
   std::string FLAGS_c = pcommon.custom_cldnn_library;
   bool FLAGS_pc = pcommon.enable_performance_count;
+  Engines::InferenceScheduler::getInstance().configure(
+      pcommon.myriad_device_num, pcommon.device_queue_depth, FLAGS_l, FLAGS_c,
+      FLAGS_pc);
+
+  /**< frame inferences batch no more frames than the input has channels >**/
+  int channel_num = getChannelNum(params);
 
   std::map<std::string, std::shared_ptr<dynamic_vino_lib::BaseInference>>
       inferences;
-  for (auto& infer : params.infers) {
-    if (infer.name.empty() || infer.model.empty()) {
+  for (auto& infer_param : params.infers) {
+    if (infer_param.name.empty() || infer_param.model.empty()) {
       continue;
     }
+    Params::ParamManager::InferenceParams infer = infer_param;
+    Params::ParamManager::InferenceParams frame_infer = infer_param;
+    if (getBatchSize(infer) > channel_num) {
+      frame_infer.batch = channel_num;
+    }
+    fitAutoResize(infer);
+    fitAutoResize(frame_infer);
     slog::info << "Parsing Inference: " << infer.name << slog::endl;
     std::shared_ptr<dynamic_vino_lib::BaseInference> object = nullptr;
-    if (plugins_for_devices_.find(infer.engine) == plugins_for_devices_.end()) {
-      plugins_for_devices_[infer.engine] =
-          *Factory::makePluginByName(infer.engine, FLAGS_l, FLAGS_c, FLAGS_pc);
-    }
 
     if (infer.name == kInferTpye_FaceDetection) {
-      object = createFaceDetection(infer);
+      object = createFaceDetection(frame_infer);
 
     } else if (infer.name == kInferTpye_AgeGenderRecognition) {
       object = createAgeGenderRecognition(infer);
@@ -191,7 +239,10 @@ PipelineManager::parseInference(
       object = createHeadPoseEstimation(infer);
 
     } else if (infer.name == kInferTpye_ObjectDetection) {
-      object = createObjectDetection(infer);
+      object = createObjectDetection(frame_infer);
+
+    } else if (infer.name == kInferTpye_ObjectDetectionYolo) {
+      object = createObjectDetectionYolo(frame_infer);
 
     }
     else if (infer.name == kInferTpye_ObjectSegmentation) {
@@ -206,6 +257,7 @@ PipelineManager::parseInference(
 
 
     if (object != nullptr) {
+      object->enablePerformanceCount(FLAGS_pc);
       inferences.insert({infer.name, object});
       slog::info << " ... Adding one Inference: " << infer.name << slog::endl;
     }
@@ -217,12 +269,12 @@ PipelineManager::parseInference(
 std::shared_ptr<dynamic_vino_lib::BaseInference>
 PipelineManager::createFaceDetection(
     const Params::ParamManager::InferenceParams& infer) {
-  // TODO: add batch size in param_manager
-  auto face_detection_model =
-      std::make_shared<Models::FaceDetectionModel>(infer.model, 1, 1, 1);
-  face_detection_model->modelInit();
+  /**< the batch takes the frames of several input channels >**/
+  auto face_detection_model = getModel<Models::FaceDetectionModel>(
+      infer, 1, 1, getBatchSize(infer));
   auto face_detection_engine = std::make_shared<Engines::Engine>(
-      plugins_for_devices_[infer.engine], face_detection_model);
+      infer.engine, face_detection_model, infer.request_num,
+      isDynamicBatchSupported(infer.engine), infer.priority);
   auto face_inference_ptr = std::make_shared<dynamic_vino_lib::FaceDetection>(
       0.5);  // TODO: add output_threshold in param_manager
   face_inference_ptr->loadNetwork(face_detection_model);
@@ -234,11 +286,11 @@ PipelineManager::createFaceDetection(
 std::shared_ptr<dynamic_vino_lib::BaseInference>
 PipelineManager::createAgeGenderRecognition(
     const Params::ParamManager::InferenceParams& param) {
-  auto model =
-      std::make_shared<Models::AgeGenderDetectionModel>(param.model, 1, 2, 16);
-  model->modelInit();
+  auto model = getModel<Models::AgeGenderDetectionModel>(param, 1, 2,
+                                              getBatchSize(param));
   auto engine = std::make_shared<Engines::Engine>(
-      plugins_for_devices_[param.engine], model);
+      param.engine, model, param.request_num,
+      isDynamicBatchSupported(param.engine), param.priority);
   auto infer = std::make_shared<dynamic_vino_lib::AgeGenderDetection>();
   infer->loadNetwork(model);
   infer->loadEngine(engine);
@@ -249,11 +301,11 @@ PipelineManager::createAgeGenderRecognition(
 std::shared_ptr<dynamic_vino_lib::BaseInference>
 PipelineManager::createEmotionRecognition(
     const Params::ParamManager::InferenceParams& param) {
-  auto model =
-      std::make_shared<Models::EmotionDetectionModel>(param.model, 1, 1, 16);
-  model->modelInit();
+  auto model = getModel<Models::EmotionDetectionModel>(param, 1, 1,
+                                              getBatchSize(param));
   auto engine = std::make_shared<Engines::Engine>(
-      plugins_for_devices_[param.engine], model);
+      param.engine, model, param.request_num,
+      isDynamicBatchSupported(param.engine), param.priority);
   auto infer = std::make_shared<dynamic_vino_lib::EmotionsDetection>();
   infer->loadNetwork(model);
   infer->loadEngine(engine);
@@ -264,11 +316,11 @@ PipelineManager::createEmotionRecognition(
 std::shared_ptr<dynamic_vino_lib::BaseInference>
 PipelineManager::createHeadPoseEstimation(
     const Params::ParamManager::InferenceParams& param) {
-  auto model =
-      std::make_shared<Models::HeadPoseDetectionModel>(param.model, 1, 3, 16);
-  model->modelInit();
+  auto model = getModel<Models::HeadPoseDetectionModel>(param, 1, 3,
+                                              getBatchSize(param));
   auto engine = std::make_shared<Engines::Engine>(
-      plugins_for_devices_[param.engine], model);
+      param.engine, model, param.request_num,
+      isDynamicBatchSupported(param.engine), param.priority);
   auto infer = std::make_shared<dynamic_vino_lib::HeadPoseDetection>();
   infer->loadNetwork(model);
   infer->loadEngine(engine);
@@ -281,10 +333,10 @@ PipelineManager::createObjectDetection(
 const Params::ParamManager::InferenceParams & infer)
 {
   auto object_detection_model =
-    std::make_shared<Models::ObjectDetectionModel>(infer.model, 1, 1, 1);
-  object_detection_model->modelInit();
+    getModel<Models::ObjectDetectionModel>(infer, 1, 1, getBatchSize(infer));
   auto object_detection_engine = std::make_shared<Engines::Engine>(
-    plugins_for_devices_[infer.engine], object_detection_model);
+    infer.engine, object_detection_model, infer.request_num,
+    isDynamicBatchSupported(infer.engine), infer.priority);
   auto object_inference_ptr = std::make_shared<dynamic_vino_lib::ObjectDetection>(
     infer.enable_roi_constraint, infer.confidence_threshold); // To-do theshold configuration
   object_inference_ptr->loadNetwork(object_detection_model);
@@ -293,14 +345,31 @@ const Params::ParamManager::InferenceParams & infer)
   return object_inference_ptr;
 }
 
+std::shared_ptr<dynamic_vino_lib::BaseInference>
+PipelineManager::createObjectDetectionYolo(
+  const Params::ParamManager::InferenceParams & infer)
+{
+  /**< the number of outputs depends on the YOLO version >**/
+  auto yolo_model =
+    getModel<Models::ObjectDetectionYoloModel>(infer, 1, 0, getBatchSize(infer));
+  auto yolo_engine = std::make_shared<Engines::Engine>(
+    infer.engine, yolo_model, infer.request_num,
+    isDynamicBatchSupported(infer.engine), infer.priority);
+  auto yolo_inference_ptr = std::make_shared<dynamic_vino_lib::ObjectDetectionYolo>(
+    infer.confidence_threshold);
+  yolo_inference_ptr->loadNetwork(yolo_model);
+  yolo_inference_ptr->loadEngine(yolo_engine);
+
+  return yolo_inference_ptr;
+}
+
 std::shared_ptr<dynamic_vino_lib::BaseInference>
 PipelineManager::createObjectSegmentation(const Params::ParamManager::InferenceParams & infer)
 {
   auto obejct_segmentation_model =
-    std::make_shared<Models::ObjectSegmentationModel>(infer.model, 1, 2, 1);
-  obejct_segmentation_model->modelInit();
+    getModel<Models::ObjectSegmentationModel>(infer, 1, 2, 1);
   auto obejct_segmentation_engine = std::make_shared<Engines::Engine>(
-    plugins_for_devices_[infer.engine], obejct_segmentation_model);
+    infer.engine, obejct_segmentation_model, infer.request_num, false, infer.priority);
   auto segmentation_inference_ptr = std::make_shared<dynamic_vino_lib::ObjectSegmentation>(0.5);
   segmentation_inference_ptr->loadNetwork(obejct_segmentation_model);
   segmentation_inference_ptr->loadEngine(obejct_segmentation_engine);
@@ -313,29 +382,150 @@ PipelineManager::createPersonReidentification(
   const Params::ParamManager::InferenceParams & infer)
 {
   auto person_reidentification_model =
-    std::make_shared<Models::PersonReidentificationModel>(infer.model, 1, 1, infer.batch);
-  person_reidentification_model->modelInit();
+    getModel<Models::PersonReidentificationModel>(infer, 1, 1, getBatchSize(infer));
   auto person_reidentification_engine = std::make_shared<Engines::Engine>(
-    plugins_for_devices_[infer.engine], person_reidentification_model);
+    infer.engine, person_reidentification_model, infer.request_num,
+    isDynamicBatchSupported(infer.engine), infer.priority);
   auto reidentification_inference_ptr =
-    std::make_shared<dynamic_vino_lib::PersonReidentification>(infer.confidence_threshold);
+    std::make_shared<dynamic_vino_lib::PersonReidentification>(
+      infer.confidence_threshold, infer.gallery_capacity, infer.gallery_max_age,
+      infer.gallery_path);
   reidentification_inference_ptr->loadNetwork(person_reidentification_model);
   reidentification_inference_ptr->loadEngine(person_reidentification_engine);
 
   return reidentification_inference_ptr;
 }
 
+int PipelineManager::getBatchSize(
+    const Params::ParamManager::InferenceParams& infer) {
+  if (infer.batch < 1) {
+    slog::warn << "Invalid batch size(" << infer.batch << ") for "
+               << infer.name << ", use 1 instead." << slog::endl;
+    return 1;
+  }
+  return infer.batch;
+}
+
+void PipelineManager::fitAutoResize(
+    Params::ParamManager::InferenceParams& infer) {
+  if (!infer.auto_resize || getBatchSize(infer) == 1) {
+    return;
+  }
+  int request_num = std::max(infer.request_num, 1) * infer.batch;
+  slog::info << "Auto resize infers one frame per request, " << infer.name
+             << " uses " << request_num << " requests of batch 1 instead of "
+             << infer.request_num << " of batch " << infer.batch
+             << slog::endl;
+  infer.request_num = request_num;
+  infer.batch = 1;
+}
+
+int PipelineManager::getChannelNum(
+    const Params::ParamManager::PipelineParams& params) {
+  for (auto& name : params.inputs) {
+    if (name == kInputType_CameraTopic && !params.input_topics.empty()) {
+      return params.input_topics.size();
+    }
+  }
+  return 1;
+}
+
+bool PipelineManager::isDynamicBatchSupported(const std::string& device) {
+  /**< only CPU and GPU plugins support dynamic batching >**/
+  return device == "CPU" || device == "GPU";
+}
+
 void PipelineManager::threadPipeline(const char* name) {
   PipelineData& p = pipelines_[name];
+  auto pcommon = Params::ParamManager::getInstance().getCommon();
+  ros::WallDuration diagnostics_period(pcommon.diagnostics_period);
+  ros::WallTime next_diagnostics = ros::WallTime::now() + diagnostics_period;
   while (p.state == PipelineState_ThreadRunning && p.pipeline != nullptr && ros::ok()) {
     for (auto& node : p.spin_nodes) {
       ros::spinOnce();
     }
     p.pipeline->runOnce();
+    if (diagnostics_pub_ && ros::WallTime::now() >= next_diagnostics) {
+      publishDiagnostics(p.params.name, p);
+      next_diagnostics = ros::WallTime::now() + diagnostics_period;
+    }
     std::this_thread::sleep_for(std::chrono::milliseconds(1));
   }
+  if (p.pipeline != nullptr) {
+    p.pipeline->flush();
+    if (pcommon.enable_latency_report || pcommon.enable_performance_count) {
+      reportPipeline(p.params.name, p);
+    }
+  }
+}
+
+void PipelineManager::publishDiagnostics(const std::string& name,
+                                         PipelineData& data) {
+  diagnostic_msgs::DiagnosticStatus status;
+  status.level = diagnostic_msgs::DiagnosticStatus::OK;
+  status.name = "dynamic_vino_lib: " + name;
+  status.hardware_id = data.params.inputs.empty() ? "" : data.params.inputs[0];
+  status.message = std::to_string(data.pipeline->getFPS()) + " FPS";
+
+  auto add_value = [&status](const std::string& key, const std::string& value) {
+    diagnostic_msgs::KeyValue kv;
+    kv.key = key;
+    kv.value = value;
+    status.values.push_back(kv);
+  };
+  auto to_ms = [](double ms) {
+    char buffer[32];
+    snprintf(buffer, sizeof(buffer), "%.2f", ms);
+    return std::string(buffer);
+  };
+  add_value("fps", std::to_string(data.pipeline->getFPS()));
+  auto& rate_controller = data.pipeline->getRateController();
+  add_value("skipped frames",
+            std::to_string(rate_controller.takeSkippedFrames()));
+  add_value("secondary inferences",
+            rate_controller.isSecondaryEnabled() ? "enabled" : "skipped");
+  for (auto& stage : data.pipeline->getProfiler().takeWindow()) {
+    if (stage.count == 0) {
+      continue;
+    }
+    add_value(stage.name + " count", std::to_string(stage.count));
+    add_value(stage.name + " mean (ms)", to_ms(stage.mean));
+    add_value(stage.name + " p50 (ms)", to_ms(stage.p50));
+    add_value(stage.name + " p90 (ms)", to_ms(stage.p90));
+    add_value(stage.name + " p99 (ms)", to_ms(stage.p99));
+    add_value(stage.name + " max (ms)", to_ms(stage.max));
+  }
+
+  diagnostic_msgs::DiagnosticArray array;
+  array.header.stamp = ros::Time::now();
+  array.status.push_back(status);
+  diagnostics_pub_.publish(array);
+}
+
+void PipelineManager::reportPipeline(const std::string& name,
+                                     PipelineData& data) {
+  auto pcommon = Params::ParamManager::getInstance().getCommon();
+  if (pcommon.enable_latency_report) {
+    slog::info << "Stage durations of pipeline " << name << ":" << slog::endl;
+    data.pipeline->getProfiler().report(std::cout);
+  }
+  if (pcommon.enable_performance_count) {
+    for (auto& infer : data.pipeline->getInferenceHandle()) {
+      slog::info << "Average performance counts of " << infer.first
+                 << " in pipeline " << name << ":" << slog::endl;
+      printPerformanceCounts(infer.second->getPerformanceCounts(), std::cout,
+                             false);
+    }
+  }
 }
+
 void PipelineManager::runAll() {
+  auto pcommon = Params::ParamManager::getInstance().getCommon();
+  if (!diagnostics_pub_ && pcommon.diagnostics_period > 0) {
+    ros::NodeHandle nh = node_handle_ != nullptr ? *node_handle_ : ros::NodeHandle();
+    diagnostics_pub_ = nh.advertise<diagnostic_msgs::DiagnosticArray>(
+        "/diagnostics", 1);
+  }
   for (auto it = pipelines_.begin(); it != pipelines_.end(); ++it) {
     if(it->second.state != PipelineState_ThreadRunning) {
       it->second.state = PipelineState_ThreadRunning;
@@ -357,7 +547,8 @@ void PipelineManager::stopAll()
 
 void PipelineManager::joinAll() {
   for (auto it = pipelines_.begin(); it != pipelines_.end(); ++it) {
-    if(it->second.thread != nullptr && it->second.state == PipelineState_ThreadRunning) {
+    /**< threads already asked to stop by stopAll() are joined as well >**/
+    if(it->second.thread != nullptr && it->second.thread->joinable()) {
       it->second.thread->join();
     }
   }
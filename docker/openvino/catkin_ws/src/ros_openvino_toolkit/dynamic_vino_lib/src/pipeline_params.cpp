@@ -42,6 +42,13 @@ PipelineParams& PipelineParams::operator=(
   params_.inputs = params.inputs;
   params_.outputs = params.outputs;
   params_.connects = params.connects;
+  params_.input_meta = params.input_meta;
+  params_.input_topics = params.input_topics;
+  params_.max_wait = params.max_wait;
+  params_.pipelined = params.pipelined;
+  params_.max_rate = params.max_rate;
+  params_.latency_budget = params.latency_budget;
+  params_.thread_num = params.thread_num;
 
   return *this;
 }
@@ -82,3 +89,8 @@ bool PipelineParams::isGetFps()
   return std::find(params_.inputs.begin(), params_.inputs.end(),
                    kInputType_Image) == params_.inputs.end();
 }
+
+bool PipelineParams::isPipelined()
+{
+  return params_.pipelined;
+}
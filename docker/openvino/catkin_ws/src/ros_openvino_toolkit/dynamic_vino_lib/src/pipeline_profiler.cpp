@@ -0,0 +1,166 @@
+/*
+ * Copyright (c) 2018 Intel Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * @brief a header file with declaration of PipelineProfiler class
+ * @file pipeline_profiler.cpp
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "dynamic_vino_lib/pipeline_profiler.h"
+
+// LatencyHistogram
+constexpr double dynamic_vino_lib::LatencyHistogram::kFirstBucketMs;
+
+dynamic_vino_lib::LatencyHistogram::LatencyHistogram()
+  : buckets_(kBucketNum, 0)
+{
+}
+
+void dynamic_vino_lib::LatencyHistogram::add(double ms)
+{
+  /**< bucket 0 holds everything below kFirstBucketMs, bucket i > 0 holds
+   * [kFirstBucketMs * 2^((i - 1) / 4), kFirstBucketMs * 2^(i / 4)) >**/
+  int index = 0;
+  if (ms >= kFirstBucketMs)
+  {
+    index = 1 + static_cast<int>(
+        std::floor(std::log2(ms / kFirstBucketMs) * kBucketsPerOctave));
+    index = std::min(index, kBucketNum - 1);
+  }
+  ++buckets_[index];
+  if (count_ == 0)
+  {
+    min_ = max_ = ms;
+  }
+  else
+  {
+    min_ = std::min(min_, ms);
+    max_ = std::max(max_, ms);
+  }
+  ++count_;
+  sum_ += ms;
+}
+
+void dynamic_vino_lib::LatencyHistogram::reset()
+{
+  std::fill(buckets_.begin(), buckets_.end(), 0);
+  count_ = 0;
+  sum_ = min_ = max_ = 0.0;
+}
+
+double dynamic_vino_lib::LatencyHistogram::percentile(double ratio) const
+{
+  if (count_ == 0)
+  {
+    return 0.0;
+  }
+  uint64_t rank = static_cast<uint64_t>(std::ceil(ratio * count_));
+  rank = std::max<uint64_t>(rank, 1);
+  uint64_t seen = 0;
+  int index = 0;
+  for (; index < kBucketNum - 1; ++index)
+  {
+    seen += buckets_[index];
+    if (seen >= rank)
+    {
+      break;
+    }
+  }
+  /**< the geometric center of the bucket, which can not be beyond the
+   * extreme samples >**/
+  double value = index == 0 ? kFirstBucketMs / 2 :
+      kFirstBucketMs * std::exp2((index - 0.5) / kBucketsPerOctave);
+  return std::min(std::max(value, min_), max_);
+}
+
+// PipelineProfiler
+void dynamic_vino_lib::PipelineProfiler::record(const std::string& stage,
+                                                double ms)
+{
+  std::lock_guard<std::mutex> lk(mutex_);
+  Stage& s = stages_[stage];
+  s.total.add(ms);
+  s.window.add(ms);
+}
+
+void dynamic_vino_lib::PipelineProfiler::record(
+    const std::string& stage, const Clock::time_point& start)
+{
+  record(stage, elapsedMs(start));
+}
+
+dynamic_vino_lib::PipelineProfiler::StageSummary
+dynamic_vino_lib::PipelineProfiler::summarize(
+    const std::string& name, const LatencyHistogram& histogram)
+{
+  StageSummary summary;
+  summary.name = name;
+  summary.count = histogram.count();
+  summary.mean = histogram.mean();
+  summary.min = histogram.min();
+  summary.p50 = histogram.percentile(0.5);
+  summary.p90 = histogram.percentile(0.9);
+  summary.p99 = histogram.percentile(0.99);
+  summary.max = histogram.max();
+  return summary;
+}
+
+std::vector<dynamic_vino_lib::PipelineProfiler::StageSummary>
+dynamic_vino_lib::PipelineProfiler::summarize() const
+{
+  std::lock_guard<std::mutex> lk(mutex_);
+  std::vector<StageSummary> summaries;
+  for (auto& stage : stages_)
+  {
+    summaries.push_back(summarize(stage.first, stage.second.total));
+  }
+  return summaries;
+}
+
+std::vector<dynamic_vino_lib::PipelineProfiler::StageSummary>
+dynamic_vino_lib::PipelineProfiler::takeWindow()
+{
+  std::lock_guard<std::mutex> lk(mutex_);
+  std::vector<StageSummary> summaries;
+  for (auto& stage : stages_)
+  {
+    summaries.push_back(summarize(stage.first, stage.second.window));
+    stage.second.window.reset();
+  }
+  return summaries;
+}
+
+void dynamic_vino_lib::PipelineProfiler::report(std::ostream& stream) const
+{
+  char line[256];
+  snprintf(line, sizeof(line), "%-40s %8s %9s %9s %9s %9s %9s %9s\n", "stage",
+           "count", "mean(ms)", "min", "p50", "p90", "p99", "max");
+  stream << line;
+  for (auto& s : summarize())
+  {
+    snprintf(line, sizeof(line),
+             "%-40s %8llu %9.2f %9.2f %9.2f %9.2f %9.2f %9.2f\n",
+             s.name.c_str(), static_cast<unsigned long long>(s.count), s.mean,
+             s.min, s.p50, s.p90, s.p99, s.max);
+    stream << line;
+  }
+}
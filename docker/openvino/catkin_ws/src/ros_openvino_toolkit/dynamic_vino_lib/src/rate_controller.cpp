@@ -0,0 +1,158 @@
+/*
+ * Copyright (c) 2018 Intel Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * @brief a header file with definition of RateController class
+ * @file rate_controller.cpp
+ */
+
+#include "dynamic_vino_lib/rate_controller.h"
+
+void dynamic_vino_lib::RateController::configure(double max_rate,
+                                                 double latency_budget_ms)
+{
+  std::lock_guard<std::mutex> lk(mutex_);
+  min_period_ms_ = max_rate > 0 ? 1000.0 / max_rate : 0.0;
+  budget_ms_ = latency_budget_ms > 0 ? latency_budget_ms : 0.0;
+  period_ms_ = min_period_ms_;
+  has_latency_ = false;
+  secondary_enabled_ = true;
+  samples_since_adapt_ = 0;
+  stretched_ = false;
+  stalled_ = false;
+  has_admitted_ = false;
+  skipped_frames_ = 0;
+}
+
+bool dynamic_vino_lib::RateController::admit(
+    const Clock::time_point& read_time)
+{
+  std::lock_guard<std::mutex> lk(mutex_);
+  typedef std::chrono::duration<double, std::milli> ms;
+  if (period_ms_ <= 0)
+  {
+    return true;
+  }
+  Clock::duration period = std::chrono::duration_cast<Clock::duration>(
+      ms(period_ms_));
+  Clock::duration early = std::chrono::duration_cast<Clock::duration>(
+      ms(period_ms_ * kEarlyRatio));
+  if (has_admitted_ && read_time < next_due_ - early)
+  {
+    skipped_frames_++;
+    return false;
+  }
+  /**< due times advance by whole periods to keep the average rate, unless
+   * the input fell behind by more than a period >**/
+  if (has_admitted_ && read_time < next_due_ + period)
+  {
+    next_due_ += period;
+  }
+  else
+  {
+    next_due_ = read_time + period;
+  }
+  has_admitted_ = true;
+  return true;
+}
+
+void dynamic_vino_lib::RateController::recordLatency(double ms)
+{
+  std::lock_guard<std::mutex> lk(mutex_);
+  latency_ms_ =
+      has_latency_ ? latency_ms_ + kLatencySmoothing * (ms - latency_ms_) : ms;
+  has_latency_ = true;
+  if (budget_ms_ <= 0 || ++samples_since_adapt_ < kAdaptInterval)
+  {
+    return;
+  }
+
+  if (latency_ms_ > budget_ms_)
+  {
+    samples_since_adapt_ = 0;
+    if (secondary_enabled_)
+    {
+      secondary_enabled_ = false;
+      return;
+    }
+    if (stalled_)
+    {
+      /**< only a latency well above the one stretching stopped at means
+       * frames queue up again >**/
+      if (latency_ms_ < stall_latency_ms_ * kPeriodGrowth)
+      {
+        return;
+      }
+      stalled_ = false;
+      stretched_ = false;
+    }
+    if (stretched_ && latency_ms_ > stretch_latency_ms_ * kStretchGainRatio)
+    {
+      /**< the last stretch did not lower the latency, which is then the time
+       * the device takes per frame rather than queueing. Skipping more frames
+       * would only make the results staler, so the period is set back >**/
+      period_ms_ = unstretched_period_ms_;
+      stretched_ = false;
+      stalled_ = true;
+      stall_latency_ms_ = latency_ms_;
+      return;
+    }
+    unstretched_period_ms_ = period_ms_;
+    stretch_latency_ms_ = latency_ms_;
+    stretched_ = true;
+    /**< without a max rate frames come as fast as they are infered, so the
+     * stretching starts from the latency >**/
+    double period = period_ms_ > latency_ms_ ? period_ms_ : latency_ms_;
+    period *= kPeriodGrowth;
+    period_ms_ = period < kMaxPeriodMs ? period : kMaxPeriodMs;
+    return;
+  }
+
+  stretched_ = false;
+  stalled_ = false;
+  if (latency_ms_ < budget_ms_ * kRecoverRatio)
+  {
+    if (period_ms_ > min_period_ms_)
+    {
+      samples_since_adapt_ = 0;
+      period_ms_ *= kPeriodShrink;
+      /**< below the latency the period no longer skips any frame >**/
+      if (period_ms_ < min_period_ms_ || period_ms_ < latency_ms_)
+      {
+        period_ms_ = min_period_ms_;
+      }
+    }
+    else if (!secondary_enabled_)
+    {
+      samples_since_adapt_ = 0;
+      secondary_enabled_ = true;
+    }
+  }
+}
+
+bool dynamic_vino_lib::RateController::isSecondaryEnabled()
+{
+  std::lock_guard<std::mutex> lk(mutex_);
+  return secondary_enabled_;
+}
+
+uint64_t dynamic_vino_lib::RateController::takeSkippedFrames()
+{
+  std::lock_guard<std::mutex> lk(mutex_);
+  uint64_t skipped = skipped_frames_;
+  skipped_frames_ = 0;
+  return skipped;
+}
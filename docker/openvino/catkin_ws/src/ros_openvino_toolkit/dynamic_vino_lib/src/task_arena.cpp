@@ -0,0 +1,82 @@
+/*
+ * Copyright (c) 2018 Intel Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * @brief a header file with definition of TaskArena class
+ * @file task_arena.cpp
+ */
+
+#include "dynamic_vino_lib/task_arena.h"
+#include "dynamic_vino_lib/slog.h"
+
+#ifdef USE_TBB
+#include <tbb/parallel_for.h>
+#include <tbb/task_arena.h>
+#endif
+
+/**< the TBB types are kept out of the header, which is included by users of
+ * the library built without USE_TBB >**/
+class dynamic_vino_lib::TaskArena::Impl
+{
+ public:
+#ifdef USE_TBB
+  explicit Impl(int thread_num)
+      : arena(thread_num > 0 ? thread_num : tbb::task_arena::automatic)
+  {
+  }
+  tbb::task_arena arena;
+#endif
+};
+
+dynamic_vino_lib::TaskArena::TaskArena() = default;
+
+dynamic_vino_lib::TaskArena::~TaskArena() = default;
+
+void dynamic_vino_lib::TaskArena::configure(int thread_num)
+{
+  thread_num_ = thread_num < 0 ? 1 : thread_num;
+  impl_.reset();
+  if (thread_num_ == 1)
+  {
+    return;
+  }
+#ifdef USE_TBB
+  impl_.reset(new Impl(thread_num_));
+#else
+  slog::warn << "dynamic_vino_lib is built without TBB, the tasks of the "
+             << "pipeline run on one thread." << slog::endl;
+  thread_num_ = 1;
+#endif
+}
+
+void dynamic_vino_lib::TaskArena::parallelFor(
+    int n, const std::function<void(int)>& func)
+{
+#ifdef USE_TBB
+  if (impl_ != nullptr && n > 1)
+  {
+    impl_->arena.execute([n, &func]()
+    {
+      tbb::parallel_for(0, n, func);
+    });
+    return;
+  }
+#endif
+  for (int i = 0; i < n; ++i)
+  {
+    func(i);
+  }
+}
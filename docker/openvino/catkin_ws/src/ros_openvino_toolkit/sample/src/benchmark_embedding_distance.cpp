@@ -0,0 +1,150 @@
+/*
+ * Copyright (c) 2018 Intel Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+* \brief A micro benchmark matching a frame of reidentification embeddings
+ * against galleries of 10 to 10k embeddings, comparing the former per-pair
+ * scalar cosine with the kernels of embedding_distance.hpp.
+* \file sample/benchmark_embedding_distance.cpp
+*/
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <functional>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "samples/embedding_distance.hpp"
+
+namespace
+{
+/**
+ * @brief The cosine distance computed by calcSimilarity / CosDistance before,
+ * recomputing both norms for every pair.
+ */
+float referenceCosineDistance(const float* a, const float* b, size_t n)
+{
+  float xy = 0, xx = 0, yy = 0;
+  for (size_t i = 0; i < n; i++)
+  {
+    xy += a[i] * b[i];
+    xx += a[i] * a[i];
+    yy += b[i] * b[i];
+  }
+  return 1.f - xy / (std::sqrt(xx * yy) + embedding_distance::kNormEpsilon);
+}
+
+double measureUs(const std::function<void()>& func, int iterations)
+{
+  func();  // warm up
+  auto t0 = std::chrono::high_resolution_clock::now();
+  for (int i = 0; i < iterations; ++i)
+  {
+    func();
+  }
+  auto t1 = std::chrono::high_resolution_clock::now();
+  typedef std::chrono::duration<double, std::micro> us;
+  return std::chrono::duration_cast<us>(t1 - t0).count() / iterations;
+}
+
+void benchmark(size_t dim, size_t gallery_size, size_t queries, int iterations)
+{
+  std::mt19937 generator(42);
+  std::normal_distribution<float> distribution;
+  std::vector<float> gallery(gallery_size * dim);
+  std::vector<float> frame(queries * dim);
+  for (auto& v : gallery)
+  {
+    v = distribution(generator);
+  }
+  for (auto& v : frame)
+  {
+    v = distribution(generator);
+  }
+  std::vector<float> gallery_norms(gallery_size);
+  embedding_distance::computeNorms(gallery.data(), gallery_size, dim,
+                                   gallery_norms.data());
+
+  std::vector<float> reference(queries * gallery_size);
+  std::vector<float> pairwise(queries * gallery_size);
+  std::vector<float> matrix(queries * gallery_size);
+  double reference_us = measureUs([&]()
+  {
+    for (size_t q = 0; q < queries; q++)
+    {
+      for (size_t g = 0; g < gallery_size; g++)
+      {
+        reference[q * gallery_size + g] = referenceCosineDistance(
+            &frame[q * dim], &gallery[g * dim], dim);
+      }
+    }
+  }, iterations);
+  double pairwise_us = measureUs([&]()
+  {
+    for (size_t q = 0; q < queries; q++)
+    {
+      for (size_t g = 0; g < gallery_size; g++)
+      {
+        pairwise[q * gallery_size + g] = embedding_distance::cosineDistance(
+            &frame[q * dim], &gallery[g * dim], dim);
+      }
+    }
+  }, iterations);
+  /**< the gallery norms are cached, only the frame norms are computed >**/
+  std::vector<float> frame_norms(queries);
+  double matrix_us = measureUs([&]()
+  {
+    embedding_distance::computeNorms(frame.data(), queries, dim,
+                                     frame_norms.data());
+    embedding_distance::cosineDistanceMatrix(
+        frame.data(), frame_norms.data(), queries, gallery.data(),
+        gallery_norms.data(), gallery_size, dim, matrix.data());
+  }, iterations);
+
+  double max_diff = 0;
+  for (size_t i = 0; i < reference.size(); ++i)
+  {
+    max_diff = std::max(max_diff,
+                        static_cast<double>(std::abs(reference[i] - pairwise[i])));
+    max_diff = std::max(max_diff,
+                        static_cast<double>(std::abs(reference[i] - matrix[i])));
+  }
+  printf("dim %3zu  gallery %5zu  queries %2zu  reference %10.1f us  "
+         "pairwise %10.1f us  matrix %10.1f us  speedup %5.2fx  max diff %.1e\n",
+         dim, gallery_size, queries, reference_us, pairwise_us, matrix_us,
+         reference_us / matrix_us, max_diff);
+}
+}  // namespace
+
+int main(int argc, char** argv)
+{
+  int iterations = argc > 1 ? std::stoi(argv[1]) : 20;
+  const size_t dims[] = {256, 512};
+  const size_t gallery_sizes[] = {10, 100, 1000, 10000};
+  for (size_t dim : dims)
+  {
+    for (size_t gallery_size : gallery_sizes)
+    {
+      /**< one and a crowded frame of ROIs >**/
+      benchmark(dim, gallery_size, 1, iterations);
+      benchmark(dim, gallery_size, 16, iterations);
+    }
+  }
+  return 0;
+}
@@ -0,0 +1,134 @@
+/*
+ * Copyright (c) 2018 Intel Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+* \brief A micro benchmark comparing the fused resize + HWC to CHW + scale
+ * kernel used by matU8ToBlob with the former cv::resize + per-pixel loop.
+* \file sample/benchmark_image_to_blob.cpp
+*/
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "opencv2/opencv.hpp"
+#include "samples/image_to_blob.hpp"
+
+namespace
+{
+/**
+ * @brief The loading path matU8ToBlob used before the fused kernel.
+ */
+template <typename T>
+void referenceToBlob(const cv::Mat& orig_image, T* blob_data, int width,
+                     int height, float scale_factor)
+{
+  const int channels = 3;
+  cv::Mat resized_image(orig_image);
+  if (width != orig_image.size().width || height != orig_image.size().height)
+  {
+    cv::resize(orig_image, resized_image, cv::Size(width, height));
+  }
+  for (int c = 0; c < channels; c++)
+  {
+    for (int h = 0; h < height; h++)
+    {
+      for (int w = 0; w < width; w++)
+      {
+        blob_data[c * width * height + h * width + w] =
+            resized_image.at<cv::Vec3b>(h, w)[c] * scale_factor;
+      }
+    }
+  }
+}
+
+template <typename T>
+void fusedToBlob(const cv::Mat& orig_image, T* blob_data, int width,
+                 int height, float scale_factor)
+{
+  image_to_blob::resizeToPlanar<T>(orig_image.data, orig_image.step,
+                                   orig_image.cols, orig_image.rows, 3,
+                                   blob_data, width, height, scale_factor);
+}
+
+double measureUs(const std::function<void()>& func, int iterations)
+{
+  func();  // warm up
+  auto t0 = std::chrono::high_resolution_clock::now();
+  for (int i = 0; i < iterations; ++i)
+  {
+    func();
+  }
+  auto t1 = std::chrono::high_resolution_clock::now();
+  typedef std::chrono::duration<double, std::micro> us;
+  return std::chrono::duration_cast<us>(t1 - t0).count() / iterations;
+}
+
+template <typename T>
+void benchmark(const std::string& name, const cv::Mat& frame, int width,
+               int height, int iterations)
+{
+  std::vector<T> reference(3 * width * height);
+  std::vector<T> fused(3 * width * height);
+  double reference_us = measureUs([&]()
+  {
+    referenceToBlob<T>(frame, reference.data(), width, height, 1.f);
+  }, iterations);
+  double fused_us = measureUs([&]()
+  {
+    fusedToBlob<T>(frame, fused.data(), width, height, 1.f);
+  }, iterations);
+
+  double max_diff = 0;
+  for (size_t i = 0; i < fused.size(); ++i)
+  {
+    max_diff = std::max(max_diff, std::abs(static_cast<double>(fused[i]) -
+                                           static_cast<double>(reference[i])));
+  }
+  printf("%-6s %4dx%-4d -> %3dx%-3d  reference %8.1f us  fused %8.1f us  "
+         "speedup %5.2fx  max diff %.2f\n",
+         name.c_str(), frame.cols, frame.rows, width, height, reference_us,
+         fused_us, reference_us / fused_us, max_diff);
+}
+}  // namespace
+
+int main(int argc, char** argv)
+{
+  int iterations = argc > 1 ? std::stoi(argv[1]) : 200;
+
+  cv::Mat camera_frame(720, 1280, CV_8UC3);
+  cv::randu(camera_frame, cv::Scalar::all(0), cv::Scalar::all(255));
+  // a non-continuous ROI, as fed to the secondary inferences
+  cv::Mat roi = camera_frame(cv::Rect(400, 100, 320, 480));
+  const cv::Size input_sizes[] = {cv::Size(300, 300), cv::Size(544, 320),
+                                  cv::Size(672, 384)};
+
+  for (const auto& size : input_sizes)
+  {
+    benchmark<float>("FP32", camera_frame, size.width, size.height, iterations);
+    benchmark<uint8_t>("U8", camera_frame, size.width, size.height, iterations);
+    benchmark<float>("FP32", roi, size.width, size.height, iterations);
+    cv::Mat same_size(size, CV_8UC3);
+    cv::resize(camera_frame, same_size, size);
+    benchmark<float>("FP32", same_size, size.width, size.height, iterations);
+    benchmark<uint8_t>("U8", same_size, size.width, size.height, iterations);
+  }
+  return 0;
+}
@@ -0,0 +1,340 @@
+/*
+ * Copyright (c) 2018 Intel Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+* \brief A micro benchmark assigning 5 to 500 tracks to detections, comparing
+ * the former square padded Kuhn-Munkres solver of the demos with the dense and
+ * the gated solver of linear_assignment.hpp.
+* \file sample/benchmark_linear_assignment.cpp
+*/
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <functional>
+#include <limits>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "samples/linear_assignment.hpp"
+
+namespace
+{
+/**
+ * @brief The starred zero algorithm of the former KuhnMunkres, on a vector
+ * instead of a cv::Mat, padding the costs to a square matrix.
+ */
+class ReferenceKuhnMunkres
+{
+public:
+  std::vector<int> solve(const std::vector<float>& cost, int rows, int cols)
+  {
+    n_ = std::max(rows, cols);
+    dm_.assign(n_ * n_, 0.f);
+    marked_.assign(n_ * n_, 0);
+    points_.assign(n_ * 2, Point());
+    for (int r = 0; r < rows; ++r)
+    {
+      std::copy(&cost[r * cols], &cost[r * cols] + cols, &dm_[r * n_]);
+    }
+    is_row_visited_.assign(n_, 0);
+    is_col_visited_.assign(n_, 0);
+    run();
+
+    std::vector<int> results(rows, -1);
+    for (int i = 0; i < rows; ++i)
+    {
+      for (int j = 0; j < cols; ++j)
+      {
+        if (marked_[i * n_ + j] == kStar)
+        {
+          results[i] = j;
+        }
+      }
+    }
+    return results;
+  }
+
+private:
+  struct Point
+  {
+    int x = 0;
+    int y = 0;
+  };
+  static const char kStar = 1;
+  static const char kPrime = 2;
+
+  void trySimpleCase()
+  {
+    std::vector<int> is_row_visited(n_, 0);
+    std::vector<int> is_col_visited(n_, 0);
+    for (int row = 0; row < n_; ++row)
+    {
+      float* ptr = &dm_[row * n_];
+      float min_val = *std::min_element(ptr, ptr + n_);
+      for (int col = 0; col < n_; ++col)
+      {
+        ptr[col] -= min_val;
+        if (ptr[col] == 0 && !is_col_visited[col] && !is_row_visited[row])
+        {
+          marked_[row * n_ + col] = kStar;
+          is_col_visited[col] = 1;
+          is_row_visited[row] = 1;
+        }
+      }
+    }
+  }
+
+  bool checkIfOptimumIsFound()
+  {
+    int count = 0;
+    for (int i = 0; i < n_; ++i)
+    {
+      for (int j = 0; j < n_; ++j)
+      {
+        if (marked_[i * n_ + j] == kStar)
+        {
+          is_col_visited_[j] = 1;
+          count++;
+        }
+      }
+    }
+    return count >= n_;
+  }
+
+  Point findUncoveredMinValPos()
+  {
+    float min_val = std::numeric_limits<float>::max();
+    Point pos;
+    for (int i = 0; i < n_; ++i)
+    {
+      if (!is_row_visited_[i])
+      {
+        for (int j = 0; j < n_; ++j)
+        {
+          if (!is_col_visited_[j] && dm_[i * n_ + j] < min_val)
+          {
+            min_val = dm_[i * n_ + j];
+            pos.x = j;
+            pos.y = i;
+          }
+        }
+      }
+    }
+    return pos;
+  }
+
+  void updateDissimilarityMatrix(float val)
+  {
+    for (int i = 0; i < n_; ++i)
+    {
+      for (int j = 0; j < n_; ++j)
+      {
+        if (is_row_visited_[i]) dm_[i * n_ + j] += val;
+        if (!is_col_visited_[j]) dm_[i * n_ + j] -= val;
+      }
+    }
+  }
+
+  int findInRow(int row, int what)
+  {
+    for (int j = 0; j < n_; ++j)
+    {
+      if (marked_[row * n_ + j] == what) return j;
+    }
+    return -1;
+  }
+
+  int findInCol(int col, int what)
+  {
+    for (int i = 0; i < n_; ++i)
+    {
+      if (marked_[i * n_ + col] == what) return i;
+    }
+    return -1;
+  }
+
+  void run()
+  {
+    trySimpleCase();
+    while (!checkIfOptimumIsFound())
+    {
+      while (true)
+      {
+        Point point = findUncoveredMinValPos();
+        float min_val = dm_[point.y * n_ + point.x];
+        if (min_val > 0)
+        {
+          updateDissimilarityMatrix(min_val);
+          continue;
+        }
+        marked_[point.y * n_ + point.x] = kPrime;
+        int col = findInRow(point.y, kStar);
+        if (col >= 0)
+        {
+          is_row_visited_[point.y] = 1;
+          is_col_visited_[col] = 0;
+          continue;
+        }
+        int count = 0;
+        points_[count] = point;
+        while (true)
+        {
+          int row = findInCol(points_[count].x, kStar);
+          if (row < 0) break;
+          count++;
+          points_[count].x = points_[count - 1].x;
+          points_[count].y = row;
+          int prime_col = findInRow(points_[count].y, kPrime);
+          count++;
+          points_[count].x = prime_col;
+          points_[count].y = points_[count - 1].y;
+        }
+        for (int i = 0; i < count + 1; ++i)
+        {
+          char& mark = marked_[points_[i].y * n_ + points_[i].x];
+          mark = mark == kStar ? 0 : kStar;
+        }
+        std::fill(is_row_visited_.begin(), is_row_visited_.end(), 0);
+        std::fill(is_col_visited_.begin(), is_col_visited_.end(), 0);
+        for (auto& mark : marked_)
+        {
+          if (mark == kPrime) mark = 0;
+        }
+        break;
+      }
+    }
+  }
+
+  int n_ = 0;
+  std::vector<float> dm_;
+  std::vector<char> marked_;
+  std::vector<Point> points_;
+  std::vector<int> is_row_visited_;
+  std::vector<int> is_col_visited_;
+};
+
+double measureUs(const std::function<void()>& func, int iterations)
+{
+  func();  // warm up
+  auto t0 = std::chrono::high_resolution_clock::now();
+  for (int i = 0; i < iterations; ++i)
+  {
+    func();
+  }
+  auto t1 = std::chrono::high_resolution_clock::now();
+  typedef std::chrono::duration<double, std::micro> us;
+  return std::chrono::duration_cast<us>(t1 - t0).count() / iterations;
+}
+
+double totalCost(const std::vector<float>& cost, int cols,
+                 const std::vector<int>& row_to_col)
+{
+  double total = 0;
+  for (size_t r = 0; r < row_to_col.size(); ++r)
+  {
+    if (row_to_col[r] >= 0)
+    {
+      total += cost[r * cols + row_to_col[r]];
+    }
+  }
+  return total;
+}
+
+/**
+ * @brief Tracks spread over a frame, each detected near its predicted position,
+ * with 1 - affinity costs falling off with the distance as in the trackers
+ */
+void benchmark(int tracks, int iterations)
+{
+  std::mt19937 generator(42);
+  std::uniform_real_distribution<float> position(0.f, 1920.f);
+  std::normal_distribution<float> jitter(0.f, 10.f);
+  int detections = tracks + tracks / 10;
+  std::vector<float> track_x(tracks), track_y(tracks);
+  for (int t = 0; t < tracks; ++t)
+  {
+    track_x[t] = position(generator);
+    track_y[t] = position(generator) * 0.5625f;
+  }
+  std::vector<float> det_x(detections), det_y(detections);
+  for (int d = 0; d < detections; ++d)
+  {
+    int t = d < tracks ? d : generator() % tracks;
+    det_x[d] = track_x[t] + jitter(generator) * (d < tracks ? 1.f : 5.f);
+    det_y[d] = track_y[t] + jitter(generator) * (d < tracks ? 1.f : 5.f);
+  }
+  std::vector<float> cost(tracks * detections);
+  for (int t = 0; t < tracks; ++t)
+  {
+    for (int d = 0; d < detections; ++d)
+    {
+      float dx = track_x[t] - det_x[d];
+      float dy = track_y[t] - det_y[d];
+      cost[t * detections + d] = 1.f - std::exp(-(dx * dx + dy * dy) / (2 * 50.f * 50.f));
+    }
+  }
+  /**< 1 - strong_affinity_thr of the pedestrian tracker >**/
+  const float gate = 1.f - 0.2805f;
+
+  ReferenceKuhnMunkres reference;
+  linear_assignment::AssignmentSolver solver;
+  std::vector<int> reference_result, dense_result(tracks), gated_result(tracks);
+  double reference_us = measureUs([&]()
+  {
+    reference_result = reference.solve(cost, tracks, detections);
+  }, iterations);
+  double dense_us = measureUs([&]()
+  {
+    solver.solve(cost.data(), tracks, detections, dense_result.data());
+  }, iterations);
+  double gated_us = measureUs([&]()
+  {
+    solver.solve(cost.data(), tracks, detections, gated_result.data(), gate);
+  }, iterations);
+
+  /**< the gated assignment may differ only by pairs the trackers reject >**/
+  int gated_differences = 0;
+  for (int t = 0; t < tracks; ++t)
+  {
+    if (gated_result[t] != dense_result[t] &&
+        !(gated_result[t] < 0 && cost[t * detections + dense_result[t]] >= gate))
+    {
+      gated_differences++;
+    }
+  }
+  printf("tracks %3d  detections %3d  reference %10.1f us  dense %8.1f us  "
+         "gated %8.1f us  speedup %7.1fx / %7.1fx  cost diff %.1e  gated diffs %d\n",
+         tracks, detections, reference_us, dense_us, gated_us,
+         reference_us / dense_us, reference_us / gated_us,
+         std::abs(totalCost(cost, detections, reference_result) -
+                  totalCost(cost, detections, dense_result)),
+         gated_differences);
+}
+}  // namespace
+
+int main(int argc, char** argv)
+{
+  int iterations = argc > 1 ? std::stoi(argv[1]) : 10;
+  const int track_counts[] = {5, 10, 25, 50, 100, 200, 500};
+  for (int tracks : track_counts)
+  {
+    benchmark(tracks, tracks >= 200 ? std::max(1, iterations / 5) : iterations);
+  }
+  return 0;
+}
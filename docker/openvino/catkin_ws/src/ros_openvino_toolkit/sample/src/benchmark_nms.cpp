@@ -0,0 +1,201 @@
+/*
+ * Copyright (c) 2018 Intel Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+* \brief A micro benchmark suppressing 100 to 10000 detected boxes, comparing
+ * the former per pair rectangle intersections of the demos with the hard,
+ * grid, class-aware and soft suppressions of nms.hpp.
+* \file sample/benchmark_nms.cpp
+*/
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <functional>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "samples/nms.hpp"
+
+namespace
+{
+struct Rect
+{
+  int x, y, width, height;
+  int area() const
+  {
+    return width * height;
+  }
+};
+
+/**
+ * @brief The former NonMaxSuppression of the smart classroom demo, with the
+ * cv::Rect intersection written out.
+ */
+std::vector<int> referenceNms(const std::vector<Rect>& rects,
+                              const std::vector<float>& scores,
+                              float overlap_threshold)
+{
+  std::vector<std::pair<float, int> > indexed_scores;
+  for (size_t i = 0; i < rects.size(); ++i)
+  {
+    indexed_scores.emplace_back(scores[i], i);
+  }
+  std::stable_sort(indexed_scores.begin(), indexed_scores.end(),
+                   [](const std::pair<float, int>& a,
+                      const std::pair<float, int>& b)
+  {
+    return a.first > b.first;
+  });
+  std::vector<int> out_indices;
+  for (const auto& item : indexed_scores)
+  {
+    bool keep_idx = true;
+    for (int reference_idx : out_indices)
+    {
+      const Rect& rect1 = rects[item.second];
+      const Rect& rect2 = rects[reference_idx];
+      int x0 = std::max(rect1.x, rect2.x);
+      int y0 = std::max(rect1.y, rect2.y);
+      int x1 = std::min(rect1.x + rect1.width, rect2.x + rect2.width);
+      int y1 = std::min(rect1.y + rect1.height, rect2.y + rect2.height);
+      float overlap = 0.f;
+      if (x1 > x0 && y1 > y0)
+      {
+        const float intersection_area = (x1 - x0) * (y1 - y0);
+        overlap = intersection_area /
+                  (rect1.area() + rect2.area() - intersection_area);
+      }
+      if (overlap > overlap_threshold)
+      {
+        keep_idx = false;
+        break;
+      }
+    }
+    if (keep_idx)
+    {
+      out_indices.push_back(item.second);
+    }
+  }
+  return out_indices;
+}
+
+double measureUs(const std::function<void()>& func, int iterations)
+{
+  func();  // warm up
+  auto t0 = std::chrono::high_resolution_clock::now();
+  for (int i = 0; i < iterations; ++i)
+  {
+    func();
+  }
+  auto t1 = std::chrono::high_resolution_clock::now();
+  typedef std::chrono::duration<double, std::micro> us;
+  return std::chrono::duration_cast<us>(t1 - t0).count() / iterations;
+}
+
+/**
+ * @brief Objects spread over a 1080p frame, each detected several times by
+ * neighbouring anchors as in a dense scene
+ */
+void benchmark(int candidates, int iterations)
+{
+  std::mt19937 generator(42);
+  std::uniform_real_distribution<float> position(0.f, 1.f);
+  std::uniform_int_distribution<int> size(20, 120);
+  std::normal_distribution<float> jitter(0.f, 6.f);
+  std::uniform_real_distribution<float> confidence(0.3f, 1.f);
+  const int per_object = 8;
+  const int classes = 10;
+  std::vector<Rect> rects;
+  std::vector<float> scores;
+  std::vector<int> labels;
+  while (static_cast<int>(rects.size()) < candidates)
+  {
+    int w = size(generator);
+    int h = size(generator) * 2;
+    int x = static_cast<int>(position(generator) * (1920 - w));
+    int y = static_cast<int>(position(generator) * (1080 - h));
+    int label = generator() % classes;
+    for (int d = 0; d < per_object && static_cast<int>(rects.size()) < candidates; ++d)
+    {
+      rects.push_back({x + static_cast<int>(jitter(generator)),
+                       y + static_cast<int>(jitter(generator)), w, h});
+      scores.push_back(confidence(generator));
+      labels.push_back(label);
+    }
+  }
+  nms::BoxSet boxes;
+  for (size_t i = 0; i < rects.size(); ++i)
+  {
+    const Rect& r = rects[i];
+    boxes.add(r.x, r.y, r.x + r.width, r.y + r.height, scores[i], labels[i]);
+  }
+
+  nms::Params params;
+  params.iou_threshold = 0.45f;
+  nms::Params class_params = params;
+  class_params.class_aware = true;
+  nms::Params soft_params = params;
+  soft_params.method = nms::Method::Gaussian;
+  soft_params.score_threshold = 0.3f;
+
+  nms::Suppressor hard(static_cast<size_t>(-1));
+  nms::Suppressor grid(0);
+  nms::Suppressor suppressor;
+  std::vector<int> reference_keep, hard_keep, grid_keep, class_keep, soft_keep;
+  double reference_us = measureUs([&]()
+  {
+    reference_keep = referenceNms(rects, scores, params.iou_threshold);
+  }, iterations);
+  double hard_us = measureUs([&]()
+  {
+    hard.run(boxes, params, hard_keep);
+  }, iterations);
+  double grid_us = measureUs([&]()
+  {
+    grid.run(boxes, params, grid_keep);
+  }, iterations);
+  double class_us = measureUs([&]()
+  {
+    suppressor.run(boxes, class_params, class_keep);
+  }, iterations);
+  double soft_us = measureUs([&]()
+  {
+    suppressor.run(boxes, soft_params, soft_keep);
+  }, iterations);
+
+  printf("boxes %5d  kept %4d  reference %10.1f us  hard %8.1f us  grid %8.1f us  "
+         "speedup %6.1fx / %6.1fx  class-aware %8.1f us  soft %9.1f us  %s\n",
+         candidates, static_cast<int>(reference_keep.size()), reference_us,
+         hard_us, grid_us, reference_us / hard_us, reference_us / grid_us,
+         class_us, soft_us,
+         hard_keep == reference_keep && grid_keep == reference_keep
+             ? "same boxes" : "DIFFERENT BOXES");
+}
+}  // namespace
+
+int main(int argc, char** argv)
+{
+  int iterations = argc > 1 ? std::stoi(argv[1]) : 10;
+  const int candidate_counts[] = {100, 300, 1000, 3000, 10000};
+  for (int candidates : candidate_counts)
+  {
+    benchmark(candidates, candidates >= 3000 ? std::max(1, iterations / 5) : iterations);
+  }
+  return 0;
+}
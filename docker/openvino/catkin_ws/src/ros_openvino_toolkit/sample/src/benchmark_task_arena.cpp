@@ -0,0 +1,119 @@
+/*
+ * Copyright (c) 2018 Intel Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+* \brief A micro benchmark loading the face ROIs of a frame into the input
+ * blob of a secondary inference, one after another as the pipeline did, and
+ * in parallel on TaskArena with several thread budgets.
+* \file sample/benchmark_task_arena.cpp
+*/
+
+#include <chrono>
+#include <cstdio>
+#include <functional>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "dynamic_vino_lib/task_arena.h"
+#include "opencv2/opencv.hpp"
+#include "samples/image_to_blob.hpp"
+
+namespace
+{
+const int kBlobWidth = 62;
+const int kBlobHeight = 62;
+const int kBlobSize = 3 * kBlobWidth * kBlobHeight;
+
+double measureUs(const std::function<void()>& func, int iterations)
+{
+  func();  // warm up
+  auto t0 = std::chrono::high_resolution_clock::now();
+  for (int i = 0; i < iterations; ++i)
+  {
+    func();
+  }
+  auto t1 = std::chrono::high_resolution_clock::now();
+  typedef std::chrono::duration<double, std::micro> us;
+  return std::chrono::duration_cast<us>(t1 - t0).count() / iterations;
+}
+
+void loadRoi(const cv::Mat& roi, float* blob)
+{
+  image_to_blob::resizeToPlanar<float>(roi.data, roi.step, roi.cols,
+                                       roi.rows, 3, blob, kBlobWidth,
+                                       kBlobHeight, 1.f);
+}
+
+void benchmark(const cv::Mat& frame, int roi_num, int iterations)
+{
+  std::mt19937 generator(42);
+  std::uniform_int_distribution<int> size(60, 200);
+  std::vector<cv::Mat> rois;
+  for (int i = 0; i < roi_num; ++i)
+  {
+    int w = size(generator);
+    int h = size(generator);
+    int x = generator() % (frame.cols - w);
+    int y = generator() % (frame.rows - h);
+    rois.push_back(frame(cv::Rect(x, y, w, h)));
+  }
+  std::vector<float> serial(kBlobSize * roi_num);
+  std::vector<float> parallel(kBlobSize * roi_num);
+
+  double serial_us = measureUs([&]()
+  {
+    for (int i = 0; i < roi_num; ++i)
+    {
+      loadRoi(rois[i], serial.data() + i * kBlobSize);
+    }
+  }, iterations);
+  printf("rois %3d  serial %8.1f us", roi_num, serial_us);
+
+  const int thread_nums[] = {2, 4, 0};
+  for (int thread_num : thread_nums)
+  {
+    dynamic_vino_lib::TaskArena arena;
+    arena.configure(thread_num);
+    double parallel_us = measureUs([&]()
+    {
+      arena.parallelFor(roi_num, [&](int i)
+      {
+        loadRoi(rois[i], parallel.data() + i * kBlobSize);
+      });
+    }, iterations);
+    printf("  %s %8.1f us (%4.2fx)",
+           thread_num > 0 ? (std::to_string(thread_num) + " threads").c_str()
+                          : "all cores",
+           parallel_us, serial_us / parallel_us);
+  }
+  printf("  %s\n", serial == parallel ? "same blobs" : "DIFFERENT BLOBS");
+}
+}  // namespace
+
+int main(int argc, char** argv)
+{
+  int iterations = argc > 1 ? std::stoi(argv[1]) : 200;
+
+  cv::Mat camera_frame(720, 1280, CV_8UC3);
+  cv::randu(camera_frame, cv::Scalar::all(0), cv::Scalar::all(255));
+  const int roi_nums[] = {1, 4, 16, 64};
+  for (int roi_num : roi_nums)
+  {
+    benchmark(camera_frame, roi_num, iterations);
+  }
+  return 0;
+}
@@ -0,0 +1,120 @@
+/*
+ * Copyright (c) 2018 Intel Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+* \brief The nodelet version of pipeline_with_params. The pipelines run in
+ * the process of a nodelet manager, so the camera topic from a driver and
+ * the result topics to other nodelets in the same manager are passed by
+ * pointer instead of being serialized.
+* \file sample/pipeline_with_params_nodelet.cpp
+*/
+
+#include <nodelet/nodelet.h>
+#include <pluginlib/class_list_macros.h>
+#include <ros/ros.h>
+
+#include <atomic>
+#include <string>
+
+#include <vino_param_lib/param_manager.h>
+#include "dynamic_vino_lib/pipeline_manager.h"
+#include "dynamic_vino_lib/slog.h"
+#include "inference_engine.hpp"
+
+namespace dynamic_vino_sample
+{
+/**
+ * @class PipelineWithParamsNodelet
+ * @brief Creates and runs the pipelines described by the param file of
+ * private parameter "param_file".
+ *
+ * The pipelines are kept by the process wide ParamManager and
+ * PipelineManager, so one nodelet manager runs one instance at most; put
+ * all the pipelines of the process into its param file.
+ */
+class PipelineWithParamsNodelet : public nodelet::Nodelet
+{
+ public:
+  ~PipelineWithParamsNodelet()
+  {
+    if (!owns_managers_)
+    {
+      return;
+    }
+    PipelineManager::getInstance().stopAll();
+    PipelineManager::getInstance().joinAll();
+    instance_loaded_ = false;
+  }
+
+ private:
+  void onInit() override
+  {
+    if (instance_loaded_.exchange(true))
+    {
+      slog::err << getName() << ": another PipelineWithParams nodelet runs in "
+                << "this nodelet manager already, add the pipelines of "
+                << "this one to its param file instead." << slog::endl;
+      return;
+    }
+    owns_managers_ = true;
+
+    std::string FLAGS_config;
+    getPrivateNodeHandle().param<std::string>(
+        "param_file", FLAGS_config, "/param/pipeline_people.yaml");
+    slog::info << "FLAGS_config=" << FLAGS_config << slog::endl;
+    slog::info << "InferenceEngine: "
+               << InferenceEngine::GetInferenceEngineVersion() << slog::endl;
+
+    try
+    {
+      Params::ParamManager::getInstance().parse(FLAGS_config);
+      Params::ParamManager::getInstance().print();
+
+      auto pipelines = Params::ParamManager::getInstance().getPipelines();
+      if (pipelines.size() < 1)
+      {
+        throw std::logic_error("Pipeline parameters should be set!");
+      }
+
+      // callbacks of the camera topic are served by the nodelet manager
+      PipelineManager::getInstance().setNodeHandle(getNodeHandle());
+      for (auto& p : pipelines)
+      {
+        PipelineManager::getInstance().createPipeline(p);
+      }
+
+      PipelineManager::getInstance().runAll();
+    }
+    catch (const std::exception& error)
+    {
+      slog::err << error.what() << slog::endl;
+    }
+    catch (...)
+    {
+      slog::err << "Unknown/internal exception happened." << slog::endl;
+    }
+  }
+
+  /**< whether a nodelet of the process drives the managers >**/
+  static std::atomic<bool> instance_loaded_;
+  bool owns_managers_ = false;
+};
+
+std::atomic<bool> PipelineWithParamsNodelet::instance_loaded_(false);
+}  // namespace dynamic_vino_sample
+
+PLUGINLIB_EXPORT_CLASS(dynamic_vino_sample::PipelineWithParamsNodelet,
+                       nodelet::Nodelet)
@@ -67,9 +67,15 @@ class ParamManager  // singleton
     std::string engine;
     std::string model;
     std::string label;
-    int batch;
+    int batch = 1;
     float confidence_threshold = 0.5;
     bool enable_roi_constraint = false;
+    int request_num = 1;
+    int priority = 0;
+    bool auto_resize = false;
+    int gallery_capacity = 1000;
+    float gallery_max_age = 0;
+    std::string gallery_path;
   };
   struct PipelineParams
   {
@@ -79,6 +85,12 @@ class ParamManager  // singleton
     std::vector<std::string> outputs;
     std::multimap<std::string, std::string> connects;
     std::string input_meta;
+    std::vector<std::string> input_topics;
+    float max_wait = 0;
+    bool pipelined = false;
+    float max_rate = 0;
+    float latency_budget = 0;
+    int thread_num = 1;
   };
   struct CommonParams
   {
@@ -86,6 +98,10 @@ class ParamManager  // singleton
     std::string custom_cldnn_library;
     bool enable_performance_count = false;
     std::string camera_topic;
+    bool enable_latency_report = false;
+    float diagnostics_period = 1.0;
+    int myriad_device_num = 1;
+    int device_queue_depth = 2;
   };
 
   /**
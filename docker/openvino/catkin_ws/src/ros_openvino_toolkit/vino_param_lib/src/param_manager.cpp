@@ -70,6 +70,10 @@ void operator>>(const YAML::Node& node, ParamManager::CommonParams& common)
   YAML_PARSE(node, "custom_cpu_library", common.custom_cpu_library)
   YAML_PARSE(node, "custom_cldnn_library", common.custom_cldnn_library)
   YAML_PARSE(node, "enable_performance_count", common.enable_performance_count)
+  YAML_PARSE(node, "enable_latency_report", common.enable_latency_report)
+  YAML_PARSE(node, "diagnostics_period", common.diagnostics_period)
+  YAML_PARSE(node, "myriad_device_num", common.myriad_device_num)
+  YAML_PARSE(node, "device_queue_depth", common.device_queue_depth)
 }
 
 void operator>>(const YAML::Node& node,
@@ -81,6 +85,12 @@ void operator>>(const YAML::Node& node,
   YAML_PARSE(node, "outputs", pipeline.outputs)
   YAML_PARSE(node, "connects", pipeline.connects)
   YAML_PARSE(node, "input_path", pipeline.input_meta)
+  YAML_PARSE(node, "input_topics", pipeline.input_topics)
+  YAML_PARSE(node, "max_wait", pipeline.max_wait)
+  YAML_PARSE(node, "pipelined", pipeline.pipelined)
+  YAML_PARSE(node, "max_rate", pipeline.max_rate)
+  YAML_PARSE(node, "latency_budget", pipeline.latency_budget)
+  YAML_PARSE(node, "thread_num", pipeline.thread_num)
   slog::info << "Pipeline Params:name=" << pipeline.name << slog::endl;
 }
 
@@ -105,6 +115,12 @@ void operator>>(const YAML::Node& node, ParamManager::InferenceParams& infer)
   YAML_PARSE(node, "batch", infer.batch)
   YAML_PARSE(node, "confidence_threshold", infer.confidence_threshold)
   YAML_PARSE(node, "enable_roi_constraint", infer.enable_roi_constraint)
+  YAML_PARSE(node, "request_num", infer.request_num)
+  YAML_PARSE(node, "priority", infer.priority)
+  YAML_PARSE(node, "auto_resize", infer.auto_resize)
+  YAML_PARSE(node, "gallery_capacity", infer.gallery_capacity)
+  YAML_PARSE(node, "gallery_max_age", infer.gallery_max_age)
+  YAML_PARSE(node, "gallery_path", infer.gallery_path)
   slog::info << "Inference Params:name=" << infer.name << slog::endl;
 }
 
@@ -160,6 +176,11 @@ void ParamManager::print() const
   for (auto& pipeline : pipelines_)
   {
     slog::info << "Pipeline: " << pipeline.name << slog::endl;
+    slog::info << "\tPipelined: " << pipeline.pipelined << slog::endl;
+    slog::info << "\tMax_rate: " << pipeline.max_rate << slog::endl;
+    slog::info << "\tLatency_budget: " << pipeline.latency_budget << slog::endl;
+    slog::info << "\tMax_wait: " << pipeline.max_wait << slog::endl;
+    slog::info << "\tThread_num: " << pipeline.thread_num << slog::endl;
     slog::info << "\tInputs: ";
     for (auto& i : pipeline.inputs)
     {
@@ -167,6 +188,13 @@ void ParamManager::print() const
     }
     slog::info << slog::endl;
 
+    slog::info << "\tInput_topics: ";
+    for (auto& i : pipeline.input_topics)
+    {
+      slog::info << i.c_str() << ", ";
+    }
+    slog::info << slog::endl;
+
     slog::info << "\tOutputs: ";
     for (auto& i : pipeline.outputs)
     {
@@ -184,6 +212,12 @@ void ParamManager::print() const
       slog::info << "\t\tBatch: " << infer.batch << slog::endl;
       slog::info << "\t\tConfidence_threshold: " << infer.confidence_threshold << slog::endl;
       slog::info << "\t\tEnable_roi_constraint: " << infer.enable_roi_constraint << slog::endl;
+      slog::info << "\t\tRequest_num: " << infer.request_num << slog::endl;
+      slog::info << "\t\tPriority: " << infer.priority << slog::endl;
+      slog::info << "\t\tAuto_resize: " << infer.auto_resize << slog::endl;
+      slog::info << "\t\tGallery_capacity: " << infer.gallery_capacity << slog::endl;
+      slog::info << "\t\tGallery_max_age: " << infer.gallery_max_age << slog::endl;
+      slog::info << "\t\tGallery_path: " << infer.gallery_path << slog::endl;
     }
 
     slog::info << "\tConnections: " << slog::endl;
@@ -202,6 +236,14 @@ void ParamManager::print() const
              << slog::endl;
   slog::info << "\tenable_performance_count: "
              << common_.enable_performance_count << slog::endl;
+  slog::info << "\tenable_latency_report: " << common_.enable_latency_report
+             << slog::endl;
+  slog::info << "\tdiagnostics_period: " << common_.diagnostics_period
+             << slog::endl;
+  slog::info << "\tmyriad_device_num: " << common_.myriad_device_num
+             << slog::endl;
+  slog::info << "\tdevice_queue_depth: " << common_.device_queue_depth
+             << slog::endl;
 }
 
 void ParamManager::parse(std::string path)
@@ -0,0 +1,291 @@
+/*
+// Copyright (c) 2018 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+*/
+
+/**
+ * @brief a header file with dot product, cosine and L2 distance kernels for
+ *        reidentification embeddings, dispatched to AVX2 / SSE at runtime
+ * @file embedding_distance.hpp
+ */
+
+#pragma once
+
+#include <cmath>
+#include <cstddef>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define EMBEDDING_DISTANCE_X86
+#include <immintrin.h>
+#endif
+
+namespace embedding_distance {
+
+/**
+ * @brief Added to the product of norms, so that the cosine of zero vectors is 0
+ */
+const float kNormEpsilon = 1e-6f;
+
+namespace details {
+
+inline float dotScalar(const float* a, const float* b, size_t begin, size_t n) {
+    float sum = 0.f;
+    for (size_t i = begin; i < n; i++) {
+        sum += a[i] * b[i];
+    }
+    return sum;
+}
+
+inline float squaredL2Scalar(const float* a, const float* b, size_t begin, size_t n) {
+    float sum = 0.f;
+    for (size_t i = begin; i < n; i++) {
+        float d = a[i] - b[i];
+        sum += d * d;
+    }
+    return sum;
+}
+
+#ifdef EMBEDDING_DISTANCE_X86
+
+__attribute__((target("avx2,fma")))
+inline float horizontalSum(__m256 v) {
+    __m128 s = _mm_add_ps(_mm256_castps256_ps128(v), _mm256_extractf128_ps(v, 1));
+    s = _mm_add_ps(s, _mm_movehl_ps(s, s));
+    s = _mm_add_ss(s, _mm_shuffle_ps(s, s, 1));
+    return _mm_cvtss_f32(s);
+}
+
+__attribute__((target("sse4.1")))
+inline float horizontalSum(__m128 s) {
+    s = _mm_add_ps(s, _mm_movehl_ps(s, s));
+    s = _mm_add_ss(s, _mm_shuffle_ps(s, s, 1));
+    return _mm_cvtss_f32(s);
+}
+
+/**
+ * @brief Returns the number of elements done, the tail is left to the caller
+ */
+__attribute__((target("avx2,fma")))
+inline size_t dotAVX2(const float* a, const float* b, size_t n, float& sum) {
+    __m256 acc0 = _mm256_setzero_ps();
+    __m256 acc1 = _mm256_setzero_ps();
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        acc0 = _mm256_fmadd_ps(_mm256_loadu_ps(a + i), _mm256_loadu_ps(b + i), acc0);
+        acc1 = _mm256_fmadd_ps(_mm256_loadu_ps(a + i + 8), _mm256_loadu_ps(b + i + 8), acc1);
+    }
+    for (; i + 8 <= n; i += 8) {
+        acc0 = _mm256_fmadd_ps(_mm256_loadu_ps(a + i), _mm256_loadu_ps(b + i), acc0);
+    }
+    sum = horizontalSum(_mm256_add_ps(acc0, acc1));
+    return i;
+}
+
+/**
+ * @brief Dot products of one vector with four others, loading it once
+ */
+__attribute__((target("avx2,fma")))
+inline size_t dot4AVX2(const float* a, const float* const* b, size_t n, float* sums) {
+    __m256 acc0 = _mm256_setzero_ps();
+    __m256 acc1 = _mm256_setzero_ps();
+    __m256 acc2 = _mm256_setzero_ps();
+    __m256 acc3 = _mm256_setzero_ps();
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256 va = _mm256_loadu_ps(a + i);
+        acc0 = _mm256_fmadd_ps(va, _mm256_loadu_ps(b[0] + i), acc0);
+        acc1 = _mm256_fmadd_ps(va, _mm256_loadu_ps(b[1] + i), acc1);
+        acc2 = _mm256_fmadd_ps(va, _mm256_loadu_ps(b[2] + i), acc2);
+        acc3 = _mm256_fmadd_ps(va, _mm256_loadu_ps(b[3] + i), acc3);
+    }
+    sums[0] = horizontalSum(acc0);
+    sums[1] = horizontalSum(acc1);
+    sums[2] = horizontalSum(acc2);
+    sums[3] = horizontalSum(acc3);
+    return i;
+}
+
+__attribute__((target("avx2,fma")))
+inline size_t squaredL2AVX2(const float* a, const float* b, size_t n, float& sum) {
+    __m256 acc = _mm256_setzero_ps();
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256 d = _mm256_sub_ps(_mm256_loadu_ps(a + i), _mm256_loadu_ps(b + i));
+        acc = _mm256_fmadd_ps(d, d, acc);
+    }
+    sum = horizontalSum(acc);
+    return i;
+}
+
+__attribute__((target("sse4.1")))
+inline size_t dotSSE41(const float* a, const float* b, size_t n, float& sum) {
+    __m128 acc0 = _mm_setzero_ps();
+    __m128 acc1 = _mm_setzero_ps();
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        acc0 = _mm_add_ps(acc0, _mm_mul_ps(_mm_loadu_ps(a + i), _mm_loadu_ps(b + i)));
+        acc1 = _mm_add_ps(acc1, _mm_mul_ps(_mm_loadu_ps(a + i + 4), _mm_loadu_ps(b + i + 4)));
+    }
+    sum = horizontalSum(_mm_add_ps(acc0, acc1));
+    return i;
+}
+
+__attribute__((target("sse4.1")))
+inline size_t squaredL2SSE41(const float* a, const float* b, size_t n, float& sum) {
+    __m128 acc = _mm_setzero_ps();
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m128 d = _mm_sub_ps(_mm_loadu_ps(a + i), _mm_loadu_ps(b + i));
+        acc = _mm_add_ps(acc, _mm_mul_ps(d, d));
+    }
+    sum = horizontalSum(acc);
+    return i;
+}
+
+inline bool hasAVX2() {
+    static const bool supported =
+        __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+    return supported;
+}
+
+inline bool hasSSE41() {
+    static const bool supported = __builtin_cpu_supports("sse4.1");
+    return supported;
+}
+
+#endif  // EMBEDDING_DISTANCE_X86
+
+}  // namespace details
+
+/**
+ * @brief Dot product of two vectors of n floats
+ */
+inline float dot(const float* a, const float* b, size_t n) {
+    float sum = 0.f;
+    size_t done = 0;
+#ifdef EMBEDDING_DISTANCE_X86
+    if (details::hasAVX2()) {
+        done = details::dotAVX2(a, b, n, sum);
+    } else if (details::hasSSE41()) {
+        done = details::dotSSE41(a, b, n, sum);
+    }
+#endif
+    return sum + details::dotScalar(a, b, done, n);
+}
+
+inline float squaredNorm(const float* a, size_t n) {
+    return dot(a, a, n);
+}
+
+/**
+ * @brief Squared euclidean distance of two vectors of n floats
+ */
+inline float squaredL2Distance(const float* a, const float* b, size_t n) {
+    float sum = 0.f;
+    size_t done = 0;
+#ifdef EMBEDDING_DISTANCE_X86
+    if (details::hasAVX2()) {
+        done = details::squaredL2AVX2(a, b, n, sum);
+    } else if (details::hasSSE41()) {
+        done = details::squaredL2SSE41(a, b, n, sum);
+    }
+#endif
+    return sum + details::squaredL2Scalar(a, b, done, n);
+}
+
+inline float l2Distance(const float* a, const float* b, size_t n) {
+    return std::sqrt(squaredL2Distance(a, b, n));
+}
+
+/**
+ * @brief Cosine similarity in [-1, 1], xy / (|x| |y| + kNormEpsilon)
+ */
+inline float cosineSimilarity(const float* a, const float* b, size_t n) {
+    float xy = dot(a, b, n);
+    float xx = squaredNorm(a, n);
+    float yy = squaredNorm(b, n);
+    return xy / (std::sqrt(xx * yy) + kNormEpsilon);
+}
+
+/**
+ * @brief Cosine distance in [0, 2], 1 - cosineSimilarity
+ */
+inline float cosineDistance(const float* a, const float* b, size_t n) {
+    return 1.f - cosineSimilarity(a, b, n);
+}
+
+/**
+ * @brief Scales a vector to unit length, zero vectors are left as they are
+ */
+inline void normalize(float* a, size_t n) {
+    float norm = std::sqrt(squaredNorm(a, n));
+    if (norm > 0.f) {
+        float inv = 1.f / norm;
+        for (size_t i = 0; i < n; i++) {
+            a[i] *= inv;
+        }
+    }
+}
+
+/**
+ * @brief Computes the norm of each row of a row-major rows x dim matrix, to be
+ *        cached and passed to cosineDistanceMatrix
+ */
+inline void computeNorms(const float* m, size_t rows, size_t dim, float* norms) {
+    for (size_t r = 0; r < rows; r++) {
+        norms[r] = std::sqrt(squaredNorm(m + r * dim, dim));
+    }
+}
+
+/**
+ * @brief Cosine distances of every row of a to every row of b.
+ * @param a - row-major rows_a x dim matrix
+ * @param norms_a - norms of the rows of a, see computeNorms
+ * @param b - row-major rows_b x dim matrix
+ * @param norms_b - norms of the rows of b, see computeNorms
+ * @param distances - row-major rows_a x rows_b output, 1 - cosine similarity
+ */
+inline void cosineDistanceMatrix(const float* a, const float* norms_a, size_t rows_a,
+                                 const float* b, const float* norms_b, size_t rows_b,
+                                 size_t dim, float* distances) {
+    // b is walked once, four rows at a time which stay in cache while all
+    // rows of a are matched against them
+    size_t j = 0;
+#ifdef EMBEDDING_DISTANCE_X86
+    if (details::hasAVX2()) {
+        for (; j + 4 <= rows_b; j += 4) {
+            const float* rows[4] = {b + j * dim, b + (j + 1) * dim,
+                                    b + (j + 2) * dim, b + (j + 3) * dim};
+            for (size_t i = 0; i < rows_a; i++) {
+                const float* row_a = a + i * dim;
+                float sums[4];
+                size_t done = details::dot4AVX2(row_a, rows, dim, sums);
+                for (size_t k = 0; k < 4; k++) {
+                    sums[k] += details::dotScalar(row_a, rows[k], done, dim);
+                    distances[i * rows_b + j + k] =
+                        1.f - sums[k] / (norms_a[i] * norms_b[j + k] + kNormEpsilon);
+                }
+            }
+        }
+    }
+#endif
+    for (; j < rows_b; j++) {
+        for (size_t i = 0; i < rows_a; i++) {
+            float xy = dot(a + i * dim, b + j * dim, dim);
+            distances[i * rows_b + j] = 1.f - xy / (norms_a[i] * norms_b[j] + kNormEpsilon);
+        }
+    }
+}
+
+}  // namespace embedding_distance
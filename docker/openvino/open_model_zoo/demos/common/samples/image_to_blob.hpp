@@ -0,0 +1,365 @@
+/*
+// Copyright (c) 2018 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+*/
+
+/**
+ * @brief a header file with a fused resize + HWC to CHW + scale kernel used to
+ *        fill network input blobs from interleaved 8-bit images
+ * @file image_to_blob.hpp
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define IMAGE_TO_BLOB_X86
+#include <immintrin.h>
+#endif
+
+namespace image_to_blob {
+namespace details {
+
+/**
+ * @brief Source taps of one destination coordinate for bilinear resize,
+ *        following the pixel center convention of cv::resize(INTER_LINEAR)
+ */
+struct Taps {
+    int first;
+    int second;
+    float weight;  // weight of the second tap
+};
+
+inline void computeTaps(int srcSize, int dstSize, std::vector<Taps>& taps) {
+    taps.resize(dstSize);
+    const float scale = static_cast<float>(srcSize) / dstSize;
+    for (int d = 0; d < dstSize; d++) {
+        float s = (d + 0.5f) * scale - 0.5f;
+        int first = static_cast<int>(std::floor(s));
+        float weight = s - first;
+        if (first < 0) {
+            first = 0;
+            weight = 0.f;
+        }
+        if (first >= srcSize - 1) {
+            first = srcSize - 1;
+            weight = 0.f;
+        }
+        taps[d].first = first;
+        taps[d].second = std::min(first + 1, srcSize - 1);
+        taps[d].weight = weight;
+    }
+}
+
+template <typename T>
+inline T convertPixel(float value);
+
+template <>
+inline float convertPixel<float>(float value) {
+    return value;
+}
+
+// Rounds half to even like _mm_cvtps_epi32 under the default rounding mode,
+// so the vector and scalar paths give the same bytes
+template <>
+inline uint8_t convertPixel<uint8_t>(float value) {
+    int rounded = static_cast<int>(std::lrint(value));
+    return static_cast<uint8_t>(std::min(std::max(rounded, 0), 255));
+}
+
+/**
+ * @brief Blends two planar float rows vertically, scales and converts them
+ *        into the destination plane: dst = (top + (bottom - top) * w) * scale
+ */
+template <typename T>
+inline void blendRowScalar(const float* top, const float* bottom, float weight,
+                           float scale, T* dst, int begin, int width) {
+    for (int x = begin; x < width; x++) {
+        dst[x] = convertPixel<T>((top[x] + (bottom[x] - top[x]) * weight) * scale);
+    }
+}
+
+/**
+ * @brief Converts and scales an 8-bit plane row, dst = src * scale
+ */
+template <typename T>
+inline void convertRowScalar(const uint8_t* src, int stride, float scale,
+                             T* dst, int begin, int width) {
+    for (int x = begin; x < width; x++) {
+        dst[x] = convertPixel<T>(src[x * stride] * scale);
+    }
+}
+
+#ifdef IMAGE_TO_BLOB_X86
+
+__attribute__((target("avx2")))
+inline int blendRowAVX2(const float* top, const float* bottom, float weight,
+                        float scale, float* dst, int width) {
+    const __m256 w = _mm256_set1_ps(weight);
+    const __m256 s = _mm256_set1_ps(scale);
+    int x = 0;
+    for (; x + 8 <= width; x += 8) {
+        __m256 t = _mm256_loadu_ps(top + x);
+        __m256 b = _mm256_loadu_ps(bottom + x);
+        __m256 v = _mm256_add_ps(t, _mm256_mul_ps(_mm256_sub_ps(b, t), w));
+        _mm256_storeu_ps(dst + x, _mm256_mul_ps(v, s));
+    }
+    return x;
+}
+
+__attribute__((target("avx2")))
+inline int blendRowAVX2(const float* top, const float* bottom, float weight,
+                        float scale, uint8_t* dst, int width) {
+    const __m256 w = _mm256_set1_ps(weight);
+    const __m256 s = _mm256_set1_ps(scale);
+    int x = 0;
+    for (; x + 8 <= width; x += 8) {
+        __m256 t = _mm256_loadu_ps(top + x);
+        __m256 b = _mm256_loadu_ps(bottom + x);
+        __m256 v = _mm256_add_ps(t, _mm256_mul_ps(_mm256_sub_ps(b, t), w));
+        __m256i i32 = _mm256_cvtps_epi32(_mm256_mul_ps(v, s));
+        __m128i i16 = _mm_packus_epi32(_mm256_castsi256_si128(i32),
+                                       _mm256_extracti128_si256(i32, 1));
+        _mm_storel_epi64(reinterpret_cast<__m128i*>(dst + x), _mm_packus_epi16(i16, i16));
+    }
+    return x;
+}
+
+__attribute__((target("sse4.1")))
+inline int blendRowSSE41(const float* top, const float* bottom, float weight,
+                         float scale, float* dst, int width) {
+    const __m128 w = _mm_set1_ps(weight);
+    const __m128 s = _mm_set1_ps(scale);
+    int x = 0;
+    for (; x + 4 <= width; x += 4) {
+        __m128 t = _mm_loadu_ps(top + x);
+        __m128 b = _mm_loadu_ps(bottom + x);
+        __m128 v = _mm_add_ps(t, _mm_mul_ps(_mm_sub_ps(b, t), w));
+        _mm_storeu_ps(dst + x, _mm_mul_ps(v, s));
+    }
+    return x;
+}
+
+__attribute__((target("sse4.1")))
+inline int blendRowSSE41(const float* top, const float* bottom, float weight,
+                         float scale, uint8_t* dst, int width) {
+    const __m128 w = _mm_set1_ps(weight);
+    const __m128 s = _mm_set1_ps(scale);
+    int x = 0;
+    for (; x + 4 <= width; x += 4) {
+        __m128 t = _mm_loadu_ps(top + x);
+        __m128 b = _mm_loadu_ps(bottom + x);
+        __m128 v = _mm_add_ps(t, _mm_mul_ps(_mm_sub_ps(b, t), w));
+        __m128i i32 = _mm_cvtps_epi32(_mm_mul_ps(v, s));
+        __m128i i16 = _mm_packus_epi32(i32, i32);
+        int packed = _mm_cvtsi128_si32(_mm_packus_epi16(i16, i16));
+        std::copy(reinterpret_cast<const uint8_t*>(&packed),
+                  reinterpret_cast<const uint8_t*>(&packed) + 4, dst + x);
+    }
+    return x;
+}
+
+/**
+ * @brief Splits 16 interleaved BGR pixels into three 16-byte planes
+ */
+__attribute__((target("sse4.1")))
+inline void deinterleaveBGR16(const uint8_t* src, __m128i& p0, __m128i& p1, __m128i& p2) {
+    const __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src));
+    const __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + 16));
+    const __m128i c = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + 32));
+    const char z = -1;
+
+    p0 = _mm_or_si128(_mm_or_si128(
+             _mm_shuffle_epi8(a, _mm_setr_epi8(0, 3, 6, 9, 12, 15, z, z, z, z, z, z, z, z, z, z)),
+             _mm_shuffle_epi8(b, _mm_setr_epi8(z, z, z, z, z, z, 2, 5, 8, 11, 14, z, z, z, z, z))),
+             _mm_shuffle_epi8(c, _mm_setr_epi8(z, z, z, z, z, z, z, z, z, z, z, 1, 4, 7, 10, 13)));
+    p1 = _mm_or_si128(_mm_or_si128(
+             _mm_shuffle_epi8(a, _mm_setr_epi8(1, 4, 7, 10, 13, z, z, z, z, z, z, z, z, z, z, z)),
+             _mm_shuffle_epi8(b, _mm_setr_epi8(z, z, z, z, z, 0, 3, 6, 9, 12, 15, z, z, z, z, z))),
+             _mm_shuffle_epi8(c, _mm_setr_epi8(z, z, z, z, z, z, z, z, z, z, z, 2, 5, 8, 11, 14)));
+    p2 = _mm_or_si128(_mm_or_si128(
+             _mm_shuffle_epi8(a, _mm_setr_epi8(2, 5, 8, 11, 14, z, z, z, z, z, z, z, z, z, z, z)),
+             _mm_shuffle_epi8(b, _mm_setr_epi8(z, z, z, z, z, 1, 4, 7, 10, 13, z, z, z, z, z, z))),
+             _mm_shuffle_epi8(c, _mm_setr_epi8(z, z, z, z, z, z, z, z, z, z, 0, 3, 6, 9, 12, 15)));
+}
+
+__attribute__((target("sse4.1")))
+inline void storeScaled16(__m128i plane, __m128 s, float* dst) {
+    for (int i = 0; i < 4; i++) {
+        __m128 v = _mm_cvtepi32_ps(_mm_cvtepu8_epi32(plane));
+        _mm_storeu_ps(dst + i * 4, _mm_mul_ps(v, s));
+        plane = _mm_srli_si128(plane, 4);
+    }
+}
+
+__attribute__((target("sse4.1")))
+inline void storeScaled16(__m128i plane, __m128 s, uint8_t* dst) {
+    if (_mm_movemask_ps(_mm_cmpneq_ps(s, _mm_set1_ps(1.f))) == 0) {
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst), plane);
+        return;
+    }
+    __m128i i32[4];
+    for (int i = 0; i < 4; i++) {
+        __m128 v = _mm_cvtepi32_ps(_mm_cvtepu8_epi32(plane));
+        i32[i] = _mm_cvtps_epi32(_mm_mul_ps(v, s));
+        plane = _mm_srli_si128(plane, 4);
+    }
+    __m128i lo = _mm_packus_epi32(i32[0], i32[1]);
+    __m128i hi = _mm_packus_epi32(i32[2], i32[3]);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst), _mm_packus_epi16(lo, hi));
+}
+
+template <typename T>
+__attribute__((target("sse4.1")))
+inline int convertRowBGRSSE41(const uint8_t* src, float scale,
+                              T* dst0, T* dst1, T* dst2, int width) {
+    const __m128 s = _mm_set1_ps(scale);
+    int x = 0;
+    for (; x + 16 <= width; x += 16) {
+        __m128i p0, p1, p2;
+        deinterleaveBGR16(src + x * 3, p0, p1, p2);
+        storeScaled16(p0, s, dst0 + x);
+        storeScaled16(p1, s, dst1 + x);
+        storeScaled16(p2, s, dst2 + x);
+    }
+    return x;
+}
+
+inline bool hasAVX2() {
+    static const bool supported = __builtin_cpu_supports("avx2");
+    return supported;
+}
+
+inline bool hasSSE41() {
+    static const bool supported = __builtin_cpu_supports("sse4.1");
+    return supported;
+}
+
+#endif  // IMAGE_TO_BLOB_X86
+
+template <typename T>
+inline void blendRow(const float* top, const float* bottom, float weight,
+                     float scale, T* dst, int width) {
+    int done = 0;
+#ifdef IMAGE_TO_BLOB_X86
+    if (hasAVX2()) {
+        done = blendRowAVX2(top, bottom, weight, scale, dst, width);
+    } else if (hasSSE41()) {
+        done = blendRowSSE41(top, bottom, weight, scale, dst, width);
+    }
+#endif
+    blendRowScalar(top, bottom, weight, scale, dst, done, width);
+}
+
+/**
+ * @brief Same size path: only de-interleaves, converts and scales
+ */
+template <typename T>
+inline void convertImage(const uint8_t* src, size_t srcStep, int width, int height,
+                         int channels, float scale, T* dst) {
+    const size_t planeSize = static_cast<size_t>(width) * height;
+    for (int y = 0; y < height; y++) {
+        const uint8_t* srcRow = src + y * srcStep;
+        int done = 0;
+#ifdef IMAGE_TO_BLOB_X86
+        if (channels == 3 && hasSSE41()) {
+            T* dstRow = dst + static_cast<size_t>(y) * width;
+            done = convertRowBGRSSE41(srcRow, scale, dstRow, dstRow + planeSize,
+                                      dstRow + 2 * planeSize, width);
+        }
+#endif
+        for (int c = 0; c < channels; c++) {
+            convertRowScalar(srcRow + c, channels, scale,
+                             dst + c * planeSize + static_cast<size_t>(y) * width, done, width);
+        }
+    }
+}
+
+}  // namespace details
+
+/**
+ * @brief Resizes an interleaved 8-bit image (BGR, HWC) with bilinear
+ *        interpolation, splits it into planes (CHW) and multiplies it by a
+ *        scale factor, writing the result straight into blob memory.
+ *        Replaces cv::resize into a temporary image followed by a per-pixel
+ *        copy loop.
+ * @param src - pointer to the first pixel of the source image (may be a ROI)
+ * @param srcStep - distance in bytes between source rows
+ * @param srcWidth - source width in pixels
+ * @param srcHeight - source height in pixels
+ * @param channels - number of interleaved channels
+ * @param dst - destination planes, channels * dstHeight * dstWidth elements
+ * @param dstWidth - destination width
+ * @param dstHeight - destination height
+ * @param scale - factor applied to every value
+ */
+template <typename T>
+void resizeToPlanar(const uint8_t* src, size_t srcStep, int srcWidth, int srcHeight,
+                    int channels, T* dst, int dstWidth, int dstHeight, float scale = 1.f) {
+    if (srcWidth == dstWidth && srcHeight == dstHeight) {
+        details::convertImage(src, srcStep, srcWidth, srcHeight, channels, scale, dst);
+        return;
+    }
+
+    std::vector<details::Taps> xTaps, yTaps;
+    details::computeTaps(srcWidth, dstWidth, xTaps);
+    details::computeTaps(srcHeight, dstHeight, yTaps);
+
+    // Horizontally resized planar rows of the two source rows in use
+    std::vector<float> rows(2 * channels * dstWidth);
+    float* rowBuf[2] = {rows.data(), rows.data() + channels * dstWidth};
+    int rowIndex[2] = {-1, -1};
+
+    auto resizeRow = [&](int srcY, float* out) {
+        const uint8_t* srcRow = src + srcY * srcStep;
+        for (int x = 0; x < dstWidth; x++) {
+            const uint8_t* p0 = srcRow + xTaps[x].first * channels;
+            const uint8_t* p1 = srcRow + xTaps[x].second * channels;
+            const float w = xTaps[x].weight;
+            for (int c = 0; c < channels; c++) {
+                out[c * dstWidth + x] = p0[c] + (p1[c] - p0[c]) * w;
+            }
+        }
+    };
+
+    const size_t planeSize = static_cast<size_t>(dstWidth) * dstHeight;
+    for (int y = 0; y < dstHeight; y++) {
+        if (rowIndex[0] != yTaps[y].first) {
+            // moving down, the previous bottom row becomes the top one
+            if (rowIndex[1] == yTaps[y].first) {
+                std::swap(rowBuf[0], rowBuf[1]);
+                std::swap(rowIndex[0], rowIndex[1]);
+            } else {
+                resizeRow(yTaps[y].first, rowBuf[0]);
+                rowIndex[0] = yTaps[y].first;
+            }
+        }
+        if (rowIndex[1] != yTaps[y].second) {
+            resizeRow(yTaps[y].second, rowBuf[1]);
+            rowIndex[1] = yTaps[y].second;
+        }
+        for (int c = 0; c < channels; c++) {
+            details::blendRow(rowBuf[0] + c * dstWidth, rowBuf[1] + c * dstWidth,
+                              yTaps[y].weight, scale,
+                              dst + c * planeSize + static_cast<size_t>(y) * dstWidth, dstWidth);
+        }
+    }
+}
+
+}  // namespace image_to_blob
@@ -0,0 +1,303 @@
+/*
+// Copyright (c) 2018 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+*/
+
+/**
+ * @brief a header file with a rectangular linear assignment solver working on
+ *        a flat row-major cost buffer, with optional gating of infeasible pairs
+ * @file linear_assignment.hpp
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <limits>
+#include <numeric>
+#include <vector>
+
+namespace linear_assignment {
+
+/**
+ * @brief Column of a row that is not assigned
+ */
+const int kUnassigned = -1;
+
+/**
+ * @brief Gate under which every pair is feasible
+ */
+const float kNoGate = std::numeric_limits<float>::infinity();
+
+/**
+ * @class AssignmentSolver
+ * @brief Solves the linear assignment problem for rows x cols costs with the
+ *        Jonker-Volgenant shortest augmenting path method, in O(rows^2 cols)
+ *        for rows <= cols, without padding the matrix to a square one.
+ *
+ * With a gate, pairs costing gate or more are never assigned, and leaving a
+ * row unassigned is preferred over such pairs. The rows and columns are split
+ * into the connected components of the feasible pairs, each solved on its
+ * own, so sparse problems cost far less than the dense size. The solver keeps
+ * its buffers between calls, so an instance should be reused.
+ */
+class AssignmentSolver {
+public:
+    /**
+     * @brief Assigns every row to at most one column and every column to at
+     *        most one row, minimizing the sum of the assigned costs.
+     * @param cost - row-major rows x cols costs, finite where below the gate
+     * @param gate - pairs costing this or more are infeasible
+     * @param row_to_col - output of rows elements, the column of each row or
+     *        kUnassigned. If there are more rows than columns or pairs are
+     *        gated, some rows are left unassigned.
+     * @return Number of assigned rows
+     */
+    size_t solve(const float* cost, size_t rows, size_t cols, int* row_to_col,
+                 float gate = kNoGate) {
+        std::fill(row_to_col, row_to_col + rows, kUnassigned);
+        if (rows == 0 || cols == 0) {
+            return 0;
+        }
+        if (gate == kNoGate) {
+            return solveDense(cost, rows, cols, row_to_col);
+        }
+        findComponents(cost, rows, cols, gate);
+
+        size_t assigned = 0;
+        for (size_t c = 0; c < component_rows_.size(); c++) {
+            const std::vector<int>& comp_rows = component_rows_[c];
+            const std::vector<int>& comp_cols = component_cols_[c];
+            if (comp_rows.empty() || comp_cols.empty()) {
+                continue;
+            }
+            if (comp_rows.size() == 1 && comp_cols.size() == 1) {
+                row_to_col[comp_rows[0]] = comp_cols[0];
+                assigned++;
+                continue;
+            }
+            // Gated pairs inside a component cost the gate, which is the same
+            // as leaving their row unassigned, they are dropped below
+            sub_cost_.resize(comp_rows.size() * comp_cols.size());
+            float* dst = sub_cost_.data();
+            for (int r : comp_rows) {
+                const float* src = cost + r * cols;
+                for (int col : comp_cols) {
+                    *dst++ = std::min(src[col], gate);
+                }
+            }
+            sub_assignment_.resize(comp_rows.size());
+            solveDense(sub_cost_.data(), comp_rows.size(), comp_cols.size(),
+                       sub_assignment_.data());
+            for (size_t i = 0; i < comp_rows.size(); i++) {
+                if (sub_assignment_[i] == kUnassigned) {
+                    continue;
+                }
+                int r = comp_rows[i];
+                int col = comp_cols[sub_assignment_[i]];
+                if (cost[r * cols + col] < gate) {
+                    row_to_col[r] = col;
+                    assigned++;
+                }
+            }
+        }
+        return assigned;
+    }
+
+private:
+    /**
+     * @brief Solves a dense problem, transposing it if it has more rows than
+     *        columns
+     */
+    size_t solveDense(const float* cost, size_t rows, size_t cols, int* row_to_col) {
+        if (rows <= cols) {
+            augment(cost, rows, cols, row_to_col);
+            return rows;
+        }
+        transposed_.resize(rows * cols);
+        for (size_t r = 0; r < rows; r++) {
+            for (size_t c = 0; c < cols; c++) {
+                transposed_[c * rows + r] = cost[r * cols + c];
+            }
+        }
+        col_to_row_.resize(cols);
+        augment(transposed_.data(), cols, rows, col_to_row_.data());
+        std::fill(row_to_col, row_to_col + rows, kUnassigned);
+        for (size_t c = 0; c < cols; c++) {
+            row_to_col[col_to_row_[c]] = static_cast<int>(c);
+        }
+        return cols;
+    }
+
+    /**
+     * @brief Assigns the rows one by one along shortest augmenting paths in
+     *        the reduced costs, updating the dual variables after each.
+     *        Requires rows <= cols.
+     */
+    void augment(const float* cost, size_t rows, size_t cols, int* row_to_col) {
+        const float inf = std::numeric_limits<float>::infinity();
+        u_.assign(rows, 0.f);
+        v_.assign(cols, 0.f);
+        col_to_row_aug_.assign(cols, kUnassigned);
+        std::fill(row_to_col, row_to_col + rows, kUnassigned);
+        shortest_.resize(cols);
+        path_.resize(cols);
+        remaining_.resize(cols);
+        row_visited_.resize(rows);
+        col_visited_.resize(cols);
+
+        for (size_t cur_row = 0; cur_row < rows; cur_row++) {
+            std::fill(shortest_.begin(), shortest_.end(), inf);
+            std::fill(row_visited_.begin(), row_visited_.end(), 0);
+            std::fill(col_visited_.begin(), col_visited_.end(), 0);
+            // Columns not reached yet, the first num_remaining ones
+            size_t num_remaining = cols;
+            std::iota(remaining_.begin(), remaining_.end(), 0);
+
+            float min_val = 0.f;
+            int i = static_cast<int>(cur_row);
+            int sink = kUnassigned;
+            while (sink == kUnassigned) {
+                row_visited_[i] = 1;
+                const float* row = cost + i * cols;
+                const float base = min_val - u_[i];
+                float lowest = inf;
+                size_t index = 0;
+                for (size_t it = 0; it < num_remaining; it++) {
+                    int j = remaining_[it];
+                    float r = base + row[j] - v_[j];
+                    if (r < shortest_[j]) {
+                        path_[j] = i;
+                        shortest_[j] = r;
+                    }
+                    if (shortest_[j] < lowest ||
+                        (shortest_[j] == lowest && col_to_row_aug_[j] == kUnassigned)) {
+                        lowest = shortest_[j];
+                        index = it;
+                    }
+                }
+                min_val = lowest;
+                int j = remaining_[index];
+                if (col_to_row_aug_[j] == kUnassigned) {
+                    sink = j;
+                } else {
+                    i = col_to_row_aug_[j];
+                }
+                col_visited_[j] = 1;
+                remaining_[index] = remaining_[--num_remaining];
+            }
+
+            u_[cur_row] += min_val;
+            for (size_t r = 0; r < rows; r++) {
+                if (row_visited_[r] && r != cur_row) {
+                    u_[r] += min_val - shortest_[row_to_col[r]];
+                }
+            }
+            for (size_t c = 0; c < cols; c++) {
+                if (col_visited_[c]) {
+                    v_[c] -= min_val - shortest_[c];
+                }
+            }
+
+            int j = sink;
+            while (true) {
+                int r = path_[j];
+                col_to_row_aug_[j] = r;
+                std::swap(row_to_col[r], j);
+                if (r == static_cast<int>(cur_row)) {
+                    break;
+                }
+            }
+        }
+    }
+
+    /**
+     * @brief Groups rows and columns connected by pairs below the gate, rows
+     *        and columns without any such pair are left out
+     */
+    void findComponents(const float* cost, size_t rows, size_t cols, float gate) {
+        // Union-find over rows followed by columns
+        parent_.resize(rows + cols);
+        std::iota(parent_.begin(), parent_.end(), 0);
+        has_pair_.assign(rows + cols, 0);
+        for (size_t r = 0; r < rows; r++) {
+            const float* row = cost + r * cols;
+            for (size_t c = 0; c < cols; c++) {
+                if (row[c] < gate) {
+                    has_pair_[r] = has_pair_[rows + c] = 1;
+                    unite(static_cast<int>(r), static_cast<int>(rows + c));
+                }
+            }
+        }
+
+        component_of_root_.assign(rows + cols, -1);
+        component_rows_.clear();
+        component_cols_.clear();
+        for (size_t n = 0; n < rows + cols; n++) {
+            if (!has_pair_[n]) {
+                continue;
+            }
+            int root = find(static_cast<int>(n));
+            if (component_of_root_[root] < 0) {
+                component_of_root_[root] = static_cast<int>(component_rows_.size());
+                component_rows_.emplace_back();
+                component_cols_.emplace_back();
+            }
+            int component = component_of_root_[root];
+            if (n < rows) {
+                component_rows_[component].push_back(static_cast<int>(n));
+            } else {
+                component_cols_[component].push_back(static_cast<int>(n - rows));
+            }
+        }
+    }
+
+    int find(int n) {
+        while (parent_[n] != n) {
+            parent_[n] = parent_[parent_[n]];
+            n = parent_[n];
+        }
+        return n;
+    }
+
+    void unite(int a, int b) {
+        a = find(a);
+        b = find(b);
+        if (a != b) {
+            parent_[std::max(a, b)] = std::min(a, b);
+        }
+    }
+
+    std::vector<float> u_;
+    std::vector<float> v_;
+    std::vector<float> shortest_;
+    std::vector<int> path_;
+    std::vector<int> remaining_;
+    std::vector<int> col_to_row_aug_;
+    std::vector<char> row_visited_;
+    std::vector<char> col_visited_;
+
+    std::vector<float> transposed_;
+    std::vector<int> col_to_row_;
+
+    std::vector<int> parent_;
+    std::vector<char> has_pair_;
+    std::vector<int> component_of_root_;
+    std::vector<std::vector<int>> component_rows_;
+    std::vector<std::vector<int>> component_cols_;
+    std::vector<float> sub_cost_;
+    std::vector<int> sub_assignment_;
+};
+
+}  // namespace linear_assignment
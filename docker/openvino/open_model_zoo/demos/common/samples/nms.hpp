@@ -0,0 +1,451 @@
+/*
+// Copyright (c) 2018 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+*/
+
+/**
+ * @brief a header file with a non-maximum suppression of detected boxes, hard
+ *        or soft, for all classes at once or class by class
+ * @file nms.hpp
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <numeric>
+#include <vector>
+
+namespace nms {
+
+/**
+ * @brief How a box overlapping a kept one is handled
+ */
+enum class Method {
+    Hard,      // removed when its overlap passes the threshold
+    Linear,    // score decayed by 1 - IoU when its overlap passes the threshold
+    Gaussian,  // score decayed by exp(-IoU^2 / sigma)
+};
+
+/**
+ * @brief Parameters of a suppression
+ */
+struct Params {
+    /** @brief Overlap (intersection over union) threshold */
+    float iou_threshold = 0.5f;
+    /** @brief If true, an overlap equal to the threshold suppresses too */
+    bool inclusive = false;
+    /** @brief If true, boxes only suppress boxes of the same label */
+    bool class_aware = false;
+    /** @brief Number of most confident boxes considered, per label if
+     *         class_aware, -1 for all */
+    int top_k = -1;
+    /** @brief Number of boxes kept at most, -1 for all */
+    int keep_top_k = -1;
+    Method method = Method::Hard;
+    /** @brief Width of the Gaussian decay */
+    float sigma = 0.5f;
+    /** @brief Soft suppression drops boxes decayed to this score or lower */
+    float score_threshold = 0.f;
+};
+
+/**
+ * @class BoxSet
+ * @brief Boxes stored as one array per coordinate, so that a box is tested
+ *        against many others in tight loops
+ */
+class BoxSet {
+public:
+    void clear() {
+        x0.clear();
+        y0.clear();
+        x1.clear();
+        y1.clear();
+        area.clear();
+        score.clear();
+        label.clear();
+    }
+
+    void reserve(size_t n) {
+        x0.reserve(n);
+        y0.reserve(n);
+        x1.reserve(n);
+        y1.reserve(n);
+        area.reserve(n);
+        score.reserve(n);
+        label.reserve(n);
+    }
+
+    /**
+     * @brief Adds a box given by its corners, (x0, y0) being the top left one
+     */
+    void add(float left, float top, float right, float bottom, float box_score, int box_label = 0) {
+        x0.push_back(left);
+        y0.push_back(top);
+        x1.push_back(right);
+        y1.push_back(bottom);
+        area.push_back((right - left) * (bottom - top));
+        score.push_back(box_score);
+        label.push_back(box_label);
+    }
+
+    size_t size() const {
+        return score.size();
+    }
+
+    std::vector<float> x0;
+    std::vector<float> y0;
+    std::vector<float> x1;
+    std::vector<float> y1;
+    std::vector<float> area;
+    std::vector<float> score;
+    std::vector<int> label;
+};
+
+/**
+ * @class Suppressor
+ * @brief Keeps the most confident boxes of groups of overlapping ones.
+ *
+ * Hard suppression visits the boxes by decreasing score and keeps a box when
+ * no kept box overlaps it, stopping at the first one that does. Above
+ * grid_threshold boxes in a group, the kept boxes are also bucketed in a
+ * uniform grid, so that a box is only tested against the kept boxes sharing
+ * one of its cells. Soft suppression decays the scores of the boxes
+ * overlapping each kept box instead. The suppressor keeps its buffers between
+ * calls, so an instance should be reused.
+ */
+class Suppressor {
+public:
+    /**
+     * @param grid_threshold - number of boxes of a group from which the grid
+     *        is used by hard suppression
+     */
+    explicit Suppressor(size_t grid_threshold = 256) : grid_threshold_(grid_threshold) {}
+
+    /**
+     * @brief Suppresses the boxes overlapping more confident ones
+     * @param keep - output, indices of the kept boxes, by decreasing score
+     *        within each label if class_aware and overall otherwise. Boxes of
+     *        equal scores keep their order.
+     * @return Number of kept boxes
+     */
+    size_t run(const BoxSet& boxes, const Params& params, std::vector<int>& keep) {
+        keep.clear();
+        const size_t n = boxes.size();
+        scores_.assign(boxes.score.begin(), boxes.score.end());
+        if (n == 0) {
+            return 0;
+        }
+        sortCandidates(boxes, params);
+
+        size_t begin = 0;
+        while (begin < n) {
+            size_t end = begin + 1;
+            if (params.class_aware) {
+                const int label = boxes.label[order_[begin]];
+                while (end < n && boxes.label[order_[end]] == label) {
+                    end++;
+                }
+            } else {
+                end = n;
+            }
+            size_t count = end - begin;
+            if (params.top_k > -1 && static_cast<size_t>(params.top_k) < count) {
+                count = params.top_k;
+            }
+            if (params.method != Method::Hard) {
+                suppressSoft(boxes, params, begin, count, keep);
+            } else if (count >= grid_threshold_) {
+                suppressGrid(boxes, params, begin, count, keep);
+            } else {
+                suppressHard(boxes, params, begin, count, keep);
+            }
+            begin = end;
+        }
+
+        if (params.keep_top_k > -1 && keep.size() > static_cast<size_t>(params.keep_top_k)) {
+            if (params.class_aware || params.method != Method::Hard) {
+                std::stable_sort(keep.begin(), keep.end(), [this](int a, int b) {
+                    return scores_[a] > scores_[b];
+                });
+            }
+            keep.resize(params.keep_top_k);
+        }
+        return keep.size();
+    }
+
+    /**
+     * @brief Scores of the boxes after the last run, decayed by soft
+     *        suppression
+     */
+    const std::vector<float>& scores() const {
+        return scores_;
+    }
+
+private:
+    /**
+     * @brief Orders the boxes by decreasing score, within each label if
+     *        class_aware
+     */
+    void sortCandidates(const BoxSet& boxes, const Params& params) {
+        order_.resize(boxes.size());
+        std::iota(order_.begin(), order_.end(), 0);
+        const std::vector<float>& score = boxes.score;
+        if (params.class_aware) {
+            const std::vector<int>& label = boxes.label;
+            std::stable_sort(order_.begin(), order_.end(), [&](int a, int b) {
+                return label[a] < label[b] || (label[a] == label[b] && score[a] > score[b]);
+            });
+        } else {
+            std::stable_sort(order_.begin(), order_.end(), [&](int a, int b) {
+                return score[a] > score[b];
+            });
+        }
+    }
+
+    bool suppresses(float intersection, float union_area, const Params& params) const {
+        const float limit = params.iou_threshold * union_area;
+        return intersection > 0.f && (intersection > limit || (params.inclusive && intersection == limit));
+    }
+
+    /**
+     * @brief Hard suppression testing each box against every kept box of its
+     *        group, copied next to each other
+     */
+    void suppressHard(const BoxSet& boxes, const Params& params,
+                      size_t begin, size_t count, std::vector<int>& keep) {
+        clearKept();
+        for (size_t i = begin; i < begin + count; i++) {
+            if (params.keep_top_k > -1 && !params.class_aware
+                    && keep.size() >= static_cast<size_t>(params.keep_top_k)) {
+                return;
+            }
+            const int idx = order_[i];
+            const float x0 = boxes.x0[idx];
+            const float y0 = boxes.y0[idx];
+            const float x1 = boxes.x1[idx];
+            const float y1 = boxes.y1[idx];
+            const float area = boxes.area[idx];
+            bool keep_idx = true;
+            for (size_t k = 0; k < kept_x0_.size(); k++) {
+                const float w = std::min(x1, kept_x1_[k]) - std::max(x0, kept_x0_[k]);
+                const float h = std::min(y1, kept_y1_[k]) - std::max(y0, kept_y0_[k]);
+                if (w <= 0.f || h <= 0.f) {
+                    continue;
+                }
+                const float intersection = w * h;
+                if (suppresses(intersection, area + kept_area_[k] - intersection, params)) {
+                    keep_idx = false;
+                    break;
+                }
+            }
+            if (keep_idx) {
+                keep.push_back(idx);
+                addKept(x0, y0, x1, y1, area);
+            }
+        }
+    }
+
+    /**
+     * @brief Hard suppression with the kept boxes bucketed in a grid sized
+     *        after the average box of the group
+     */
+    void suppressGrid(const BoxSet& boxes, const Params& params,
+                      size_t begin, size_t count, std::vector<int>& keep) {
+        float min_x = boxes.x0[order_[begin]];
+        float min_y = boxes.y0[order_[begin]];
+        float max_x = boxes.x1[order_[begin]];
+        float max_y = boxes.y1[order_[begin]];
+        float sum_w = 0.f;
+        float sum_h = 0.f;
+        for (size_t i = begin; i < begin + count; i++) {
+            const int idx = order_[i];
+            min_x = std::min(min_x, boxes.x0[idx]);
+            min_y = std::min(min_y, boxes.y0[idx]);
+            max_x = std::max(max_x, boxes.x1[idx]);
+            max_y = std::max(max_y, boxes.y1[idx]);
+            sum_w += boxes.x1[idx] - boxes.x0[idx];
+            sum_h += boxes.y1[idx] - boxes.y0[idx];
+        }
+        // Cells of the average box size, at most about one cell per box
+        const float mean_w = std::max(sum_w / count, 1e-6f);
+        const float mean_h = std::max(sum_h / count, 1e-6f);
+        const int max_cells = static_cast<int>(std::sqrt(static_cast<float>(count))) + 1;
+        grid_cols_ = std::max(1, std::min(max_cells, static_cast<int>((max_x - min_x) / mean_w)));
+        grid_rows_ = std::max(1, std::min(max_cells, static_cast<int>((max_y - min_y) / mean_h)));
+        grid_x_ = min_x;
+        grid_y_ = min_y;
+        cell_w_ = std::max((max_x - min_x) / grid_cols_, 1e-6f);
+        cell_h_ = std::max((max_y - min_y) / grid_rows_, 1e-6f);
+        cells_.resize(grid_cols_ * grid_rows_);
+        for (auto& cell : cells_) {
+            cell.clear();
+        }
+
+        clearKept();
+        visited_.clear();
+        for (size_t i = begin; i < begin + count; i++) {
+            if (params.keep_top_k > -1 && !params.class_aware
+                    && keep.size() >= static_cast<size_t>(params.keep_top_k)) {
+                return;
+            }
+            const int idx = order_[i];
+            const float x0 = boxes.x0[idx];
+            const float y0 = boxes.y0[idx];
+            const float x1 = boxes.x1[idx];
+            const float y1 = boxes.y1[idx];
+            const float area = boxes.area[idx];
+            int col0, row0, col1, row1;
+            cellRange(x0, y0, x1, y1, col0, row0, col1, row1);
+
+            // A kept box spanning several cells is only tested once per box
+            const int stamp = static_cast<int>(i - begin) + 1;
+            bool keep_idx = true;
+            for (int row = row0; row <= row1 && keep_idx; row++) {
+                for (int col = col0; col <= col1 && keep_idx; col++) {
+                    for (int k : cells_[row * grid_cols_ + col]) {
+                        if (visited_[k] == stamp) {
+                            continue;
+                        }
+                        visited_[k] = stamp;
+                        const float w = std::min(x1, kept_x1_[k]) - std::max(x0, kept_x0_[k]);
+                        const float h = std::min(y1, kept_y1_[k]) - std::max(y0, kept_y0_[k]);
+                        if (w <= 0.f || h <= 0.f) {
+                            continue;
+                        }
+                        const float intersection = w * h;
+                        if (suppresses(intersection, area + kept_area_[k] - intersection, params)) {
+                            keep_idx = false;
+                            break;
+                        }
+                    }
+                }
+            }
+            if (keep_idx) {
+                const int k = static_cast<int>(kept_x0_.size());
+                keep.push_back(idx);
+                addKept(x0, y0, x1, y1, area);
+                visited_.push_back(0);
+                for (int row = row0; row <= row1; row++) {
+                    for (int col = col0; col <= col1; col++) {
+                        cells_[row * grid_cols_ + col].push_back(k);
+                    }
+                }
+            }
+        }
+    }
+
+    /**
+     * @brief Soft suppression, keeping the box of highest decayed score and
+     *        decaying the remaining ones until none is left above the score
+     *        threshold
+     */
+    void suppressSoft(const BoxSet& boxes, const Params& params,
+                      size_t begin, size_t count, std::vector<int>& keep) {
+        remaining_.assign(order_.begin() + begin, order_.begin() + begin + count);
+        while (!remaining_.empty()) {
+            if (params.keep_top_k > -1 && !params.class_aware
+                    && keep.size() >= static_cast<size_t>(params.keep_top_k)) {
+                return;
+            }
+            // The first of equal scores, so that ties keep their order
+            size_t best = 0;
+            for (size_t r = 1; r < remaining_.size(); r++) {
+                if (scores_[remaining_[r]] > scores_[remaining_[best]]) {
+                    best = r;
+                }
+            }
+            const int idx = remaining_[best];
+            if (scores_[idx] <= params.score_threshold) {
+                break;
+            }
+            keep.push_back(idx);
+            remaining_.erase(remaining_.begin() + best);
+
+            const float x0 = boxes.x0[idx];
+            const float y0 = boxes.y0[idx];
+            const float x1 = boxes.x1[idx];
+            const float y1 = boxes.y1[idx];
+            const float area = boxes.area[idx];
+            size_t out = 0;
+            for (size_t r = 0; r < remaining_.size(); r++) {
+                const int other = remaining_[r];
+                const float w = std::min(x1, boxes.x1[other]) - std::max(x0, boxes.x0[other]);
+                const float h = std::min(y1, boxes.y1[other]) - std::max(y0, boxes.y0[other]);
+                if (w > 0.f && h > 0.f) {
+                    const float intersection = w * h;
+                    const float union_area = area + boxes.area[other] - intersection;
+                    const float iou = union_area > 0.f ? intersection / union_area : 0.f;
+                    if (params.method == Method::Gaussian) {
+                        scores_[other] *= std::exp(-iou * iou / params.sigma);
+                    } else if (suppresses(intersection, union_area, params)) {
+                        scores_[other] *= 1.f - iou;
+                    }
+                }
+                if (scores_[other] > params.score_threshold) {
+                    remaining_[out++] = other;
+                }
+            }
+            remaining_.resize(out);
+        }
+    }
+
+    void cellRange(float x0, float y0, float x1, float y1,
+                   int& col0, int& row0, int& col1, int& row1) const {
+        col0 = std::max(0, std::min(grid_cols_ - 1, static_cast<int>((x0 - grid_x_) / cell_w_)));
+        row0 = std::max(0, std::min(grid_rows_ - 1, static_cast<int>((y0 - grid_y_) / cell_h_)));
+        col1 = std::max(0, std::min(grid_cols_ - 1, static_cast<int>((x1 - grid_x_) / cell_w_)));
+        row1 = std::max(0, std::min(grid_rows_ - 1, static_cast<int>((y1 - grid_y_) / cell_h_)));
+    }
+
+    void clearKept() {
+        kept_x0_.clear();
+        kept_y0_.clear();
+        kept_x1_.clear();
+        kept_y1_.clear();
+        kept_area_.clear();
+    }
+
+    void addKept(float x0, float y0, float x1, float y1, float area) {
+        kept_x0_.push_back(x0);
+        kept_y0_.push_back(y0);
+        kept_x1_.push_back(x1);
+        kept_y1_.push_back(y1);
+        kept_area_.push_back(area);
+    }
+
+    size_t grid_threshold_;
+
+    std::vector<int> order_;
+    std::vector<float> scores_;
+    std::vector<int> remaining_;
+
+    std::vector<float> kept_x0_;
+    std::vector<float> kept_y0_;
+    std::vector<float> kept_x1_;
+    std::vector<float> kept_y1_;
+    std::vector<float> kept_area_;
+
+    int grid_cols_ = 1;
+    int grid_rows_ = 1;
+    float grid_x_ = 0.f;
+    float grid_y_ = 0.f;
+    float cell_w_ = 1.f;
+    float cell_h_ = 1.f;
+    std::vector<std::vector<int>> cells_;
+    std::vector<int> visited_;
+};
+
+}  // namespace nms
@@ -16,6 +16,8 @@
 
 #pragma once
 
+#include <deque>
+#include <map>
 #include <string>
 #include <vector>
 
@@ -23,6 +25,7 @@
 #include <opencv2/core/core.hpp>
 
 #include "human_pose.hpp"
+#include "peak.hpp"
 
 namespace human_pose_estimation {
 class HumanPoseEstimator {
@@ -33,26 +36,45 @@ public:
                        const std::string& targetDeviceName,
                        bool enablePerformanceReport = false);
     std::vector<HumanPose> estimate(const cv::Mat& image);
+    // Starts inference on the image and returns without waiting for it. The
+    // image is copied into the network input before returning.
+    void estimateAsync(const cv::Mat& image);
+    // Waits for the oldest image passed to estimateAsync and returns its poses
+    std::vector<HumanPose> getPoses();
+    size_t pendingImagesNumber() const;
     ~HumanPoseEstimator();
 
 private:
-    void preprocess(const cv::Mat& image, float* buffer) const;
+    // Network loaded for one input width, with its idle infer requests
+    struct LoadedNetwork {
+        InferenceEngine::ExecutableNetwork executableNetwork;
+        std::vector<InferenceEngine::InferRequest> idleRequests;
+    };
+    // Image being inferred, with the layout of the input it was fed with
+    struct PendingImage {
+        InferenceEngine::InferRequest request;
+        int inputWidth;
+        cv::Size imageSize;
+        cv::Vec4i pad;
+    };
+
+    void preprocess(const cv::Mat& image, const cv::Size& inputSize,
+                    const cv::Vec4i& pad, float* buffer) const;
     std::vector<HumanPose> postprocess(
             const float* heatMapsData, const int heatMapOffset, const int nHeatMaps,
             const float* pafsData, const int pafOffset, const int nPafs,
             const int featureMapWidth, const int featureMapHeight,
-            const cv::Size& imageSize) const;
-    std::vector<HumanPose> extractPoses(const std::vector<cv::Mat>& heatMaps,
-                                        const std::vector<cv::Mat>& pafs) const;
-    void resizeFeatureMaps(std::vector<cv::Mat>& featureMaps) const;
+            const cv::Size& imageSize, const cv::Vec4i& pad);
+    std::vector<HumanPose> extractPoses();
     void correctCoordinates(std::vector<HumanPose>& poses,
                             const cv::Size& featureMapsSize,
-                            const cv::Size& imageSize) const;
-    bool inputWidthIsChanged(const cv::Size& imageSize);
+                            const cv::Size& imageSize,
+                            const cv::Vec4i& pad) const;
+    int computeInputLayout(const cv::Size& imageSize, cv::Vec4i& pad) const;
+    LoadedNetwork& getNetwork(int inputWidth);
 
     int minJointsNumber;
     int stride;
-    cv::Vec4i pad;
     cv::Vec3f meanPixel;
     float minPeaksDistance;
     float midPointsScoreThreshold;
@@ -60,11 +82,21 @@ private:
     float minSubsetScore;
     cv::Size inputLayerSize;
     int upsampleRatio;
+    FeatureMapUpsampler upsampler;
+    // Buffers of the post-processing, kept between frames
+    std::vector<cv::Mat> heatMaps;
+    std::vector<cv::Mat> pafs;
+    std::vector<std::vector<Peak> > peaksFromHeatMap;
+    std::vector<PeaksSearchBuffers> peaksSearchBuffers;
     InferenceEngine::InferencePlugin plugin;
     InferenceEngine::CNNNetwork network;
-    InferenceEngine::ExecutableNetwork executableNetwork;
-    InferenceEngine::InferRequest request;
+    // Networks loaded so far by input width, reshaping to a width seen
+    // before does not load the network again
+    std::map<int, LoadedNetwork> loadedNetworks;
+    std::deque<PendingImage> pendingImages;
+    InferenceEngine::InferRequest request;  // Completed last
     InferenceEngine::CNNNetReader netReader;
+    std::string inputBlobName;
     std::string pafsBlobName;
     std::string heatmapsBlobName;
     bool enablePerformanceReport;
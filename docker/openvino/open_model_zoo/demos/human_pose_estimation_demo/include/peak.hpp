@@ -51,14 +51,55 @@ struct TwoJointsConnection {
     float score;
 };
 
+// Samples a feature map as if it was upsampled by cv::resize with
+// INTER_CUBIC and an integer ratio, without computing the whole upsampled map
+class FeatureMapUpsampler {
+public:
+    explicit FeatureMapUpsampler(const int upsampleRatio);
+
+    int ratio() const;
+    // Value of the upsampled map at (x, y) of the upsampled map
+    float at(const cv::Mat& featureMap, const int x, const int y) const;
+    // Values of the upsampled map in a window of it, interpolating rows first.
+    // The window may exceed the upsampled map, pixels outside of it are 0.
+    // The values are written to the top left corner of upsampled, which like
+    // upsampledRows is only reallocated when it is smaller than needed.
+    void upsample(const cv::Mat& featureMap, const cv::Rect& window,
+                  cv::Mat& upsampled, cv::Mat& upsampledRows) const;
+
+private:
+    int upsampleRatio;
+    // Offset of the first of the 4 source pixels and their coefficients, for
+    // each of the upsampleRatio positions of a pixel between source pixels
+    std::vector<int> offsets;
+    std::vector<cv::Vec4f> coefficients;
+};
+
+// Buffers of findPeaks for one heat map, kept between frames
+struct PeaksSearchBuffers {
+    cv::Mat borderedHeatMap;
+    cv::Mat searchArea;
+    cv::Mat window;
+    cv::Mat windowRows;
+    std::vector<cv::Point> candidates;
+    std::vector<cv::Point> peaks;
+};
+
+// Finds the peaks of the upsampled heat map. Candidates are searched on the
+// heat map itself, and the upsampled map is only computed around them.
 void findPeaks(const std::vector<cv::Mat>& heatMaps,
+               const FeatureMapUpsampler& upsampler,
                const float minPeaksDistance,
                std::vector<std::vector<Peak> >& allPeaks,
-               int heatMapId);
+               int heatMapId,
+               PeaksSearchBuffers& buffers);
 
+// Peaks are in coordinates of the upsampled maps, pafs are not upsampled and
+// are only sampled along the candidate limbs
 std::vector<HumanPose> groupPeaksToPoses(
         const std::vector<std::vector<Peak> >& allPeaks,
         const std::vector<cv::Mat>& pafs,
+        const FeatureMapUpsampler& upsampler,
         const size_t keypointsNumber,
         const float midPointsScoreThreshold,
         const float foundMidPointsRatioThreshold,
@@ -73,10 +73,19 @@ int main(int argc, char* argv[]) {
 
         int delay = 33;
         double inferenceTime = 0.0;
-        cv::Mat image;
-        while (cap.read(image)) {
+        cv::Mat image, nextImage;
+        if (!cap.read(image)) {
+            throw std::logic_error("Failed to get frame from cv::VideoCapture");
+        }
+        estimator.estimateAsync(image);
+        while (estimator.pendingImagesNumber() > 0) {
             double t1 = cv::getTickCount();
-            std::vector<HumanPose> poses = estimator.estimate(image);
+            // The next frame is submitted before the poses of the current one
+            // are extracted, so that the network infers it meanwhile
+            if (cap.read(nextImage)) {
+                estimator.estimateAsync(nextImage);
+            }
+            std::vector<HumanPose> poses = estimator.getPoses();
             double t2 = cv::getTickCount();
             if (inferenceTime == 0) {
                 inferenceTime = (t2 - t1) / cv::getTickFrequency() * 1000;
@@ -95,28 +104,29 @@ int main(int argc, char* argv[]) {
                 }
             }
 
-            if (FLAGS_no_show) {
-                continue;
-            }
-
-            renderHumanPose(poses, image);
-
-            cv::Mat fpsPane(35, 155, CV_8UC3);
-            fpsPane.setTo(cv::Scalar(153, 119, 76));
-            cv::Mat srcRegion = image(cv::Rect(8, 8, fpsPane.cols, fpsPane.rows));
-            cv::addWeighted(srcRegion, 0.4, fpsPane, 0.6, 0, srcRegion);
-            std::stringstream fpsSs;
-            fpsSs << "FPS: " << int(1000.0f / inferenceTime * 100) / 100.0f;
-            cv::putText(image, fpsSs.str(), cv::Point(16, 32),
-                        cv::FONT_HERSHEY_COMPLEX, 0.8, cv::Scalar(0, 0, 255));
-            cv::imshow("ICV Human Pose Estimation", image);
-
-            int key = cv::waitKey(delay) & 255;
-            if (key == 'p') {
-                delay = (delay == 0) ? 33 : 0;
-            } else if (key == 27) {
-                break;
+            if (!FLAGS_no_show) {
+                renderHumanPose(poses, image);
+
+                cv::Mat fpsPane(35, 155, CV_8UC3);
+                fpsPane.setTo(cv::Scalar(153, 119, 76));
+                cv::Mat srcRegion = image(cv::Rect(8, 8, fpsPane.cols, fpsPane.rows));
+                cv::addWeighted(srcRegion, 0.4, fpsPane, 0.6, 0, srcRegion);
+                std::stringstream fpsSs;
+                fpsSs << "FPS: " << int(1000.0f / inferenceTime * 100) / 100.0f;
+                cv::putText(image, fpsSs.str(), cv::Point(16, 32),
+                            cv::FONT_HERSHEY_COMPLEX, 0.8, cv::Scalar(0, 0, 255));
+                cv::imshow("ICV Human Pose Estimation", image);
+
+                int key = cv::waitKey(delay) & 255;
+                if (key == 'p') {
+                    delay = (delay == 0) ? 33 : 0;
+                } else if (key == 27) {
+                    break;
+                }
             }
+            // The frame read last becomes the current one, its buffer is
+            // reused for the next read as it is already in the network input
+            cv::swap(image, nextImage);
         }
     }
     catch (const std::exception& error) {
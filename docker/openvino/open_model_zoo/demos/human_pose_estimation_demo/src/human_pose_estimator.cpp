@@ -33,7 +33,6 @@ HumanPoseEstimator::HumanPoseEstimator(const std::string& modelPath,
                                        bool enablePerformanceReport)
     : minJointsNumber(3),
       stride(8),
-      pad(cv::Vec4i::all(0)),
       meanPixel(cv::Vec3f::all(128)),
       minPeaksDistance(3.0f),
       midPointsScoreThreshold(0.05f),
@@ -41,6 +40,7 @@ HumanPoseEstimator::HumanPoseEstimator(const std::string& modelPath,
       minSubsetScore(0.2f),
       inputLayerSize(-1, -1),
       upsampleRatio(4),
+      upsampler(upsampleRatio),
       enablePerformanceReport(enablePerformanceReport),
       modelPath(modelPath) {
     plugin = InferenceEngine::PluginDispatcher({"../../../lib/intel64", ""})
@@ -54,6 +54,7 @@ HumanPoseEstimator::HumanPoseEstimator(const std::string& modelPath,
     netReader.ReadWeights(binFileName);
     network = netReader.getNetwork();
     InferenceEngine::InputInfo::Ptr inputInfo = network.getInputsInfo().begin()->second;
+    inputBlobName = network.getInputsInfo().begin()->first;
     inputLayerSize = cv::Size(inputInfo->getTensorDesc().getDims()[3], inputInfo->getTensorDesc().getDims()[2]);
 
     InferenceEngine::OutputsDataMap outputInfo = network.getOutputsInfo();
@@ -61,31 +62,47 @@ HumanPoseEstimator::HumanPoseEstimator(const std::string& modelPath,
     pafsBlobName = outputBlobsIt->first;
     heatmapsBlobName = (++outputBlobsIt)->first;
 
-    executableNetwork = plugin.LoadNetwork(network, {});
-    request = executableNetwork.CreateInferRequest();
+    LoadedNetwork& loadedNetwork = loadedNetworks[inputLayerSize.width];
+    loadedNetwork.executableNetwork = plugin.LoadNetwork(network, {});
+    request = loadedNetwork.executableNetwork.CreateInferRequest();
+    loadedNetwork.idleRequests.push_back(request);
 }
 
 std::vector<HumanPose> HumanPoseEstimator::estimate(const cv::Mat& image) {
+    CV_Assert(pendingImages.empty());
+    estimateAsync(image);
+    return getPoses();
+}
+
+void HumanPoseEstimator::estimateAsync(const cv::Mat& image) {
     CV_Assert(image.type() == CV_8UC3);
 
-    cv::Size imageSize = image.size();
-    if (inputWidthIsChanged(imageSize)) {
-        auto input_shapes = network.getInputShapes();
-        std::string input_name;
-        InferenceEngine::SizeVector input_shape;
-        std::tie(input_name, input_shape) = *input_shapes.begin();
-        input_shape[2] = inputLayerSize.height;
-        input_shape[3] = inputLayerSize.width;
-        input_shapes[input_name] = input_shape;
-        network.reshape(input_shapes);
-        executableNetwork = plugin.LoadNetwork(network, {});
-        request = executableNetwork.CreateInferRequest();
+    PendingImage pendingImage;
+    pendingImage.imageSize = image.size();
+    pendingImage.inputWidth = computeInputLayout(pendingImage.imageSize, pendingImage.pad);
+    LoadedNetwork& loadedNetwork = getNetwork(pendingImage.inputWidth);
+    if (loadedNetwork.idleRequests.empty()) {
+        pendingImage.request = loadedNetwork.executableNetwork.CreateInferRequest();
+    } else {
+        pendingImage.request = loadedNetwork.idleRequests.back();
+        loadedNetwork.idleRequests.pop_back();
     }
-    InferenceEngine::Blob::Ptr input = request.GetBlob(network.getInputsInfo().begin()->first);
+
+    InferenceEngine::Blob::Ptr input = pendingImage.request.GetBlob(inputBlobName);
     auto buffer = input->buffer().as<InferenceEngine::PrecisionTrait<InferenceEngine::Precision::FP32>::value_type *>();
-    preprocess(image, static_cast<float*>(buffer));
+    preprocess(image, cv::Size(pendingImage.inputWidth, inputLayerSize.height),
+               pendingImage.pad, static_cast<float*>(buffer));
+
+    pendingImage.request.StartAsync();
+    pendingImages.push_back(pendingImage);
+}
 
-    request.Infer();
+std::vector<HumanPose> HumanPoseEstimator::getPoses() {
+    CV_Assert(!pendingImages.empty());
+    PendingImage pendingImage = pendingImages.front();
+    pendingImages.pop_front();
+    pendingImage.request.Wait(InferenceEngine::IInferRequest::WaitMode::RESULT_READY);
+    request = pendingImage.request;
 
     InferenceEngine::Blob::Ptr pafsBlob = request.GetBlob(pafsBlobName);
     InferenceEngine::Blob::Ptr heatMapsBlob = request.GetBlob(heatmapsBlobName);
@@ -99,14 +116,39 @@ std::vector<HumanPose> HumanPoseEstimator::estimate(const cv::Mat& image) {
             pafsBlob->buffer(),
             heatMapDims[2] * heatMapDims[3],
             pafsBlob->getTensorDesc().getDims()[1],
-            heatMapDims[3], heatMapDims[2], imageSize);
+            heatMapDims[3], heatMapDims[2], pendingImage.imageSize,
+            pendingImage.pad);
 
+    loadedNetworks[pendingImage.inputWidth].idleRequests.push_back(request);
     return poses;
 }
 
-void HumanPoseEstimator::preprocess(const cv::Mat& image, float* buffer) const {
+size_t HumanPoseEstimator::pendingImagesNumber() const {
+    return pendingImages.size();
+}
+
+HumanPoseEstimator::LoadedNetwork& HumanPoseEstimator::getNetwork(int inputWidth) {
+    auto loadedNetworkIt = loadedNetworks.find(inputWidth);
+    if (loadedNetworkIt != loadedNetworks.end()) {
+        return loadedNetworkIt->second;
+    }
+    auto input_shapes = network.getInputShapes();
+    std::string input_name;
+    InferenceEngine::SizeVector input_shape;
+    std::tie(input_name, input_shape) = *input_shapes.begin();
+    input_shape[2] = inputLayerSize.height;
+    input_shape[3] = inputWidth;
+    input_shapes[input_name] = input_shape;
+    network.reshape(input_shapes);
+    LoadedNetwork& loadedNetwork = loadedNetworks[inputWidth];
+    loadedNetwork.executableNetwork = plugin.LoadNetwork(network, {});
+    return loadedNetwork;
+}
+
+void HumanPoseEstimator::preprocess(const cv::Mat& image, const cv::Size& inputSize,
+                                    const cv::Vec4i& pad, float* buffer) const {
     cv::Mat resizedImage;
-    double scale = inputLayerSize.height / static_cast<double>(image.rows);
+    double scale = inputSize.height / static_cast<double>(image.rows);
     cv::resize(image, resizedImage, cv::Size(), scale, scale, cv::INTER_CUBIC);
     cv::Mat paddedImage;
     cv::copyMakeBorder(resizedImage, paddedImage, pad(0), pad(2), pad(1), pad(3),
@@ -114,9 +156,9 @@ void HumanPoseEstimator::preprocess(const cv::Mat& image, float* buffer) const {
     std::vector<cv::Mat> planes(3);
     cv::split(paddedImage, planes);
     for (size_t pId = 0; pId < planes.size(); pId++) {
-        cv::Mat dst(inputLayerSize.height, inputLayerSize.width, CV_32FC1,
+        cv::Mat dst(inputSize.height, inputSize.width, CV_32FC1,
                     reinterpret_cast<void*>(
-                        buffer + pId * inputLayerSize.area()));
+                        buffer + pId * inputSize.area()));
         planes[pId].convertTo(dst, CV_32FC1);
     }
 }
@@ -125,80 +167,85 @@ std::vector<HumanPose> HumanPoseEstimator::postprocess(
         const float* heatMapsData, const int heatMapOffset, const int nHeatMaps,
         const float* pafsData, const int pafOffset, const int nPafs,
         const int featureMapWidth, const int featureMapHeight,
-        const cv::Size& imageSize) const {
-    std::vector<cv::Mat> heatMaps(nHeatMaps);
+        const cv::Size& imageSize, const cv::Vec4i& pad) {
+    // The feature maps are used at the network output resolution, upsampled
+    // values are only computed where peaks and limbs are looked for
+    heatMaps.resize(nHeatMaps);
     for (size_t i = 0; i < heatMaps.size(); i++) {
         heatMaps[i] = cv::Mat(featureMapHeight, featureMapWidth, CV_32FC1,
                               reinterpret_cast<void*>(
                                   const_cast<float*>(
                                       heatMapsData + i * heatMapOffset)));
     }
-    resizeFeatureMaps(heatMaps);
 
-    std::vector<cv::Mat> pafs(nPafs);
+    pafs.resize(nPafs);
     for (size_t i = 0; i < pafs.size(); i++) {
         pafs[i] = cv::Mat(featureMapHeight, featureMapWidth, CV_32FC1,
                           reinterpret_cast<void*>(
                               const_cast<float*>(
                                   pafsData + i * pafOffset)));
     }
-    resizeFeatureMaps(pafs);
 
-    std::vector<HumanPose> poses = extractPoses(heatMaps, pafs);
-    correctCoordinates(poses, heatMaps[0].size(), imageSize);
+    std::vector<HumanPose> poses = extractPoses();
+    correctCoordinates(poses, heatMaps[0].size() * upsampleRatio, imageSize, pad);
     return poses;
 }
 
 class FindPeaksBody: public cv::ParallelLoopBody {
 public:
-    FindPeaksBody(const std::vector<cv::Mat>& heatMaps, float minPeaksDistance,
-                  std::vector<std::vector<Peak> >& peaksFromHeatMap)
+    FindPeaksBody(const std::vector<cv::Mat>& heatMaps,
+                  const FeatureMapUpsampler& upsampler, float minPeaksDistance,
+                  std::vector<std::vector<Peak> >& peaksFromHeatMap,
+                  std::vector<PeaksSearchBuffers>& peaksSearchBuffers)
         : heatMaps(heatMaps),
+          upsampler(upsampler),
           minPeaksDistance(minPeaksDistance),
-          peaksFromHeatMap(peaksFromHeatMap) {}
+          peaksFromHeatMap(peaksFromHeatMap),
+          peaksSearchBuffers(peaksSearchBuffers) {}
 
     virtual void operator()(const cv::Range& range) const {
         for (int i = range.start; i < range.end; i++) {
-            findPeaks(heatMaps, minPeaksDistance, peaksFromHeatMap, i);
+            findPeaks(heatMaps, upsampler, minPeaksDistance, peaksFromHeatMap, i,
+                      peaksSearchBuffers[i]);
         }
     }
 
 private:
     const std::vector<cv::Mat>& heatMaps;
+    const FeatureMapUpsampler& upsampler;
     float minPeaksDistance;
     std::vector<std::vector<Peak> >& peaksFromHeatMap;
+    std::vector<PeaksSearchBuffers>& peaksSearchBuffers;
 };
 
-std::vector<HumanPose> HumanPoseEstimator::extractPoses(
-        const std::vector<cv::Mat>& heatMaps,
-        const std::vector<cv::Mat>& pafs) const {
-    std::vector<std::vector<Peak> > peaksFromHeatMap(heatMaps.size());
-    FindPeaksBody findPeaksBody(heatMaps, minPeaksDistance, peaksFromHeatMap);
-    cv::parallel_for_(cv::Range(0, static_cast<int>(heatMaps.size())),
+std::vector<HumanPose> HumanPoseEstimator::extractPoses() {
+    // The last heat map is the background one, its peaks are not used
+    peaksFromHeatMap.resize(keypointsNumber);
+    peaksSearchBuffers.resize(keypointsNumber);
+    for (auto& peaks : peaksFromHeatMap) {
+        peaks.clear();
+    }
+    FindPeaksBody findPeaksBody(heatMaps, upsampler, minPeaksDistance,
+                                peaksFromHeatMap, peaksSearchBuffers);
+    cv::parallel_for_(cv::Range(0, static_cast<int>(keypointsNumber)),
                       findPeaksBody);
     int peaksBefore = 0;
-    for (size_t heatmapId = 1; heatmapId < heatMaps.size(); heatmapId++) {
+    for (size_t heatmapId = 1; heatmapId < keypointsNumber; heatmapId++) {
         peaksBefore += static_cast<int>(peaksFromHeatMap[heatmapId - 1].size());
         for (auto& peak : peaksFromHeatMap[heatmapId]) {
             peak.id += peaksBefore;
         }
     }
     std::vector<HumanPose> poses = groupPeaksToPoses(
-                peaksFromHeatMap, pafs, keypointsNumber, midPointsScoreThreshold,
+                peaksFromHeatMap, pafs, upsampler, keypointsNumber, midPointsScoreThreshold,
                 foundMidPointsRatioThreshold, minJointsNumber, minSubsetScore);
     return poses;
 }
 
-void HumanPoseEstimator::resizeFeatureMaps(std::vector<cv::Mat>& featureMaps) const {
-    for (auto& featureMap : featureMaps) {
-        cv::resize(featureMap, featureMap, cv::Size(),
-                   upsampleRatio, upsampleRatio, cv::INTER_CUBIC);
-    }
-}
-
 void HumanPoseEstimator::correctCoordinates(std::vector<HumanPose>& poses,
                                             const cv::Size& featureMapsSize,
-                                            const cv::Size& imageSize) const {
+                                            const cv::Size& imageSize,
+                                            const cv::Vec4i& pad) const {
     CV_Assert(stride % upsampleRatio == 0);
 
     cv::Size fullFeatureMapSize = featureMapsSize * stride / upsampleRatio;
@@ -222,7 +269,8 @@ void HumanPoseEstimator::correctCoordinates(std::vector<HumanPose>& poses,
     }
 }
 
-bool HumanPoseEstimator::inputWidthIsChanged(const cv::Size& imageSize) {
+int HumanPoseEstimator::computeInputLayout(const cv::Size& imageSize,
+                                           cv::Vec4i& pad) const {
     double scale = inputLayerSize.height / static_cast<double>(imageSize.height);
     cv::Size scaledSize(cvRound(imageSize.width * scale),
                         cvRound(imageSize.height * scale));
@@ -235,15 +283,13 @@ bool HumanPoseEstimator::inputWidthIsChanged(const cv::Size& imageSize) {
     pad(1) = std::floor((scaledImageSize.width - scaledSize.width) / 2.0);
     pad(2) = scaledImageSize.height - minHeight - pad(0);
     pad(3) = scaledImageSize.width - scaledSize.width - pad(1);
-    if (scaledSize.width == (inputLayerSize.width - pad(1) - pad(3))) {
-        return false;
-    }
-
-    inputLayerSize.width = scaledImageSize.width;
-    return true;
+    return scaledImageSize.width;
 }
 
 HumanPoseEstimator::~HumanPoseEstimator() {
+    for (auto& pendingImage : pendingImages) {
+        pendingImage.request.Wait(InferenceEngine::IInferRequest::WaitMode::RESULT_READY);
+    }
     if (enablePerformanceReport) {
         std::cout << "Performance counts for " << modelPath << std::endl << std::endl;
         printPerformanceCounts(request.GetPerformanceCounts(), std::cout, false);
@@ -15,9 +15,17 @@
 */
 
 #include <algorithm>
+#include <cfloat>
 #include <utility>
 #include <vector>
 
+#include <opencv2/imgproc/imgproc.hpp>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#define HUMAN_POSE_SSE2
+#include <emmintrin.h>
+#endif
+
 #include "peak.hpp"
 
 namespace human_pose_estimation {
@@ -38,68 +46,242 @@ TwoJointsConnection::TwoJointsConnection(const int firstJointIdx,
       secondJointIdx(secondJointIdx),
       score(score) {}
 
-void findPeaks(const std::vector<cv::Mat>& heatMaps,
-               const float minPeaksDistance,
-               std::vector<std::vector<Peak> >& allPeaks,
-               int heatMapId) {
-    const float threshold = 0.1f;
-    std::vector<cv::Point> peaks;
-    const cv::Mat& heatMap = heatMaps[heatMapId];
-    const float* heatMapData = heatMap.ptr<float>();
-    size_t heatMapStep = heatMap.step1();
-    for (int y = -1; y < heatMap.rows + 1; y++) {
-        for (int x = -1; x < heatMap.cols + 1; x++) {
-            float val = 0;
-            if (x >= 0
-                    && y >= 0
-                    && x < heatMap.cols
-                    && y < heatMap.rows) {
-                val = heatMapData[y * heatMapStep + x];
-                val = val >= threshold ? val : 0;
-            }
+FeatureMapUpsampler::FeatureMapUpsampler(const int upsampleRatio)
+    : upsampleRatio(upsampleRatio),
+      offsets(upsampleRatio),
+      coefficients(upsampleRatio) {
+    // The same mapping and coefficients as cv::resize with INTER_CUBIC
+    const float A = -0.75f;
+    for (int i = 0; i < upsampleRatio; i++) {
+        float srcPos = (i + 0.5f) / upsampleRatio - 0.5f;
+        int srcIdx = cvFloor(srcPos);
+        float x = srcPos - srcIdx;
+        offsets[i] = srcIdx - 1;
+        cv::Vec4f& c = coefficients[i];
+        c[0] = ((A * (x + 1) - 5 * A) * (x + 1) + 8 * A) * (x + 1) - 4 * A;
+        c[1] = ((A + 2) * x - (A + 3)) * x * x + 1;
+        c[2] = ((A + 2) * (1 - x) - (A + 3)) * (1 - x) * (1 - x) + 1;
+        c[3] = 1.0f - c[0] - c[1] - c[2];
+    }
+}
 
-            float left_val = 0;
-            if (y >= 0
-                    && x < (heatMap.cols - 1)
-                    && y < heatMap.rows) {
-                left_val = heatMapData[y * heatMapStep + x + 1];
-                left_val = left_val >= threshold ? left_val : 0;
-            }
+int FeatureMapUpsampler::ratio() const {
+    return upsampleRatio;
+}
 
-            float right_val = 0;
-            if (x > 0
-                    && y >= 0
-                    && y < heatMap.rows) {
-                right_val = heatMapData[y * heatMapStep + x - 1];
-                right_val = right_val >= threshold ? right_val : 0;
+float FeatureMapUpsampler::at(const cv::Mat& featureMap, const int x, const int y) const {
+    const int phaseX = x % upsampleRatio;
+    const int phaseY = y % upsampleRatio;
+    const int srcX = x / upsampleRatio + offsets[phaseX];
+    const int srcY = y / upsampleRatio + offsets[phaseY];
+    const cv::Vec4f& cx = coefficients[phaseX];
+    const cv::Vec4f& cy = coefficients[phaseY];
+    int cols[4];
+    for (int i = 0; i < 4; i++) {
+        cols[i] = std::min(std::max(srcX + i, 0), featureMap.cols - 1);
+    }
+    float value = 0;
+    for (int i = 0; i < 4; i++) {
+        const float* row = featureMap.ptr<float>(
+                    std::min(std::max(srcY + i, 0), featureMap.rows - 1));
+        value += cy[i] * (cx[0] * row[cols[0]] + cx[1] * row[cols[1]]
+                          + cx[2] * row[cols[2]] + cx[3] * row[cols[3]]);
+    }
+    return value;
+}
+
+void FeatureMapUpsampler::upsample(const cv::Mat& featureMap, const cv::Rect& window,
+                                   cv::Mat& upsampled, cv::Mat& upsampledRows) const {
+    if (upsampled.rows < window.height || upsampled.cols < window.width) {
+        upsampled.create(std::max(upsampled.rows, window.height),
+                         std::max(upsampled.cols, window.width), CV_32FC1);
+    }
+    for (int j = 0; j < window.height; j++) {
+        std::fill_n(upsampled.ptr<float>(j), window.width, 0.0f);
+    }
+    const cv::Rect inside = window & cv::Rect(cv::Point(), featureMap.size() * upsampleRatio);
+    if (inside.area() == 0) {
+        return;
+    }
+    const int lastY = inside.y + inside.height - 1;
+    const int firstRow = std::max(inside.y / upsampleRatio + offsets[inside.y % upsampleRatio], 0);
+    const int endRow = std::min(lastY / upsampleRatio + offsets[lastY % upsampleRatio] + 4,
+                                featureMap.rows);
+    if (upsampledRows.rows < endRow - firstRow || upsampledRows.cols < inside.width) {
+        upsampledRows.create(std::max(upsampledRows.rows, endRow - firstRow),
+                             std::max(upsampledRows.cols, inside.width), CV_32FC1);
+    }
+    for (int row = firstRow; row < endRow; row++) {
+        const float* src = featureMap.ptr<float>(row);
+        float* dst = upsampledRows.ptr<float>(row - firstRow);
+        int phase = inside.x % upsampleRatio;
+        int srcPos = inside.x / upsampleRatio;
+        for (int i = 0; i < inside.width; i++) {
+            const int srcX = srcPos + offsets[phase];
+            const cv::Vec4f& c = coefficients[phase];
+            if (srcX >= 0 && srcX + 3 < featureMap.cols) {
+                dst[i] = c[0] * src[srcX] + c[1] * src[srcX + 1]
+                        + c[2] * src[srcX + 2] + c[3] * src[srcX + 3];
+            } else {
+                float val = 0;
+                for (int k = 0; k < 4; k++) {
+                    val += c[k] * src[std::min(std::max(srcX + k, 0), featureMap.cols - 1)];
+                }
+                dst[i] = val;
+            }
+            if (++phase == upsampleRatio) {
+                phase = 0;
+                srcPos++;
             }
+        }
+    }
+    for (int j = 0; j < inside.height; j++) {
+        const int y = inside.y + j;
+        const int phase = y % upsampleRatio;
+        const int srcY = y / upsampleRatio + offsets[phase];
+        const cv::Vec4f& c = coefficients[phase];
+        const float* rows[4];
+        for (int k = 0; k < 4; k++) {
+            rows[k] = upsampledRows.ptr<float>(
+                        std::min(std::max(srcY + k, 0), featureMap.rows - 1) - firstRow);
+        }
+        float* dst = upsampled.ptr<float>(y - window.y) + (inside.x - window.x);
+        for (int i = 0; i < inside.width; i++) {
+            dst[i] = c[0] * rows[0][i] + c[1] * rows[1][i] + c[2] * rows[2][i] + c[3] * rows[3][i];
+        }
+    }
+}
 
-            float top_val = 0;
-            if (x >= 0
-                    && x < heatMap.cols
-                    && y < (heatMap.rows - 1)) {
-                top_val = heatMapData[(y + 1) * heatMapStep + x];
-                top_val = top_val >= threshold ? top_val : 0;
+namespace {
+// Appends the points of the heat map which are not lower than the threshold
+// and than both of their neighbours along a row or along a column. Peaks of
+// the upsampled map lie next to such points, including the ones on ridges and
+// saddles, which are not maxima among all of their neighbours. The map is
+// read from a copy with a border of -FLT_MAX, so that border pixels need no
+// special case.
+void findPeakCandidates(const cv::Mat& heatMap, const float threshold,
+                        cv::Mat& borderedHeatMap, std::vector<cv::Point>& candidates) {
+    cv::copyMakeBorder(heatMap, borderedHeatMap, 1, 1, 1, 1,
+                       cv::BORDER_CONSTANT, cv::Scalar::all(-FLT_MAX));
+    for (int y = 0; y < heatMap.rows; y++) {
+        // Rows above, at and below y, starting at x - 1
+        const float* top = borderedHeatMap.ptr<float>(y);
+        const float* mid = borderedHeatMap.ptr<float>(y + 1);
+        const float* bottom = borderedHeatMap.ptr<float>(y + 2);
+        int x = 0;
+#ifdef HUMAN_POSE_SSE2
+        const __m128 thresholds = _mm_set1_ps(threshold);
+        for (; x + 4 <= heatMap.cols; x += 4) {
+            __m128 val = _mm_loadu_ps(mid + x + 1);
+            __m128 horizontal = _mm_max_ps(_mm_loadu_ps(mid + x), _mm_loadu_ps(mid + x + 2));
+            __m128 vertical = _mm_max_ps(_mm_loadu_ps(top + x + 1), _mm_loadu_ps(bottom + x + 1));
+            __m128 isMaximum = _mm_or_ps(_mm_cmpge_ps(val, horizontal),
+                                         _mm_cmpge_ps(val, vertical));
+            int mask = _mm_movemask_ps(_mm_and_ps(isMaximum, _mm_cmpge_ps(val, thresholds)));
+            for (int i = 0; mask != 0; i++, mask >>= 1) {
+                if (mask & 1) {
+                    candidates.push_back(cv::Point(x + i, y));
+                }
+            }
+        }
+#endif
+        for (; x < heatMap.cols; x++) {
+            float val = mid[x + 1];
+            bool isMaximum = (val >= std::max(mid[x], mid[x + 2]))
+                    || (val >= std::max(top[x + 1], bottom[x + 1]));
+            if (isMaximum && val >= threshold) {
+                candidates.push_back(cv::Point(x, y));
             }
+        }
+    }
+}
 
-            float bottom_val = 0;
-            if (x >= 0
-                    && y > 0
-                    && x < heatMap.cols) {
-                bottom_val = heatMapData[(y - 1) * heatMapStep + x];
-                bottom_val = bottom_val >= threshold ? bottom_val : 0;
+// Appends the peaks of the upsampled heat map among the upsampled pixels of
+// the heat map pixels [xBegin, xEnd) of row y, computing the upsampled values
+// only there. Values are thresholded as in a search over the whole map.
+void findUpsampledPeaks(const cv::Mat& heatMap, const FeatureMapUpsampler& upsampler,
+                        const int y, const int xBegin, const int xEnd,
+                        const float threshold, PeaksSearchBuffers& buffers,
+                        std::vector<cv::Point>& peaks) {
+    const int ratio = upsampler.ratio();
+    cv::Rect searched(xBegin * ratio, y * ratio, (xEnd - xBegin) * ratio, ratio);
+    // The window has a margin of 1 pixel for the neighbours of the searched
+    // pixels, the margin outside of the upsampled map is 0
+    const cv::Size windowSize(searched.width + 2, searched.height + 2);
+    cv::Mat& window = buffers.window;
+    upsampler.upsample(heatMap, cv::Rect(searched.tl() - cv::Point(1, 1), windowSize),
+                       window, buffers.windowRows);
+    for (int wy = 0; wy < windowSize.height; wy++) {
+        float* windowRow = window.ptr<float>(wy);
+        for (int wx = 0; wx < windowSize.width; wx++) {
+            windowRow[wx] = windowRow[wx] >= threshold ? windowRow[wx] : 0;
+        }
+    }
+    for (int wy = 1; wy < windowSize.height - 1; wy++) {
+        const float* top = window.ptr<float>(wy - 1);
+        const float* mid = window.ptr<float>(wy);
+        const float* bottom = window.ptr<float>(wy + 1);
+        for (int wx = 1; wx < windowSize.width - 1; wx++) {
+            float val = mid[wx];
+            if ((val > mid[wx - 1])
+                    && (val > mid[wx + 1])
+                    && (val > top[wx])
+                    && (val > bottom[wx])) {
+                peaks.push_back(cv::Point(searched.x + wx - 1, searched.y + wy - 1));
             }
+        }
+    }
+}
+}  // namespace
+
+void findPeaks(const std::vector<cv::Mat>& heatMaps,
+               const FeatureMapUpsampler& upsampler,
+               const float minPeaksDistance,
+               std::vector<std::vector<Peak> >& allPeaks,
+               int heatMapId,
+               PeaksSearchBuffers& buffers) {
+    const float threshold = 0.1f;
+    // The upsampled map slightly overshoots the heat map around its maxima,
+    // so candidates somewhat below the threshold may have peaks above it
+    const float candidateThreshold = 0.5f * threshold;
+    const cv::Mat& heatMap = heatMaps[heatMapId];
+    buffers.candidates.clear();
+    findPeakCandidates(heatMap, candidateThreshold,
+                       buffers.borderedHeatMap, buffers.candidates);
 
-            if ((val > left_val)
-                    && (val > right_val)
-                    && (val > top_val)
-                    && (val > bottom_val)) {
-                peaks.push_back(cv::Point(x, y));
+    // Upsampled pixels of the heat map pixels within 1 pixel of a candidate
+    // are searched, each of them once
+    cv::Mat& searchArea = buffers.searchArea;
+    searchArea.create(heatMap.rows, heatMap.cols, CV_8UC1);
+    searchArea.setTo(0);
+    for (const auto& candidate : buffers.candidates) {
+        for (int y = std::max(candidate.y - 1, 0); y <= std::min(candidate.y + 1, heatMap.rows - 1); y++) {
+            uchar* searchAreaRow = searchArea.ptr<uchar>(y);
+            for (int x = std::max(candidate.x - 1, 0); x <= std::min(candidate.x + 1, heatMap.cols - 1); x++) {
+                searchAreaRow[x] = 1;
+            }
+        }
+    }
+    std::vector<cv::Point>& peaks = buffers.peaks;
+    peaks.clear();
+    for (int y = 0; y < heatMap.rows; y++) {
+        const uchar* searchAreaRow = searchArea.ptr<uchar>(y);
+        int x = 0;
+        while (x < heatMap.cols) {
+            if (!searchAreaRow[x]) {
+                x++;
+                continue;
+            }
+            int xEnd = x + 1;
+            while (xEnd < heatMap.cols && searchAreaRow[xEnd]) {
+                xEnd++;
             }
+            findUpsampledPeaks(heatMap, upsampler, y, x, xEnd, threshold, buffers, peaks);
+            x = xEnd;
         }
     }
     std::sort(peaks.begin(), peaks.end(), [](const cv::Point& a, const cv::Point& b) {
-        return a.x < b.x;
+        return a.x < b.x || (a.x == b.x && a.y < b.y);
     });
     std::vector<bool> isActualPeak(peaks.size(), true);
     int peakCounter = 0;
@@ -112,13 +294,15 @@ void findPeaks(const std::vector<cv::Mat>& heatMaps,
                     isActualPeak[j] = false;
                 }
             }
-            peaksWithScoreAndID.push_back(Peak(peakCounter++, peaks[i], heatMap.at<float>(peaks[i])));
+            peaksWithScoreAndID.push_back(Peak(peakCounter++, peaks[i],
+                                               upsampler.at(heatMap, peaks[i].x, peaks[i].y)));
         }
     }
 }
 
 std::vector<HumanPose> groupPeaksToPoses(const std::vector<std::vector<Peak> >& allPeaks,
                                          const std::vector<cv::Mat>& pafs,
+                                         const FeatureMapUpsampler& upsampler,
                                          const size_t keypointsNumber,
                                          const float midPointsScoreThreshold,
                                          const float foundMidPointsRatioThreshold,
@@ -141,7 +325,7 @@ std::vector<HumanPose> groupPeaksToPoses(const std::vector<std::vector<Peak> >&
     for (size_t k = 0; k < limbIdsPaf.size(); k++) {
         std::vector<TwoJointsConnection> connections;
         const int mapIdxOffset = keypointsNumber + 1;
-        std::pair<cv::Mat, cv::Mat> scoreMid = { pafs[limbIdsPaf[k].first - mapIdxOffset],
+        std::pair<const cv::Mat&, const cv::Mat&> scoreMid = { pafs[limbIdsPaf[k].first - mapIdxOffset],
                                                  pafs[limbIdsPaf[k].second - mapIdxOffset] };
         const int idxJointA = limbIdsHeatmap[k].first - 1;
         const int idxJointB = limbIdsHeatmap[k].second - 1;
@@ -201,8 +385,9 @@ std::vector<HumanPose> groupPeaksToPoses(const std::vector<std::vector<Peak> >&
                     continue;
                 }
                 vec /= norm_vec;
-                float score = vec.x * scoreMid.first.at<float>(mid) + vec.y * scoreMid.second.at<float>(mid);
-                int height_n  = pafs[0].rows / 2;
+                float score = vec.x * upsampler.at(scoreMid.first, mid.x, mid.y)
+                        + vec.y * upsampler.at(scoreMid.second, mid.x, mid.y);
+                int height_n  = pafs[0].rows * upsampler.ratio() / 2;
                 float suc_ratio = 0.0f;
                 float mid_score = 0.0f;
                 const int mid_num = 10;
@@ -215,8 +400,8 @@ std::vector<HumanPose> groupPeaksToPoses(const std::vector<std::vector<Peak> >&
                     for (int n = 0; n < mid_num; n++) {
                         cv::Point midPoint(cvRound(candA[i].pos.x + n * step.width),
                                            cvRound(candA[i].pos.y + n * step.height));
-                        cv::Point2f pred(scoreMid.first.at<float>(midPoint),
-                                         scoreMid.second.at<float>(midPoint));
+                        cv::Point2f pred(upsampler.at(scoreMid.first, midPoint.x, midPoint.y),
+                                         upsampler.at(scoreMid.second, midPoint.x, midPoint.y));
                         score = vec.x * pred.x + vec.y * pred.y;
                         if (score > midPointsScoreThreshold) {
                             p_sum += score;
@@ -19,6 +19,8 @@
 #include <utility>
 #include <algorithm>
 
+#include <samples/image_to_blob.hpp>
+
 #include "graph.hpp"
 #include "threading.hpp"
 
@@ -28,22 +30,12 @@
 
 namespace {
 
-void loadImgToIEGraph(const cv::Mat& img, size_t batch, void* ieBuffer) {
+void loadImgToIEGraph(const cv::Mat& img, const cv::Size& inputSize, size_t batch, void* ieBuffer) {
     const int channels = img.channels();
-    const int height = img.rows;
-    const int width = img.cols;
-
     float* ieData = reinterpret_cast<float*>(ieBuffer);
-    int bOffset = static_cast<int>(batch) * channels * width * height;
-    for (int c = 0; c < channels; c++) {
-        int cOffset = c * width * height;
-        for (int w = 0; w < width; w++) {
-            for (int h = 0; h < height; h++) {
-                ieData[bOffset + cOffset + h * width + w] =
-                        static_cast<float>(img.at<cv::Vec3b>(h, w)[c]);
-            }
-        }
-    }
+    size_t bOffset = batch * channels * inputSize.area();
+    image_to_blob::resizeToPlanar(img.data, img.step, img.cols, img.rows, channels,
+                                  ieData + bOffset, inputSize.width, inputSize.height);
 }
 
 }  // namespace
@@ -113,7 +105,6 @@ void IEGraph::start(GetterFunc getterFunc) {
     getter = std::move(getterFunc);
     getterThread = std::thread([&]() {
         std::vector<std::shared_ptr<VideoFrame>> vframes;
-        std::vector<cv::Mat> imgsToProc(batchSize);
         while (!terminate) {
             vframes.clear();
             size_t b = 0;
@@ -143,25 +134,15 @@ void IEGraph::start(GetterFunc getterFunc) {
             }
 
             auto inputBlob = req->GetBlob(inputDataBlobName);
-            imgsToProc.resize(batchSize);
-            for (size_t i = 0; i < batchSize; i++) {
-                if (imgsToProc[i].empty()) {
-                    auto& dims = inputBlob->getTensorDesc().getDims();
-                    assert(4 == dims.size());
-                    auto height = static_cast<int>(dims[2]);
-                    auto width  = static_cast<int>(dims[3]);
-                    imgsToProc[i] = cv::Mat(height, width, CV_8UC3);
-                }
-            }
+            auto& dims = inputBlob->getTensorDesc().getDims();
+            assert(4 == dims.size());
+            const cv::Size inputSize(static_cast<int>(dims[3]), static_cast<int>(dims[2]));
 
             auto preprocess = [&]() {
                 auto buff = inputBlob->buffer();
                 float* inputPtr = static_cast<float*>(buff);
                 auto loopBody = [&](size_t i) {
-                    cv::resize(vframes[i]->frame,
-                               imgsToProc[i],
-                               imgsToProc[i].size());
-                    loadImgToIEGraph(imgsToProc[i], i, inputPtr);
+                    loadImgToIEGraph(vframes[i]->frame, inputSize, i, inputPtr);
                 };
 #ifdef USE_TBB
                 run_in_arena([&](){
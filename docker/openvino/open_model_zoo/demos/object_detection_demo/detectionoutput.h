@@ -16,6 +16,7 @@
 
 #include "ext_list.hpp"
 #include "ext_base.hpp"
+#include "samples/nms.hpp"
 
 #include <cfloat>
 #include <vector>
@@ -109,12 +110,6 @@ public:
             _decoded_bboxes = make_shared_blob<float>({Precision::UNSPECIFIED, bboxes_size, NCHW});
             _decoded_bboxes->allocate();
 
-            SizeVector buf_size{static_cast<size_t>(_num),
-                                                 static_cast<size_t>(_num_classes),
-                                                 static_cast<size_t>(_num_priors)};
-            _buffer = make_shared_blob<int>({Precision::UNSPECIFIED, buf_size, {buf_size, {0, 1, 2}}});
-            _buffer->allocate();
-
             SizeVector indices_size{static_cast<size_t>(_num),
                                                      static_cast<size_t>(_num_classes),
                                                      static_cast<size_t>(_num_priors)};
@@ -130,13 +125,6 @@ public:
             _reordered_conf = make_shared_blob<float>({Precision::FP32, conf_size1, ANY});
             _reordered_conf->allocate();
 
-            SizeVector decoded_bboxes_size{static_cast<size_t>(_num),
-                                                            static_cast<size_t>(_num_priors),
-                                                            static_cast<size_t>(_num_classes)};
-            _bbox_sizes = make_shared_blob<float>(
-                    {Precision::FP32, decoded_bboxes_size, {decoded_bboxes_size, {0, 1, 2}}});
-            _bbox_sizes->allocate();
-
             SizeVector num_priors_actual_size{static_cast<size_t>(_num)};
             _num_priors_actual = make_shared_blob<int>({Precision::UNSPECIFIED, num_priors_actual_size, C});
             _num_priors_actual->allocate();
@@ -160,9 +148,7 @@ public:
 
         float *decoded_bboxes_data = _decoded_bboxes->buffer();
         float *reordered_conf_data = _reordered_conf->buffer();
-        float *bbox_sizes_data     = _bbox_sizes->buffer();
         int *detections_data       = _detections_count->buffer();
-        int *buffer_data           = _buffer->buffer();
         int *indices_data          = _indices->buffer();
         int *num_priors_actual     = _num_priors_actual->buffer();
 
@@ -173,8 +159,7 @@ public:
             if (_share_location) {
                 const float *ploc = loc_data + n*4*_num_priors;
                 float *pboxes = decoded_bboxes_data + n*4*_num_priors;
-                float *psizes = bbox_sizes_data + n*_num_priors;
-                decodeBBoxes(ppriors, ploc, prior_variances, pboxes, psizes, num_priors_actual, n);
+                decodeBBoxes(ppriors, ploc, prior_variances, pboxes, num_priors_actual, n);
             } else {
                 for (int c = 0; c < _num_loc_classes; ++c) {
                     if (c == _background_label_id) {
@@ -183,8 +168,7 @@ public:
 
                     const float *ploc = loc_data + n*4*_num_loc_classes*_num_priors + c*4;
                     float *pboxes = decoded_bboxes_data + n*4*_num_loc_classes*_num_priors + c*4*_num_priors;
-                    float *psizes = bbox_sizes_data + n*_num_loc_classes*_num_priors + c*_num_priors;
-                    decodeBBoxes(ppriors, ploc, prior_variances, pboxes, psizes, num_priors_actual, n);
+                    decodeBBoxes(ppriors, ploc, prior_variances, pboxes, num_priors_actual, n);
                 }
             }
         }
@@ -209,21 +193,17 @@ public:
                 }
 
                 int *pindices    = indices_data + n*_num_classes*_num_priors + c*_num_priors;
-                int *pbuffer     = buffer_data + c*_num_priors;
                 int *pdetections = detections_data + n*_num_classes + c;
 
                 const float *pconf = reordered_conf_data + n*_num_classes*_num_priors + c*_num_priors;
                 const float *pboxes;
-                const float *psizes;
                 if (_share_location) {
                     pboxes = decoded_bboxes_data + n*4*_num_priors;
-                    psizes = bbox_sizes_data + n*_num_priors;
                 } else {
                     pboxes = decoded_bboxes_data + n*4*_num_classes*_num_priors + c*4*_num_priors;
-                    psizes = bbox_sizes_data + n*_num_classes*_num_priors + c*_num_priors;
                 }
 
-                nms(pconf, pboxes, psizes, pbuffer, pindices, *pdetections, num_priors_actual[n]);
+                nms(pconf, pboxes, pindices, *pdetections, num_priors_actual[n]);
             }
 
             for (int c = 0; c < _num_classes; ++c) {
@@ -349,74 +329,27 @@ private:
     };
 
     void decodeBBoxes(const float *prior_data, const float *loc_data, const float *variance_data,
-                      float *decoded_bboxes, float *decoded_bbox_sizes, int* num_priors_actual, int n);
+                      float *decoded_bboxes, int* num_priors_actual, int n);
 
-    void nms(const float *conf_data, const float *bboxes, const float *sizes,
-             int *buffer, int *indices, int &detections, int num_priors_actual);
+    void nms(const float *conf_data, const float *bboxes,
+             int *indices, int &detections, int num_priors_actual);
+
+    nms::BoxSet _nms_boxes;
+    nms::Suppressor _nms;
+    std::vector<int> _nms_priors;
+    std::vector<int> _nms_keep;
 
     Blob::Ptr _decoded_bboxes;
-    Blob::Ptr _buffer;
     Blob::Ptr _indices;
     Blob::Ptr _detections_count;
     Blob::Ptr _reordered_conf;
-    Blob::Ptr _bbox_sizes;
     Blob::Ptr _num_priors_actual;
 };
 
-struct ConfidenceComparator {
-    explicit ConfidenceComparator(const float* conf_data) : _conf_data(conf_data) {}
-
-    bool operator()(int idx1, int idx2) {
-        if (_conf_data[idx1] > _conf_data[idx2]) return true;
-        if (_conf_data[idx1] < _conf_data[idx2]) return false;
-        return idx1 < idx2;
-    }
-
-    const float* _conf_data;
-};
-
-static inline float JaccardOverlap(const float *decoded_bbox,
-                                   const float *bbox_sizes,
-                                   const int idx1,
-                                   const int idx2) {
-    float xmin1 = decoded_bbox[idx1*4 + 0];
-    float ymin1 = decoded_bbox[idx1*4 + 1];
-    float xmax1 = decoded_bbox[idx1*4 + 2];
-    float ymax1 = decoded_bbox[idx1*4 + 3];
-
-    float xmin2 = decoded_bbox[idx2*4 + 0];
-    float ymin2 = decoded_bbox[idx2*4 + 1];
-    float ymax2 = decoded_bbox[idx2*4 + 3];
-    float xmax2 = decoded_bbox[idx2*4 + 2];
-
-    if (xmin2 > xmax1 || xmax2 < xmin1 || ymin2 > ymax1 || ymax2 < ymin1) {
-        return 0.0f;
-    }
-
-    float intersect_xmin = std::max(xmin1, xmin2);
-    float intersect_ymin = std::max(ymin1, ymin2);
-    float intersect_xmax = std::min(xmax1, xmax2);
-    float intersect_ymax = std::min(ymax1, ymax2);
-
-    float intersect_width  = intersect_xmax - intersect_xmin;
-    float intersect_height = intersect_ymax - intersect_ymin;
-
-    if (intersect_width <= 0 || intersect_height <= 0) {
-        return 0.0f;
-    }
-
-    float intersect_size = intersect_width * intersect_height;
-    float bbox1_size = bbox_sizes[idx1];
-    float bbox2_size = bbox_sizes[idx2];
-
-    return intersect_size / (bbox1_size + bbox2_size - intersect_size);
-}
-
 void DetectionOutputPostProcessor::decodeBBoxes(const float *prior_data,
                                    const float *loc_data,
                                    const float *variance_data,
                                    float *decoded_bboxes,
-                                   float *decoded_bbox_sizes,
                                    int* num_priors_actual,
                                    int n) {
     num_priors_actual[n] = _num_priors;
@@ -500,48 +433,30 @@ void DetectionOutputPostProcessor::decodeBBoxes(const float *prior_data,
         decoded_bboxes[p*4 + 1] = new_ymin;
         decoded_bboxes[p*4 + 2] = new_xmax;
         decoded_bboxes[p*4 + 3] = new_ymax;
-
-        decoded_bbox_sizes[p] = (new_xmax - new_xmin) * (new_ymax - new_ymin);
     }
 }
 
 void DetectionOutputPostProcessor::nms(const float* conf_data,
                           const float* bboxes,
-                          const float* sizes,
-                          int* buffer,
                           int* indices,
                           int& detections,
                           int num_priors_actual) {
-    int count = 0;
+    _nms_boxes.clear();
+    _nms_priors.clear();
     for (int i = 0; i < num_priors_actual; ++i) {
         if (conf_data[i] > _confidence_threshold) {
-            indices[count] = i;
-            count++;
+            _nms_priors.push_back(i);
+            _nms_boxes.add(bboxes[i*4 + 0], bboxes[i*4 + 1], bboxes[i*4 + 2], bboxes[i*4 + 3], conf_data[i]);
         }
     }
 
-    int num_output_scores = (_top_k == -1 ? count : std::min<int>(_top_k, count));
-
-    std::partial_sort_copy(indices, indices + count,
-                           buffer, buffer + num_output_scores,
-                           ConfidenceComparator(conf_data));
+    nms::Params params;
+    params.iou_threshold = _nms_threshold;
+    params.top_k = _top_k;
+    _nms.run(_nms_boxes, params, _nms_keep);
 
-    for (int i = 0; i < num_output_scores; ++i) {
-        const int idx = buffer[i];
-
-        bool keep = true;
-        for (int k = 0; k < detections; ++k) {
-            const int kept_idx = indices[k];
-            float overlap = JaccardOverlap(bboxes, sizes, idx, kept_idx);
-            if (overlap > _nms_threshold) {
-                keep = false;
-                break;
-            }
-        }
-        if (keep) {
-            indices[detections] = idx;
-            detections++;
-        }
+    for (int kept : _nms_keep) {
+        indices[detections] = _nms_priors[kept];
+        detections++;
     }
 }
-
@@ -34,6 +34,7 @@
 #include <inference_engine.hpp>
 
 #include <samples/common.hpp>
+#include <samples/nms.hpp>
 #include <samples/slog.hpp>
 
 #include "object_detection_demo_yolov3_async.hpp"
@@ -96,26 +97,8 @@ struct DetectionObject {
         this->class_id = class_id;
         this->confidence = confidence;
     }
-
-    bool operator<(const DetectionObject &s2) const {
-        return this->confidence < s2.confidence;
-    }
 };
 
-double IntersectionOverUnion(const DetectionObject &box_1, const DetectionObject &box_2) {
-    double width_of_overlap_area = fmin(box_1.xmax, box_2.xmax) - fmax(box_1.xmin, box_2.xmin);
-    double height_of_overlap_area = fmin(box_1.ymax, box_2.ymax) - fmax(box_1.ymin, box_2.ymin);
-    double area_of_overlap;
-    if (width_of_overlap_area < 0 || height_of_overlap_area < 0)
-        area_of_overlap = 0;
-    else
-        area_of_overlap = width_of_overlap_area * height_of_overlap_area;
-    double box_1_area = (box_1.ymax - box_1.ymin)  * (box_1.xmax - box_1.xmin);
-    double box_2_area = (box_2.ymax - box_2.ymin)  * (box_2.xmax - box_2.xmin);
-    double area_of_union = box_1_area + box_2_area - area_of_overlap;
-    return area_of_overlap / area_of_union;
-}
-
 void ParseYOLOV3Output(const CNNLayerPtr &layer, const Blob::Ptr &blob, const unsigned long resized_im_h,
                        const unsigned long resized_im_w, const unsigned long original_im_h,
                        const unsigned long original_im_w,
@@ -316,6 +299,13 @@ int main(int argc, char *argv[]) {
         auto wallclock = std::chrono::high_resolution_clock::now();
         double ocv_decode_time = 0, ocv_render_time = 0;
 
+        nms::Params nms_params;
+        nms_params.iou_threshold = static_cast<float>(FLAGS_iou_t);
+        nms_params.inclusive = true;
+        nms::Suppressor suppressor;
+        nms::BoxSet boxes;
+        std::vector<int> kept;
+
         while (true) {
             auto t0 = std::chrono::high_resolution_clock::now();
             // Here is the first asynchronous point:
@@ -394,17 +384,15 @@ int main(int argc, char *argv[]) {
                     Blob::Ptr blob = async_infer_request_curr->GetBlob(output_name);
                     ParseYOLOV3Output(layer, blob, resized_im_h, resized_im_w, height, width, FLAGS_t, objects);
                 }
-                // Filtering overlapping boxes
-                std::sort(objects.begin(), objects.end());
-                for (int i = 0; i < objects.size(); ++i) {
-                    if (objects[i].confidence == 0)
-                        continue;
-                    for (int j = i + 1; j < objects.size(); ++j)
-                        if (IntersectionOverUnion(objects[i], objects[j]) >= FLAGS_iou_t)
-                            objects[j].confidence = 0;
+                // Filtering overlapping boxes, the most confident first
+                boxes.clear();
+                for (auto &object : objects) {
+                    boxes.add(object.xmin, object.ymin, object.xmax, object.ymax, object.confidence);
                 }
+                suppressor.run(boxes, nms_params, kept);
                 // Drawing boxes
-                for (auto &object : objects) {
+                for (int idx : kept) {
+                    auto &object = objects[idx];
                     if (object.confidence < FLAGS_t)
                         continue;
                     auto label = object.class_id;
@@ -108,7 +108,7 @@ public:
         PT_CHECK(descrs != nullptr);
         descrs->resize(mats.size());
         for (size_t i = 0; i < mats.size(); i++)  {
-            Compute(mats[i], &(descrs[i]));
+            Compute(mats[i], &((*descrs)[i]));
         }
     }
 
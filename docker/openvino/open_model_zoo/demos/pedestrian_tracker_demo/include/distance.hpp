@@ -28,6 +28,21 @@
 
 
 
+///
+/// \brief Descriptors flattened into the rows of a CV_32F matrix, with the
+/// norm of each row. It is kept between calls so that its memory is reused.
+///
+struct StackedDescriptors {
+    cv::Mat rows;              ///< One flattened descriptor per row.
+    std::vector<float> norms;  ///< Euclidean norm of each row.
+
+    ///
+    /// \brief Copies descriptors of the same size and type into the rows.
+    /// \param[in] descrs Descriptors to stack.
+    ///
+    void Stack(const std::vector<cv::Mat> &descrs);
+};
+
 ///
 /// \brief The IDescriptorDistance class declares an interface for distance
 /// computation between reidentification descriptors.
@@ -51,6 +66,17 @@ public:
     virtual std::vector<float> Compute(const std::vector<cv::Mat> &descrs1,
                                        const std::vector<cv::Mat> &descrs2) = 0;
 
+    ///
+    /// \brief Computes distances between each descriptor of the first set and
+    /// each descriptor of the second one.
+    /// \param[in] descrs1 First set of descriptors.
+    /// \param[in] descrs2 Second set of descriptors.
+    /// \param[out] distances descrs1.size() x descrs2.size() CV_32F matrix.
+    ///
+    virtual void ComputeMatrix(const std::vector<cv::Mat> &descrs1,
+                               const std::vector<cv::Mat> &descrs2,
+                               cv::Mat *distances);
+
     virtual ~IDescriptorDistance() {}
 };
 
@@ -84,8 +110,21 @@ public:
         const std::vector<cv::Mat> &descrs1,
         const std::vector<cv::Mat> &descrs2) override;
 
+    ///
+    /// \brief Computes distances between each descriptor of the first set and
+    /// each descriptor of the second one with vectorized dot products.
+    /// \param[in] descrs1 First set of descriptors.
+    /// \param[in] descrs2 Second set of descriptors.
+    /// \param[out] distances descrs1.size() x descrs2.size() CV_32F matrix.
+    ///
+    void ComputeMatrix(const std::vector<cv::Mat> &descrs1,
+                       const std::vector<cv::Mat> &descrs2,
+                       cv::Mat *distances) override;
+
 private:
     cv::Size descriptor_size_;
+    StackedDescriptors stacked1_;  ///< Buffers of ComputeMatrix.
+    StackedDescriptors stacked2_;
 };
 
 
@@ -126,6 +165,18 @@ public:
     ///
     std::vector<float> Compute(const std::vector<cv::Mat> &descrs1,
                                const std::vector<cv::Mat> &descrs2) override;
+    ///
+    /// \brief Computes distances between each descriptor of the first set and
+    /// each descriptor of the second one. Normed cross-correlation of equally
+    /// sized descriptors is their cosine similarity, which is computed with
+    /// vectorized dot products instead of one MatchTemplate call per pair.
+    /// \param[in] descrs1 First set of descriptors.
+    /// \param[in] descrs2 Second set of descriptors.
+    /// \param[out] distances descrs1.size() x descrs2.size() CV_32F matrix.
+    ///
+    void ComputeMatrix(const std::vector<cv::Mat> &descrs1,
+                       const std::vector<cv::Mat> &descrs2,
+                       cv::Mat *distances) override;
     virtual ~MatchTemplateDistance() {}
 
 private:
@@ -134,5 +185,7 @@ private:
                     /// computed as: scale * distance + offset.
     float offset_;  ///< Offset parameter for the distance. Final distance is
                     /// computed as: scale * distance + offset.
+    StackedDescriptors stacked1_;  ///< Buffers of ComputeMatrix.
+    StackedDescriptors stacked2_;
 };
 
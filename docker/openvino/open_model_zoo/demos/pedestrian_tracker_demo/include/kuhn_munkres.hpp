@@ -17,6 +17,7 @@
 #pragma once
 
 #include "core.hpp"
+#include "samples/linear_assignment.hpp"
 
 #include <memory>
 #include <vector>
@@ -25,7 +26,8 @@
 ///
 /// \brief The KuhnMunkres class
 ///
-/// Solves the assignment problem.
+/// Solves the assignment problem with the rectangular solver of
+/// linear_assignment.hpp.
 ///
 class KuhnMunkres {
 public:
@@ -37,30 +39,14 @@ public:
     /// corresponding row (e.g. result[0] stores optimal column index for very
     /// first row in the dissimilarity matrix).
     /// \param dissimilarity_matrix CV_32F dissimilarity matrix.
+    /// \param gate Pairs with this dissimilarity or more are never assigned.
     /// \return Optimal column index for each row. -1 means that there is no
     /// column for row.
     ///
-    std::vector<size_t> Solve(const cv::Mat &dissimilarity_matrix);
+    std::vector<size_t> Solve(const cv::Mat &dissimilarity_matrix,
+                              float gate = linear_assignment::kNoGate);
 
 private:
-    static constexpr int kStar = 1;
-    static constexpr int kPrime = 2;
-
-    cv::Mat dm_;
-    cv::Mat marked_;
-    std::vector<cv::Point> points_;
-
-    std::vector<int> is_row_visited_;
-    std::vector<int> is_col_visited_;
-
-    int n_;
-
-    void TrySimpleCase();
-    bool CheckIfOptimumIsFound();
-    cv::Point FindUncoveredMinValPos();
-    void UpdateDissimilarityMatrix(float val);
-    int FindInRow(int row, int what);
-    int FindInCol(int col, int what);
-    void Run();
+    linear_assignment::AssignmentSolver solver_;
+    std::vector<int> row_to_col_;
 };
-
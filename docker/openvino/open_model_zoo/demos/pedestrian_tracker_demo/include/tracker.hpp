@@ -18,6 +18,7 @@
 
 #include "core.hpp"
 
+#include <future>
 #include <memory>
 #include <string>
 #include <vector>
@@ -342,7 +343,8 @@ public:
     void DropForgottenTrack(size_t track_id);
 
     ///
-    /// \brief Prints reid performance counter
+    /// \brief Prints reid performance counter and how often strong descriptors
+    /// were reused instead of computed.
     ///
     void PrintReidPerformanceCounts() const;
 
@@ -411,6 +413,10 @@ private:
         const std::vector<std::pair<size_t, size_t>> &track_and_det_ids,
         std::map<size_t, cv::Mat> *det_id_to_descriptor);
 
+    void SubmitTrackStrongDescriptors();
+
+    void CollectTrackStrongDescriptors();
+
     std::map<size_t, std::pair<bool, cv::Mat>> StrongMatching(
         const cv::Mat &frame,
         const TrackedObjects& detections,
@@ -419,8 +425,8 @@ private:
     std::vector<std::pair<size_t, size_t>> GetTrackToDetectionIds(
         const std::set<std::tuple<size_t, size_t, float>> &matches);
 
-    float AffinityFast(const cv::Mat &descriptor1, const TrackedObject &obj1,
-                       const cv::Mat &descriptor2, const TrackedObject &obj2);
+    float AffinityFast(float appearance_distance, const cv::Rect &trk_rect,
+                       int trk_frame_idx, const TrackedObject &det);
 
     float Affinity(const TrackedObject &obj1, const TrackedObject &obj2);
 
@@ -530,5 +536,42 @@ private:
     std::vector<cv::Scalar> colors_;
 
     uint64_t prev_timestamp_;
+
+    // Active tracks gathered into contiguous arrays once per frame, so that
+    // the affinity matrix is filled without hash lookups and object copies.
+    struct ActiveTracks {
+        std::vector<cv::Rect> predicted_rects;
+        std::vector<int> frame_indices;  // Of the last object in track.
+        std::vector<cv::Mat> descriptors_fast;
+
+        void Gather(const std::unordered_map<size_t, Track> &tracks,
+                    const std::set<size_t> &ids);
+    };
+
+    // Buffers reused from frame to frame.
+    ActiveTracks active_tracks_;
+    std::vector<cv::Mat> detection_images_;
+    std::vector<cv::Mat> detection_descriptors_fast_;
+    cv::Mat appearance_distances_;
+    cv::Mat dissimilarity_;
+
+    // Strong descriptors of the active tracks which have none, computed by
+    // the reid network while the fast matching is done.
+    std::future<std::vector<cv::Mat>> track_descriptors_strong_;
+    std::vector<size_t> pending_track_ids_;
+
+    // Strong descriptors of the detections of the current frame, each one is
+    // computed at most once however many tracks it is compared with.
+    std::vector<cv::Mat> detection_descriptors_strong_;
+
+    struct ReidStats {
+        size_t pairs = 0;                  // Compared track and detection pairs.
+        size_t detections_computed = 0;    // Detection descriptors computed.
+        size_t detection_cache_hits = 0;   // Detection descriptors reused.
+        size_t tracks_computed = 0;        // Track descriptors computed.
+        size_t tracks_computed_async = 0;  // Of them, while fast matching.
+        size_t track_cache_hits = 0;       // Track descriptors reused.
+    };
+    ReidStats reid_stats_;
 };
 
@@ -16,9 +16,45 @@
 
 #include "distance.hpp"
 #include "logging.hpp"
+#include "samples/embedding_distance.hpp"
 
 #include <vector>
 
+void StackedDescriptors::Stack(const std::vector<cv::Mat> &descrs) {
+    PT_CHECK(!descrs.empty());
+    int length = static_cast<int>(descrs[0].total() * descrs[0].channels());
+    rows.create(static_cast<int>(descrs.size()), length, CV_32F);
+    for (size_t i = 0; i < descrs.size(); i++) {
+        const cv::Mat &descr = descrs[i];
+        PT_CHECK(!descr.empty());
+        PT_CHECK_EQ(descr.size(), descrs[0].size());
+        PT_CHECK_EQ(descr.type(), descrs[0].type());
+        cv::Mat row = rows.row(static_cast<int>(i));
+        if (descr.isContinuous()) {
+            descr.reshape(1, 1).convertTo(row, CV_32F);
+        } else {
+            descr.clone().reshape(1, 1).convertTo(row, CV_32F);
+        }
+    }
+    norms.resize(descrs.size());
+    embedding_distance::computeNorms(rows.ptr<float>(), rows.rows, rows.cols,
+                                     norms.data());
+}
+
+void IDescriptorDistance::ComputeMatrix(const std::vector<cv::Mat> &descrs1,
+                                        const std::vector<cv::Mat> &descrs2,
+                                        cv::Mat *distances) {
+    PT_CHECK(distances != nullptr);
+    distances->create(static_cast<int>(descrs1.size()),
+                      static_cast<int>(descrs2.size()), CV_32F);
+    for (size_t i = 0; i < descrs1.size(); i++) {
+        float *row = distances->ptr<float>(static_cast<int>(i));
+        for (size_t j = 0; j < descrs2.size(); j++) {
+            row[j] = Compute(descrs1[i], descrs2[j]);
+        }
+    }
+}
+
 CosDistance::CosDistance(const cv::Size &descriptor_size)
     : descriptor_size_(descriptor_size) {
     PT_CHECK(descriptor_size.area() != 0);
@@ -29,12 +65,13 @@ float CosDistance::Compute(const cv::Mat &descr1, const cv::Mat &descr2) {
     PT_CHECK(!descr2.empty());
     PT_CHECK(descr1.size() == descriptor_size_);
     PT_CHECK(descr2.size() == descriptor_size_);
+    PT_CHECK_EQ(descr1.type(), CV_32F);
+    PT_CHECK_EQ(descr2.type(), CV_32F);
 
-    double xy = descr1.dot(descr2);
-    double xx = descr1.dot(descr1);
-    double yy = descr2.dot(descr2);
-    double norm = sqrt(xx * yy) + 1e-6;
-    return 0.5f * static_cast<float>(1.0 - xy / norm);
+    cv::Mat a = descr1.isContinuous() ? descr1 : descr1.clone();
+    cv::Mat b = descr2.isContinuous() ? descr2 : descr2.clone();
+    return 0.5f * embedding_distance::cosineDistance(
+        a.ptr<float>(), b.ptr<float>(), descriptor_size_.area());
 }
 
 std::vector<float> CosDistance::Compute(const std::vector<cv::Mat> &descrs1,
@@ -51,6 +88,27 @@ std::vector<float> CosDistance::Compute(const std::vector<cv::Mat> &descrs1,
 }
 
 
+void CosDistance::ComputeMatrix(const std::vector<cv::Mat> &descrs1,
+                                const std::vector<cv::Mat> &descrs2,
+                                cv::Mat *distances) {
+    PT_CHECK(distances != nullptr);
+    if (descrs1.empty() || descrs2.empty()) {
+        distances->create(static_cast<int>(descrs1.size()),
+                          static_cast<int>(descrs2.size()), CV_32F);
+        return;
+    }
+    PT_CHECK(descrs1[0].size() == descriptor_size_);
+    PT_CHECK(descrs2[0].size() == descriptor_size_);
+    stacked1_.Stack(descrs1);
+    stacked2_.Stack(descrs2);
+    distances->create(stacked1_.rows.rows, stacked2_.rows.rows, CV_32F);
+    embedding_distance::cosineDistanceMatrix(
+        stacked1_.rows.ptr<float>(), stacked1_.norms.data(), stacked1_.rows.rows,
+        stacked2_.rows.ptr<float>(), stacked2_.norms.data(), stacked2_.rows.rows,
+        stacked1_.rows.cols, distances->ptr<float>());
+    *distances *= 0.5f;
+}
+
 float MatchTemplateDistance::Compute(const cv::Mat &descr1,
                                      const cv::Mat &descr2) {
     PT_CHECK(!descr1.empty() && !descr2.empty());
@@ -71,3 +129,25 @@ std::vector<float> MatchTemplateDistance::Compute(const std::vector<cv::Mat> &de
     }
     return result;
 }
+
+void MatchTemplateDistance::ComputeMatrix(const std::vector<cv::Mat> &descrs1,
+                                          const std::vector<cv::Mat> &descrs2,
+                                          cv::Mat *distances) {
+    PT_CHECK(distances != nullptr);
+    if (type_ != cv::TemplateMatchModes::TM_CCORR_NORMED ||
+        descrs1.empty() || descrs2.empty()) {
+        IDescriptorDistance::ComputeMatrix(descrs1, descrs2, distances);
+        return;
+    }
+    PT_CHECK_EQ(descrs1[0].size(), descrs2[0].size());
+    PT_CHECK_EQ(descrs1[0].type(), descrs2[0].type());
+    stacked1_.Stack(descrs1);
+    stacked2_.Stack(descrs2);
+    distances->create(stacked1_.rows.rows, stacked2_.rows.rows, CV_32F);
+    embedding_distance::cosineDistanceMatrix(
+        stacked1_.rows.ptr<float>(), stacked1_.norms.data(), stacked1_.rows.rows,
+        stacked2_.rows.ptr<float>(), stacked2_.norms.data(), stacked2_.rows.rows,
+        stacked1_.rows.cols, distances->ptr<float>());
+    // scale * correlation + offset, where correlation = 1 - cosine distance
+    distances->convertTo(*distances, CV_32F, -scale_, scale_ + offset_);
+}
@@ -16,6 +16,8 @@
 
 
 
+#include <future>
+#include <iostream>
 #include <map>
 #include <set>
 #include <string>
@@ -286,11 +288,14 @@ void PedestrianTracker::SolveAssignmentProblem(
     PT_CHECK(matches);
     matches->clear();
 
-    cv::Mat dissimilarity;
+    cv::Mat &dissimilarity = dissimilarity_;
     ComputeDissimilarityMatrix(track_ids, detections, descriptors,
                                &dissimilarity);
 
-    auto res = KuhnMunkres().Solve(dissimilarity);
+    // Pairs not above strong_affinity_thr are left unmatched by Process()
+    // anyway, gating them keeps the problem sparse in crowded scenes
+    auto res = KuhnMunkres().Solve(dissimilarity,
+                                   1.0f - params_.strong_affinity_thr);
 
     for (size_t i = 0; i < detections.size(); i++) {
         unmatched_detections->insert(i);
@@ -441,7 +446,12 @@ void PedestrianTracker::Process(const cv::Mat &frame,
         obj.timestamp = timestamp;
     }
 
-    std::vector<cv::Mat> descriptors_fast;
+    detection_descriptors_strong_.assign(detections.size(), cv::Mat());
+    if (distance_strong_ && !active_track_ids_.empty() && !detections.empty()) {
+        SubmitTrackStrongDescriptors();
+    }
+
+    std::vector<cv::Mat> &descriptors_fast = detection_descriptors_fast_;
     ComputeFastDesciptors(frame, detections, &descriptors_fast);
 
     auto active_tracks = active_track_ids_;
@@ -583,10 +593,29 @@ float PedestrianTracker::TimeAffinity(float weight, const float &trk_time,
 void PedestrianTracker::ComputeFastDesciptors(
     const cv::Mat &frame, const TrackedObjects &detections,
     std::vector<cv::Mat> *desriptors) {
-    *desriptors = std::vector<cv::Mat>(detections.size(), cv::Mat());
-    for (size_t i = 0; i < detections.size(); i++) {
-        descriptor_fast_->Compute(frame(detections[i].rect).clone(),
-                                  &((*desriptors)[i]));
+    // The descriptor reads the detections from the frame, no copy is needed
+    detection_images_.clear();
+    for (const auto &detection : detections) {
+        detection_images_.push_back(frame(detection.rect));
+    }
+    desriptors->resize(detections.size());
+    if (!detections.empty()) {
+        descriptor_fast_->Compute(detection_images_, desriptors);
+    }
+}
+
+void PedestrianTracker::ActiveTracks::Gather(
+    const std::unordered_map<size_t, Track> &tracks,
+    const std::set<size_t> &ids) {
+    predicted_rects.clear();
+    frame_indices.clear();
+    descriptors_fast.resize(ids.size());
+    size_t i = 0;
+    for (auto id : ids) {
+        const auto &track = tracks.at(id);
+        predicted_rects.push_back(track.predicted_rect);
+        frame_indices.push_back(track.objects.back().frame_idx);
+        descriptors_fast[i++] = track.descriptor_fast;
     }
 }
 
@@ -594,19 +623,58 @@ void PedestrianTracker::ComputeDissimilarityMatrix(
     const std::set<size_t> &active_tracks, const TrackedObjects &detections,
     const std::vector<cv::Mat> &descriptors_fast,
     cv::Mat *dissimilarity_matrix) {
-    cv::Mat am(active_tracks.size(), detections.size(), CV_32F, cv::Scalar(0));
-    size_t i = 0;
-    for (auto id : active_tracks) {
-        auto ptr = am.ptr<float>(i);
-        for (size_t j = 0; j < descriptors_fast.size(); j++) {
-            auto last_det = tracks_.at(id).objects.back();
-            last_det.rect = tracks_.at(id).predicted_rect;
-            ptr[j] = AffinityFast(tracks_.at(id).descriptor_fast, last_det,
-                                  descriptors_fast[j], detections[j]);
+    active_tracks_.Gather(tracks_, active_tracks);
+    distance_fast_->ComputeMatrix(active_tracks_.descriptors_fast,
+                                  descriptors_fast, &appearance_distances_);
+
+    dissimilarity_matrix->create(active_tracks.size(), detections.size(), CV_32F);
+    for (size_t i = 0; i < active_tracks.size(); i++) {
+        auto ptr = dissimilarity_matrix->ptr<float>(i);
+        const auto app_dist_ptr = appearance_distances_.ptr<float>(i);
+        const cv::Rect &trk_rect = active_tracks_.predicted_rects[i];
+        int trk_frame_idx = active_tracks_.frame_indices[i];
+        for (size_t j = 0; j < detections.size(); j++) {
+            ptr[j] = 1.0f - AffinityFast(app_dist_ptr[j], trk_rect, trk_frame_idx,
+                                         detections[j]);
         }
-        i++;
     }
-    *dissimilarity_matrix = 1.0 - am;
+}
+
+void PedestrianTracker::SubmitTrackStrongDescriptors() {
+    pending_track_ids_.clear();
+    std::vector<cv::Mat> images;
+    for (size_t id : active_track_ids_) {
+        const auto &track = tracks_.at(id);
+        if (track.descriptor_strong.empty() && !track.last_image.empty()) {
+            pending_track_ids_.push_back(id);
+            images.push_back(track.last_image);
+        }
+    }
+    if (images.empty()) {
+        return;
+    }
+
+    // The images are not written until CollectTrackStrongDescriptors() is
+    // called, which is before any track is updated
+    Descriptor descriptor = descriptor_strong_;
+    track_descriptors_strong_ = std::async(std::launch::async, [descriptor, images]() {
+        std::vector<cv::Mat> descriptors;
+        descriptor->Compute(images, &descriptors);
+        return descriptors;
+    });
+}
+
+void PedestrianTracker::CollectTrackStrongDescriptors() {
+    if (!track_descriptors_strong_.valid()) {
+        return;
+    }
+    std::vector<cv::Mat> descriptors = track_descriptors_strong_.get();
+    PT_CHECK_EQ(descriptors.size(), pending_track_ids_.size());
+    for (size_t i = 0; i < pending_track_ids_.size(); i++) {
+        tracks_.at(pending_track_ids_[i]).descriptor_strong = descriptors[i].clone();
+    }
+    reid_stats_.tracks_computed += descriptors.size();
+    reid_stats_.tracks_computed_async += descriptors.size();
 }
 
 std::vector<float> PedestrianTracker::ComputeDistances(
@@ -617,24 +685,45 @@ std::vector<float> PedestrianTracker::ComputeDistances(
     std::map<size_t, size_t> det_to_batch_ids;
     std::map<size_t, size_t> track_to_batch_ids;
 
+    // Only descriptors that are neither stored in the track nor computed for
+    // the frame yet are batched, each of them once
     std::vector<cv::Mat> images;
-    std::vector<cv::Mat> descriptors;
     for (size_t i = 0; i < track_and_det_ids.size(); i++) {
         size_t track_id = track_and_det_ids[i].first;
         size_t det_id = track_and_det_ids[i].second;
 
-        if (tracks_.at(track_id).descriptor_strong.empty()) {
+        if (!tracks_.at(track_id).descriptor_strong.empty()) {
+            reid_stats_.track_cache_hits++;
+        } else if (track_to_batch_ids.find(track_id) == track_to_batch_ids.end()) {
+            track_to_batch_ids[track_id] = images.size();
             images.push_back(tracks_.at(track_id).last_image);
-            descriptors.push_back(cv::Mat());
-            track_to_batch_ids[track_id] = descriptors.size() - 1;
+        } else {
+            reid_stats_.track_cache_hits++;
         }
 
-        images.push_back(frame(detections[det_id].rect));
-        descriptors.push_back(cv::Mat());
-        det_to_batch_ids[det_id] = descriptors.size() - 1;
+        if (!detection_descriptors_strong_[det_id].empty()) {
+            reid_stats_.detection_cache_hits++;
+        } else if (det_to_batch_ids.find(det_id) == det_to_batch_ids.end()) {
+            det_to_batch_ids[det_id] = images.size();
+            images.push_back(frame(detections[det_id].rect));
+        } else {
+            reid_stats_.detection_cache_hits++;
+        }
     }
+    reid_stats_.pairs += track_and_det_ids.size();
 
-    descriptor_strong_->Compute(images, &descriptors);
+    if (!images.empty()) {
+        std::vector<cv::Mat> descriptors;
+        descriptor_strong_->Compute(images, &descriptors);
+        for (const auto &item : track_to_batch_ids) {
+            tracks_.at(item.first).descriptor_strong = descriptors[item.second].clone();
+        }
+        for (const auto &item : det_to_batch_ids) {
+            detection_descriptors_strong_[item.first] = descriptors[item.second];
+        }
+        reid_stats_.tracks_computed += track_to_batch_ids.size();
+        reid_stats_.detections_computed += det_to_batch_ids.size();
+    }
 
     std::vector<cv::Mat> descriptors1;
     std::vector<cv::Mat> descriptors2;
@@ -642,13 +731,9 @@ std::vector<float> PedestrianTracker::ComputeDistances(
         size_t track_id = track_and_det_ids[i].first;
         size_t det_id = track_and_det_ids[i].second;
 
-        if (tracks_.at(track_id).descriptor_strong.empty()) {
-            tracks_.at(track_id).descriptor_strong =
-                descriptors[track_to_batch_ids[track_id]].clone();
-        }
-        (*det_id_to_descriptor)[det_id] = descriptors[det_to_batch_ids[det_id]];
+        (*det_id_to_descriptor)[det_id] = detection_descriptors_strong_[det_id];
 
-        descriptors1.push_back(descriptors[det_to_batch_ids[det_id]]);
+        descriptors1.push_back(detection_descriptors_strong_[det_id]);
         descriptors2.push_back(tracks_.at(track_id).descriptor_strong);
     }
 
@@ -681,6 +766,8 @@ PedestrianTracker::StrongMatching(
     const std::vector<std::pair<size_t, size_t>> &track_and_det_ids) {
     std::map<size_t, std::pair<bool, cv::Mat>> is_matching;
 
+    CollectTrackStrongDescriptors();
+
     if (track_and_det_ids.size() == 0) {
         return is_matching;
     }
@@ -777,8 +864,9 @@ void PedestrianTracker::AppendToTrack(const cv::Mat &frame,
     cur_track.objects.emplace_back(detection_with_id);
     cur_track.predicted_rect = detection.rect;
     cur_track.lost = 0;
-    cur_track.last_image = frame(detection.rect).clone();
-    cur_track.descriptor_fast = descriptor_fast.clone();
+    // copyTo reuses the buffers of the track when the sizes are the same
+    frame(detection.rect).copyTo(cur_track.last_image);
+    descriptor_fast.copyTo(cur_track.descriptor_fast);
     cur_track.length++;
 
     if (cur_track.descriptor_strong.empty()) {
@@ -797,23 +885,23 @@ void PedestrianTracker::AppendToTrack(const cv::Mat &frame,
     }
 }
 
-float PedestrianTracker::AffinityFast(const cv::Mat &descriptor1,
-                                      const TrackedObject &obj1,
-                                      const cv::Mat &descriptor2,
-                                      const TrackedObject &obj2) {
+float PedestrianTracker::AffinityFast(float appearance_distance,
+                                      const cv::Rect &trk_rect,
+                                      int trk_frame_idx,
+                                      const TrackedObject &det) {
     const float eps = 1e-6;
-    float shp_aff = ShapeAffinity(params_.shape_affinity_w, obj1.rect, obj2.rect);
+    float shp_aff = ShapeAffinity(params_.shape_affinity_w, trk_rect, det.rect);
     if (shp_aff < eps) return 0.0;
 
     float mot_aff =
-        MotionAffinity(params_.motion_affinity_w, obj1.rect, obj2.rect);
+        MotionAffinity(params_.motion_affinity_w, trk_rect, det.rect);
     if (mot_aff < eps) return 0.0;
     float time_aff =
-        TimeAffinity(params_.time_affinity_w, obj1.frame_idx, obj2.frame_idx);
+        TimeAffinity(params_.time_affinity_w, trk_frame_idx, det.frame_idx);
 
     if (time_aff < eps) return 0.0;
 
-    float app_aff = 1.0 - distance_fast_->Compute(descriptor1, descriptor2);
+    float app_aff = 1.0 - appearance_distance;
 
     return shp_aff * mot_aff * app_aff * time_aff;
 }
@@ -945,4 +1033,13 @@ void PedestrianTracker::PrintReidPerformanceCounts() const {
     if (descriptor_strong_) {
         descriptor_strong_->PrintPerformanceCounts();
     }
+    std::cout << "Reid descriptors of " << reid_stats_.pairs
+              << " compared track and detection pairs:" << std::endl;
+    std::cout << "  detections: " << reid_stats_.detections_computed
+              << " computed, " << reid_stats_.detection_cache_hits
+              << " reused" << std::endl;
+    std::cout << "  tracks: " << reid_stats_.tracks_computed << " computed ("
+              << reid_stats_.tracks_computed_async
+              << " while fast matching), " << reid_stats_.track_cache_hits
+              << " reused" << std::endl;
 }
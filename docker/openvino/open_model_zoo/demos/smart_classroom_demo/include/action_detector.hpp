@@ -23,6 +23,7 @@
 #include <opencv2/core/core.hpp>
 
 #include "cnn.hpp"
+#include "samples/nms.hpp"
 
 /**
 * @brief Class for detection with action info
@@ -98,6 +99,8 @@ private:
     float width_ = 0;
     float height_ = 0;
     bool results_fetched_ = false;
+    mutable nms::BoxSet nms_boxes_;
+    mutable nms::Suppressor nms_;
     /**
     * @brief BBox in normalized form (each coordinate is in range [0;1]).
     */
@@ -155,10 +158,12 @@ private:
     * @param detections Detected actions
     * @param overlap_threshold Threshold to merge pair of bboxes
     * @param top_k Number of top-score bboxes
+    * @param keep_top_k Number of top-score bboxes in output
     * @param out_indices Out indices of valid detections
     */
     void NonMaxSuppression(const DetectedActions& detections,
                            const float overlap_threshold,
                            const int top_k,
+                           const int keep_top_k,
                            std::vector<int>* out_indices) const;
 };
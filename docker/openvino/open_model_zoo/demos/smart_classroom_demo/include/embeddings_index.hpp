@@ -0,0 +1,58 @@
+/*
+// Copyright (c) 2018 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+*/
+
+#pragma once
+
+#include <vector>
+
+#include <opencv2/core/core.hpp>
+
+///
+/// \brief Inverted file index over embeddings for approximate nearest
+/// neighbour search by cosine distance.
+///
+/// The embeddings are clustered with k-means, a query is compared with the
+/// cluster centers first and then exactly with the embeddings of the closest
+/// clusters only.
+///
+class IvfIndex {
+public:
+    ///
+    /// \brief Builds the index.
+    /// \param embeddings CV_32F matrix with one embedding per row.
+    /// \param num_lists Number of clusters, 0 to pick about sqrt of the number
+    /// of embeddings.
+    ///
+    void Build(const cv::Mat &embeddings, int num_lists = 0);
+
+    ///
+    /// \brief Finds the embeddings closest to a query.
+    /// \param query Embedding of the same length as the indexed ones.
+    /// \param k Max number of embeddings returned.
+    /// \param num_probes Number of closest clusters searched, 0 to search
+    /// a quarter of them.
+    /// \return Row indices of the closest embeddings, closest first.
+    ///
+    std::vector<int> Search(const cv::Mat &query, int k, int num_probes = 0) const;
+
+    bool Empty() const { return data_.empty(); }
+
+private:
+    // L2-normalized copies of the embeddings and of the cluster centers
+    cv::Mat data_;
+    cv::Mat centers_;
+    std::vector<std::vector<int>> lists_;
+};
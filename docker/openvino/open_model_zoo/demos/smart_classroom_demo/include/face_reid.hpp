@@ -23,6 +23,7 @@
 #include <opencv2/core/core.hpp>
 
 #include "cnn.hpp"
+#include "embeddings_index.hpp"
 
 struct GalleryObject {
     std::vector<cv::Mat> embeddings;
@@ -38,9 +39,15 @@ class EmbeddingsGallery {
 public:
     static const std::string unknown_label;
     static const int unknown_id;
+    // embeddings_cache: file the embeddings of the gallery images are read
+    // from instead of running the networks, written if missing or outdated.
+    // top_k: number of nearest gallery images retrieved by an index for each
+    // face before assignment, 0 to assign faces over the whole gallery.
     EmbeddingsGallery(const std::string& ids_list, double threshold,
                       const VectorCNN& landmarks_det,
-                      const VectorCNN& image_reid);
+                      const VectorCNN& image_reid,
+                      const std::string& embeddings_cache = "",
+                      int top_k = 0);
 
     std::vector<int> GetIDsByEmbeddings(const std::vector<cv::Mat>& embeddings) const;
     std::string GetLabelByID(int id) const;
@@ -49,6 +56,11 @@ private:
     std::vector<int> idx_to_id;
     double reid_threshold;
     std::vector<GalleryObject> identities;
+    // Embeddings of all the gallery images, one per row, and their norms
+    cv::Mat reference_embeddings;
+    std::vector<float> reference_norms;
+    int top_k;
+    IvfIndex index;
 };
 
 void AlignFaces(std::vector<cv::Mat>* face_images,
@@ -78,6 +78,15 @@ static const char threshold_output_message_face_reid[] = "Optional. Cosine dista
 /// @brief message for faces gallery path
 static const char reid_gallery_path_message[] = "Optional. Path to a faces gallery in json format.";
 
+/// @brief message for faces gallery embeddings cache path
+static const char reid_gallery_cache_message[] = "Optional. Path to a file caching the embeddings of the faces gallery. "\
+"It is read instead of running the networks on the gallery images, and written if missing or outdated. "\
+"Delete it when changing the landmarks or reid model.";
+
+/// @brief message for number of gallery candidates per face
+static const char reid_gallery_top_k_message[] = "Optional. Number of nearest gallery images retrieved by an index "\
+"for each face, faces are assigned among them only. 0 to assign faces over the whole gallery.";
+
 /// @brief message for output video path
 static const char output_video_message[] = "Optional. File to write output video with visualization to.";
 
@@ -162,6 +171,14 @@ DEFINE_double(t_reid, 0.7, threshold_output_message_face_reid);
 /// It is a optional parameter
 DEFINE_string(fg, "", reid_gallery_path_message);
 
+/// @brief Path to a cache of the embeddings of the faces gallery <br>
+/// It is a optional parameter
+DEFINE_string(fg_cache, "", reid_gallery_cache_message);
+
+/// @brief Number of gallery candidates per face <br>
+/// It is a optional parameter
+DEFINE_int32(fg_topk, 0, reid_gallery_top_k_message);
+
 /// @brief File to write output video with visualization to.
 /// It is a optional parameter
 DEFINE_string(out_v, "", output_video_message);
@@ -213,5 +230,7 @@ static void showUsage() {
     std::cout << "    -exp_r_fd                      " << expand_ratio_output_message << std::endl;
     std::cout << "    -t_reid                        " << threshold_output_message_face_reid << std::endl;
     std::cout << "    -fg                            " << reid_gallery_path_message << std::endl;
+    std::cout << "    -fg_cache \"<path>\"           " << reid_gallery_cache_message << std::endl;
+    std::cout << "    -fg_topk                       " << reid_gallery_top_k_message << std::endl;
     std::cout << "    -no_show                       " << no_show_processed_video << std::endl;
 }
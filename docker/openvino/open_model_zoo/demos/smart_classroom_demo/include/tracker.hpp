@@ -18,6 +18,7 @@
 
 #include "cnn.hpp"
 
+#include <limits>
 #include <memory>
 #include <set>
 #include <string>
@@ -46,7 +47,8 @@ using TrackedObjects = std::vector<TrackedObject>;
 ///
 /// \brief The KuhnMunkres class
 ///
-/// Solves the assignment problem.
+/// Solves the assignment problem with the rectangular solver of
+/// linear_assignment.hpp.
 ///
 class KuhnMunkres {
 public:
@@ -58,10 +60,12 @@ public:
     /// corresponding row (e.g. result[0] stores optimal column index for very
     /// first row in the dissimilarity matrix).
     /// \param dissimilarity_matrix CV_32F dissimilarity matrix.
+    /// \param gate Pairs with this dissimilarity or more are never assigned.
     /// \return Optimal column index for each row. -1 means that there is no
     /// column for row.
     ///
-    std::vector<size_t> Solve(const cv::Mat &dissimilarity_matrix);
+    std::vector<size_t> Solve(const cv::Mat &dissimilarity_matrix,
+                              float gate = std::numeric_limits<float>::infinity());
 
 private:
     class Impl;
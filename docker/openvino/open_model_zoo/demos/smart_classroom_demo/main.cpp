@@ -254,7 +254,8 @@ int main(int argc, char* argv[]) {
         VectorCNN landmarks_detector(landmarks_config);
 
         // Create face gallery
-        EmbeddingsGallery face_gallery(FLAGS_fg, FLAGS_t_reid, landmarks_detector, face_reid);
+        EmbeddingsGallery face_gallery(FLAGS_fg, FLAGS_t_reid, landmarks_detector, face_reid,
+                                       FLAGS_fg_cache, FLAGS_fg_topk);
 
         // Create tracker for reid
         TrackerParams tracker_reid_params;
@@ -25,13 +25,6 @@ using namespace InferenceEngine;
 #define SSD_PRIORBOX_RECORD_SIZE 4
 #define NUM_DETECTION_CLASSES 2
 #define POSITIVE_DETECTION_IDX 1
-#define INVALID_TOP_K_IDX -1
-
-template <typename T>
-bool SortScorePairDescend(const std::pair<float, T>& pair1,
-                          const std::pair<float, T>& pair2) {
-    return pair1.first > pair2.first;
-}
 
 void ActionDetection::submitRequest() {
     if (!enqueued_frames_) return;
@@ -228,35 +221,11 @@ void ActionDetection::GetDetections(const cv::Mat& loc, const cv::Mat& main_conf
         valid_detections.emplace_back(det_rect, action_label, detection_conf, action_conf);
     }
 
-    /** Merge most overlapped detections **/
+    /** Merge most overlapped detections and select keep_top_k detections
+        with highest detection confidence if possible **/
     std::vector<int> out_det_indices;
     NonMaxSuppression(valid_detections, config_.nms_threshold, config_.nms_top_k,
-                      &out_det_indices);
-
-    /** Select keep_top_k detections with highest detection confidence if possible **/
-    const int num_detections = out_det_indices.size();
-    if (config_.keep_top_k > INVALID_TOP_K_IDX
-            && num_detections > config_.keep_top_k) {
-        /** Store input bbox scores with idx **/
-        std::vector<std::pair<float, int> > indexed_scores;
-        for (int i = 0; i < num_detections; ++i) {
-            const int idx = out_det_indices[i];
-            indexed_scores.emplace_back(valid_detections[idx].detection_conf, idx);
-        }
-        /** Sort indexed scores in descending order **/
-        std::stable_sort(indexed_scores.begin(), indexed_scores.end(),
-                         SortScorePairDescend<int>);
-        /** Select top_k scores **/
-        indexed_scores.resize(config_.keep_top_k);
-
-        /** Store the selected indices **/
-        std::vector<int> selected_indices;
-        for (size_t i = 0; i < indexed_scores.size(); ++i) {
-            selected_indices.push_back(indexed_scores[i].second);
-        }
-
-        out_det_indices.swap(selected_indices);
-    }
+                      config_.keep_top_k, &out_det_indices);
 
     detections->clear();
     for (size_t i = 0; i < out_det_indices.size(); ++i) {
@@ -266,49 +235,18 @@ void ActionDetection::GetDetections(const cv::Mat& loc, const cv::Mat& main_conf
 
 void ActionDetection::NonMaxSuppression(
         const DetectedActions& detections,
-        const float overlap_threshold, const int top_k,
+        const float overlap_threshold, const int top_k, const int keep_top_k,
         std::vector<int>* out_indices) const {
-    /** Store input bbox scores with idx **/
-    std::vector<std::pair<float, int> > indexed_scores;
-    for (size_t i = 0; i < detections.size(); ++i) {
-        indexed_scores.emplace_back(detections[i].detection_conf, i);
-    }
-    /** Sort indexed scores in descending order **/
-    std::stable_sort(indexed_scores.begin(), indexed_scores.end(),
-                     SortScorePairDescend<int>);
-    /** Select top_k scores if possible **/
-    if (top_k > INVALID_TOP_K_IDX
-            && top_k < static_cast<int>(indexed_scores.size())) {
-        indexed_scores.resize(top_k);
+    nms_boxes_.clear();
+    for (const auto& detection : detections) {
+        const auto& rect = detection.rect;
+        nms_boxes_.add(rect.x, rect.y, rect.x + rect.width, rect.y + rect.height,
+                       detection.detection_conf);
     }
 
-    /** Carry out Non-Maximum Suppression algorithm **/
-    out_indices->clear();
-    for (const auto& item : indexed_scores) {
-        const int& anchor_idx = item.second;
-
-        bool keep_idx = true;
-        for (int reference_idx : *out_indices) {
-            /** Calculate the Intersection over Union metric between two bboxes**/
-            const auto& rect1 = detections[anchor_idx].rect;
-            const auto& rect2 = detections[reference_idx].rect;
-            const auto intersection = rect1 & rect2;
-            float overlap = 0.f;
-            if (intersection.width > 0.f && intersection.height > 0.f) {
-                const float intersection_area = intersection.area();
-                overlap = intersection_area / (rect1.area() + rect2.area() - intersection_area);
-            }
-
-            /** Remove overlapped bbox with lowest confidence **/
-            if (overlap > overlap_threshold) {
-                keep_idx = false;
-                break;
-            }
-        }
-
-        /** Store output bbox **/
-        if (keep_idx) {
-            out_indices->emplace_back(anchor_idx);
-        }
-    }
+    nms::Params params;
+    params.iou_threshold = overlap_threshold;
+    params.top_k = top_k;
+    params.keep_top_k = keep_top_k;
+    nms_.run(nms_boxes_, params, *out_indices);
 }
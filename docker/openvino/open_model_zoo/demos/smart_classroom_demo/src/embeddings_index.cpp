@@ -0,0 +1,111 @@
+/*
+// Copyright (c) 2018 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+*/
+
+#include "embeddings_index.hpp"
+#include "samples/embedding_distance.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <utility>
+#include <vector>
+
+#include <opencv2/opencv.hpp>
+
+namespace {
+    cv::Mat NormalizedRows(const cv::Mat& m) {
+        cv::Mat normalized = m.clone();
+        for (int r = 0; r < normalized.rows; r++) {
+            embedding_distance::normalize(normalized.ptr<float>(r), normalized.cols);
+        }
+        return normalized;
+    }
+
+    // Indices of the k largest values, largest first
+    std::vector<int> TopK(const std::vector<std::pair<float, int>>& scores, int k) {
+        std::vector<std::pair<float, int>> sorted = scores;
+        k = std::min(k, static_cast<int>(sorted.size()));
+        std::partial_sort(sorted.begin(), sorted.begin() + k, sorted.end(),
+                          [](const std::pair<float, int>& a, const std::pair<float, int>& b) {
+                              return a.first > b.first;
+                          });
+        std::vector<int> indices;
+        for (int i = 0; i < k; i++) {
+            indices.push_back(sorted[i].second);
+        }
+        return indices;
+    }
+}  // namespace
+
+void IvfIndex::Build(const cv::Mat& embeddings, int num_lists) {
+    CV_Assert(embeddings.type() == CV_32F);
+    data_ = NormalizedRows(embeddings);
+    lists_.clear();
+    if (data_.empty()) {
+        centers_ = cv::Mat();
+        return;
+    }
+
+    if (num_lists <= 0) {
+        num_lists = static_cast<int>(std::round(std::sqrt(data_.rows)));
+    }
+    num_lists = std::max(1, std::min(num_lists, data_.rows));
+
+    cv::Mat labels;
+    if (num_lists == 1) {
+        labels = cv::Mat::zeros(data_.rows, 1, CV_32S);
+        cv::reduce(data_, centers_, 0, cv::REDUCE_AVG);
+    } else {
+        // On normalized embeddings euclidean k-means groups by cosine as well
+        cv::kmeans(data_, num_lists, labels,
+                   cv::TermCriteria(cv::TermCriteria::COUNT + cv::TermCriteria::EPS, 20, 1e-4),
+                   1, cv::KMEANS_PP_CENTERS, centers_);
+    }
+    centers_ = NormalizedRows(centers_);
+
+    lists_.resize(num_lists);
+    for (int r = 0; r < data_.rows; r++) {
+        lists_[labels.at<int>(r)].push_back(r);
+    }
+}
+
+std::vector<int> IvfIndex::Search(const cv::Mat& query, int k, int num_probes) const {
+    if (Empty() || k <= 0) {
+        return std::vector<int>();
+    }
+    CV_Assert(query.type() == CV_32F && static_cast<int>(query.total()) == data_.cols);
+    cv::Mat q = query.reshape(1, 1).clone();
+    embedding_distance::normalize(q.ptr<float>(), q.cols);
+
+    if (num_probes <= 0) {
+        num_probes = std::max(1, static_cast<int>(lists_.size() + 3) / 4);
+    }
+
+    std::vector<std::pair<float, int>> center_scores;
+    for (int c = 0; c < centers_.rows; c++) {
+        center_scores.emplace_back(
+            embedding_distance::dot(q.ptr<float>(), centers_.ptr<float>(c), q.cols), c);
+    }
+
+    // Exact similarities of the members of the probed lists
+    std::vector<std::pair<float, int>> scores;
+    for (int list : TopK(center_scores, num_probes)) {
+        for (int r : lists_[list]) {
+            scores.emplace_back(
+                embedding_distance::dot(q.ptr<float>(), data_.ptr<float>(r), q.cols), r);
+        }
+    }
+    return TopK(scores, k);
+}
@@ -16,9 +16,13 @@
 
 #include "face_reid.hpp"
 #include "tracker.hpp"
+#include "samples/embedding_distance.hpp"
 
+#include <algorithm>
+#include <cmath>
 #include <fstream>
 #include <iostream>
+#include <set>
 #include <vector>
 #include <string>
 #include <limits>
@@ -26,12 +30,25 @@
 #include <opencv2/opencv.hpp>
 
 namespace {
-    float ComputeReidDistance(const cv::Mat& descr1, const cv::Mat& descr2) {
-        float xy = descr1.dot(descr2);
-        float xx = descr1.dot(descr1);
-        float yy = descr2.dot(descr2);
-        float norm = sqrt(xx * yy) + 1e-6;
-        return 1.0f - xy / norm;
+    // Copies embeddings into the rows of a CV_32F matrix
+    cv::Mat StackEmbeddings(const std::vector<cv::Mat>& embeddings) {
+        if (embeddings.empty())
+            return cv::Mat();
+        cv::Mat stacked(static_cast<int>(embeddings.size()),
+                        static_cast<int>(embeddings[0].total()), CV_32F);
+        for (size_t i = 0; i < embeddings.size(); i++) {
+            CV_Assert(embeddings[i].type() == CV_32F &&
+                      embeddings[i].total() == static_cast<size_t>(stacked.cols));
+            embeddings[i].reshape(1, 1).copyTo(stacked.row(static_cast<int>(i)));
+        }
+        return stacked;
+    }
+
+    std::vector<float> ComputeNorms(const cv::Mat& stacked) {
+        std::vector<float> norms(stacked.rows);
+        embedding_distance::computeNorms(stacked.ptr<float>(), stacked.rows,
+                                         stacked.cols, norms.data());
+        return norms;
     }
 
     bool file_exists(const std::string& name) {
@@ -55,6 +72,68 @@ namespace {
         return std::string(".") + separator();
     }
 
+    // Gallery images are fed to the networks in chunks of this size, so that
+    // only a chunk of full size images is held in memory at once
+    const size_t kGalleryBatchSize = 16;
+
+    std::vector<cv::Mat> ComputeEmbeddings(const std::vector<std::string>& paths,
+                                           const VectorCNN& landmarks_det,
+                                           const VectorCNN& image_reid) {
+        std::vector<cv::Mat> embeddings;
+        for (size_t begin = 0; begin < paths.size(); begin += kGalleryBatchSize) {
+            size_t end = std::min(begin + kGalleryBatchSize, paths.size());
+            std::vector<cv::Mat> images, landmarks, chunk;
+            for (size_t i = begin; i < end; i++) {
+                cv::Mat image = cv::imread(paths[i]);
+                CV_Assert(!image.empty());
+                images.push_back(image);
+            }
+            landmarks_det.Compute(images, &landmarks, cv::Size(2, 5));
+            AlignFaces(&images, &landmarks);
+            image_reid.Compute(images, &chunk);
+            embeddings.insert(embeddings.end(), chunk.begin(), chunk.end());
+        }
+        return embeddings;
+    }
+
+    // The cache holds the labels and paths of the gallery images it was
+    // computed for, it is only used if they are the same as in the gallery
+    bool LoadEmbeddings(const std::string& cache,
+                        const std::vector<std::string>& labels,
+                        const std::vector<std::string>& paths,
+                        std::vector<cv::Mat>* embeddings) {
+        if (!file_exists(cache))
+            return false;
+        cv::FileStorage fs(cache, cv::FileStorage::Mode::READ);
+        std::vector<std::string> cached_labels, cached_paths;
+        for (const auto& node : fs["labels"])
+            cached_labels.push_back(std::string(node));
+        for (const auto& node : fs["paths"])
+            cached_paths.push_back(std::string(node));
+        cv::Mat stacked;
+        fs["embeddings"] >> stacked;
+        if (cached_labels != labels || cached_paths != paths ||
+            stacked.rows != static_cast<int>(paths.size()) || stacked.type() != CV_32F)
+            return false;
+        embeddings->clear();
+        for (int r = 0; r < stacked.rows; r++)
+            embeddings->push_back(stacked.row(r).clone());
+        return true;
+    }
+
+    void SaveEmbeddings(const std::string& cache,
+                        const std::vector<std::string>& labels,
+                        const std::vector<std::string>& paths,
+                        const std::vector<cv::Mat>& embeddings) {
+        cv::FileStorage fs(cache, cv::FileStorage::Mode::WRITE);
+        fs << "labels" << "[";
+        for (const auto& label : labels)
+            fs << label;
+        fs << "]" << "paths" << "[";
+        for (const auto& path : paths)
+            fs << path;
+        fs << "]" << "embeddings" << StackEmbeddings(embeddings);
+    }
 }  // namespace
 
 const std::string EmbeddingsGallery::unknown_label = "Unknown";
@@ -63,8 +142,10 @@ const int EmbeddingsGallery::unknown_id = -1;
 EmbeddingsGallery::EmbeddingsGallery(const std::string& ids_list,
                                      double threshold,
                                      const VectorCNN& landmarks_det,
-                                     const VectorCNN& image_reid)
-    : reid_threshold(threshold) {
+                                     const VectorCNN& image_reid,
+                                     const std::string& embeddings_cache,
+                                     int top_k)
+    : reid_threshold(threshold), top_k(top_k) {
     if (ids_list.empty()) {
         std::cout << "Warning: face reid gallery is empty!" << "\n";
         return;
@@ -77,13 +158,9 @@ EmbeddingsGallery::EmbeddingsGallery(const std::string& ids_list,
 
     cv::FileStorage fs(ids_list, cv::FileStorage::Mode::READ);
     cv::FileNode fn = fs.root();
-    int total_images = 0;
-    int id = 0;
+    std::vector<std::string> labels, paths;
     for (cv::FileNodeIterator fit = fn.begin(); fit != fn.end(); ++fit) {
         cv::FileNode item = *fit;
-        std::string label = item.name();
-        std::vector<cv::Mat> embeddings;
-
         for (size_t i = 0; i < item.size(); i++) {
             std::string path;
             if (file_exists(item[i])) {
@@ -91,21 +168,36 @@ EmbeddingsGallery::EmbeddingsGallery(const std::string& ids_list,
             } else {
                 path = folder_name(ids_list) + separator() + std::string(item[i]);
             }
+            labels.push_back(item.name());
+            paths.push_back(path);
+        }
+    }
 
-            cv::Mat image = cv::imread(path);
-            CV_Assert(!image.empty());
-            cv::Mat emb, landmarks;
-            landmarks_det.Compute(image, &landmarks, cv::Size(2, 5));
-            std::vector<cv::Mat> images = {image};
-            std::vector<cv::Mat> landmarks_vec = {landmarks};
-            AlignFaces(&images, &landmarks_vec);
-            image_reid.Compute(images[0], &emb);
-            embeddings.push_back(emb);
-            idx_to_id.push_back(total_images);
-            total_images++;
+    std::vector<cv::Mat> embeddings;
+    if (!embeddings_cache.empty() &&
+        LoadEmbeddings(embeddings_cache, labels, paths, &embeddings)) {
+        std::cout << "Loaded embeddings of " << paths.size()
+                  << " gallery images from " << embeddings_cache << "\n";
+    } else {
+        embeddings = ComputeEmbeddings(paths, landmarks_det, image_reid);
+        if (!embeddings_cache.empty()) {
+            SaveEmbeddings(embeddings_cache, labels, paths, embeddings);
         }
-        identities.emplace_back(embeddings, label, id);
-        ++id;
+    }
+
+    for (size_t i = 0; i < embeddings.size(); i++) {
+        if (identities.empty() || identities.back().label != labels[i]) {
+            identities.emplace_back(std::vector<cv::Mat>(), labels[i],
+                                    static_cast<int>(identities.size()));
+        }
+        identities.back().embeddings.push_back(embeddings[i]);
+        idx_to_id.push_back(identities.back().id);
+    }
+
+    reference_embeddings = StackEmbeddings(embeddings);
+    reference_norms = ComputeNorms(reference_embeddings);
+    if (top_k > 0) {
+        index.Build(reference_embeddings);
     }
 }
 
@@ -113,25 +205,52 @@ std::vector<int> EmbeddingsGallery::GetIDsByEmbeddings(const std::vector<cv::Mat
     if (embeddings.empty() || idx_to_id.empty())
         return std::vector<int>();
 
-    cv::Mat distances(static_cast<int>(embeddings.size()), static_cast<int>(idx_to_id.size()), CV_32F);
+    cv::Mat queries = StackEmbeddings(embeddings);
+    CV_Assert(queries.cols == reference_embeddings.cols);
+    std::vector<float> query_norms = ComputeNorms(queries);
 
-    for (int i = 0; i < distances.rows; i++) {
-        int k = 0;
-        for (size_t j = 0; j < identities.size(); j++) {
-            for (const auto& reference_emb : identities[j].embeddings) {
-                distances.at<float>(i, k) = ComputeReidDistance(embeddings[i], reference_emb);
-                k++;
-            }
+    // Gallery images the faces are assigned to: all of them, or the union of
+    // the nearest ones of each face found by the index
+    cv::Mat references = reference_embeddings;
+    std::vector<float> norms = reference_norms;
+    std::vector<int> columns;
+    if (top_k > 0 && !index.Empty()) {
+        std::set<int> candidates;
+        for (int i = 0; i < queries.rows; i++) {
+            auto nearest = index.Search(queries.row(i), top_k);
+            candidates.insert(nearest.begin(), nearest.end());
+        }
+        columns.assign(candidates.begin(), candidates.end());
+        references = cv::Mat(static_cast<int>(columns.size()), queries.cols, CV_32F);
+        norms.clear();
+        for (size_t c = 0; c < columns.size(); c++) {
+            reference_embeddings.row(columns[c]).copyTo(references.row(static_cast<int>(c)));
+            norms.push_back(reference_norms[columns[c]]);
         }
+    } else {
+        for (int c = 0; c < reference_embeddings.rows; c++)
+            columns.push_back(c);
     }
+
+    cv::Mat distances(queries.rows, references.rows, CV_32F);
+    embedding_distance::cosineDistanceMatrix(
+        queries.ptr<float>(), query_norms.data(), queries.rows,
+        references.ptr<float>(), norms.data(), references.rows,
+        queries.cols, distances.ptr<float>());
+
+    // faces farther than the threshold from every gallery image stay unknown,
+    // gating them out lets the solver split the faces into independent groups
     KuhnMunkres matcher;
-    auto matched_idx = matcher.Solve(distances);
+    auto matched_idx = matcher.Solve(
+        distances, std::nextafter(static_cast<float>(reid_threshold),
+                                  std::numeric_limits<float>::infinity()));
     std::vector<int> output_ids;
-    for (auto col_idx : matched_idx) {
-        if (distances.at<float>(output_ids.size(), col_idx) > reid_threshold)
+    for (int i = 0; i < distances.rows; i++) {
+        size_t col_idx = matched_idx[i];
+        if (col_idx >= static_cast<size_t>(distances.cols))
             output_ids.push_back(unknown_id);
         else
-            output_ids.push_back(idx_to_id[col_idx]);
+            output_ids.push_back(idx_to_id[columns[col_idx]]);
     }
     return output_ids;
 }
@@ -0,0 +1,471 @@
+/*
+ * depth_roi_stats.h
+ *
+ * Cogniteam LTD CONFIDENTIAL
+ *
+ * Unpublished Copyright (c) 2016-2017 Cogniteam,        All Rights Reserved.
+ *
+ * NOTICE:  All information contained  herein  is,  and  remains the property
+ * of Cogniteam.   The   intellectual   and   technical   concepts  contained
+ * herein are proprietary to Cogniteam and may  be  covered  by  Israeli  and
+ * Foreign Patents, patents in process,  and  are  protected  by trade secret
+ * or copyright law. Dissemination of  this  information  or  reproduction of
+ * this material is strictly forbidden unless  prior  written  permission  is
+ * obtained  from  Cogniteam.  Access  to  the  source  code contained herein
+ * is hereby   forbidden   to   anyone  except  current  Cogniteam employees,
+ * managers   or   contractors   who   have   executed   Confidentiality  and
+ * Non-disclosure    agreements    explicitly    covering     such     access
+ *
+ * The copyright notice  above  does  not  evidence  any  actual  or intended
+ * publication  or  disclosure    of    this  source  code,   which  includes
+ * information that is confidential  and/or  proprietary,  and  is  a   trade
+ * secret, of   Cogniteam.    ANY REPRODUCTION,  MODIFICATION,  DISTRIBUTION,
+ * PUBLIC   PERFORMANCE,  OR  PUBLIC  DISPLAY  OF  OR  THROUGH USE   OF  THIS
+ * SOURCE  CODE   WITHOUT   THE  EXPRESS  WRITTEN  CONSENT  OF  Cogniteam  IS
+ * STRICTLY PROHIBITED, AND IN VIOLATION OF APPLICABLE LAWS AND INTERNATIONAL
+ * TREATIES.  THE RECEIPT OR POSSESSION OF  THIS SOURCE  CODE  AND/OR RELATED
+ * INFORMATION DOES  NOT CONVEY OR IMPLY ANY RIGHTS  TO  REPRODUCE,  DISCLOSE
+ * OR  DISTRIBUTE ITS CONTENTS, OR TO  MANUFACTURE,  USE,  OR  SELL  ANYTHING
+ * THAT      IT     MAY     DESCRIBE,     IN     WHOLE     OR     IN     PART
+ *
+ */
+#ifndef HUPSTER_DETECTION_DEPTH_ROI_STATS_H_
+#define HUPSTER_DETECTION_DEPTH_ROI_STATS_H_
+
+#include <algorithm>
+#include <cmath>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+#include <opencv2/core/core.hpp>
+#include <image_geometry/pinhole_camera_model.h>
+
+
+/**
+ * Range and 3D centroid of an object from the depth pixels of its ROI.
+ *
+ * The range is a robust estimate over a histogram of the ROI depths, the
+ * centroid is accumulated only over pixels within inlierBand of it, so
+ * background and floor pixels around the object are left out. Rays of the
+ * pixel columns and rows are precomputed, and rows are subsampled to at
+ * most maxSamples pixels, so the cost does not grow with the ROI size.
+ */
+class DepthRoiStats {
+
+public:
+
+    enum RangeEstimator {
+        RANGE_MEAN,
+        RANGE_MEDIAN,
+        RANGE_TRIMMED_MEAN,
+        RANGE_HISTOGRAM_MODE
+    };
+
+    struct Result {
+
+        Result()
+            : valid(false), range(0), centroid(0, 0, 0), samples(0), inliers(0) {
+        }
+
+        bool valid;
+
+        /**
+         * Robust depth of the object [m]
+         */
+        double range;
+
+        /**
+         * Mean of the inlier points in the optical frame of the camera [m]
+         */
+        cv::Point3d centroid;
+
+        int samples;
+
+        int inliers;
+    };
+
+public:
+
+    DepthRoiStats()
+        : estimator_(RANGE_MEDIAN), depthScale_(0.001), binSize_(0.02),
+          maxDepth_(10.0), inlierBand_(0.3), trimRatio_(0.2),
+          maxSamples_(4096) {
+    }
+
+    virtual ~DepthRoiStats() {
+
+    }
+
+public:
+
+    /**
+     * Parses one of 'mean', 'median', 'trimmed_mean' and 'histogram_mode'
+     * @return false if the name is unknown
+     */
+    static bool parseEstimator(const std::string& name, RangeEstimator& estimator) {
+        if (name == "mean") {
+            estimator = RANGE_MEAN;
+        } else if (name == "median") {
+            estimator = RANGE_MEDIAN;
+        } else if (name == "trimmed_mean") {
+            estimator = RANGE_TRIMMED_MEAN;
+        } else if (name == "histogram_mode") {
+            estimator = RANGE_HISTOGRAM_MODE;
+        } else {
+            return false;
+        }
+        return true;
+    }
+
+    void setEstimator(RangeEstimator estimator) {
+        estimator_ = estimator;
+    }
+
+    /**
+     * @param depthScale Meters per depth image unit
+     */
+    void setDepthScale(double depthScale) {
+        depthScale_ = depthScale;
+    }
+
+    /**
+     * @param binSize Histogram bin size [m]
+     * @param maxDepth Depths beyond it are ignored [m]
+     */
+    void setHistogram(double binSize, double maxDepth) {
+        binSize_ = binSize;
+        maxDepth_ = maxDepth;
+    }
+
+    /**
+     * @param inlierBand Max distance of centroid points from the range [m]
+     */
+    void setInlierBand(double inlierBand) {
+        inlierBand_ = inlierBand;
+    }
+
+    /**
+     * @param trimRatio Ratio of samples dropped at each end by the trimmed mean
+     */
+    void setTrimRatio(double trimRatio) {
+        trimRatio_ = std::min(std::max(trimRatio, 0.0), 0.49);
+    }
+
+    void setMaxSamples(int maxSamples) {
+        maxSamples_ = std::max(maxSamples, 1);
+    }
+
+    /**
+     * Precomputes the rays of the pixel columns and rows, the same as
+     * PinholeCameraModel::projectPixelTo3dRay
+     */
+    void updateCameraModel(const image_geometry::PinholeCameraModel& cameraModel) {
+        cv::Size resolution = cameraModel.fullResolution();
+
+        columnRays_.resize(resolution.width);
+        for (int u = 0; u < resolution.width; u++) {
+            columnRays_[u] = (u - cameraModel.cx() - cameraModel.Tx()) / cameraModel.fx();
+        }
+
+        rowRays_.resize(resolution.height);
+        for (int v = 0; v < resolution.height; v++) {
+            rowRays_[v] = (v - cameraModel.cy() - cameraModel.Ty()) / cameraModel.fy();
+        }
+    }
+
+    bool initialized() const {
+        return !columnRays_.empty();
+    }
+
+    /**
+     * @param depthImage 16UC1 depth image of the camera model resolution
+     * @param roi Object region, clipped to the image
+     */
+    Result compute(const cv::Mat& depthImage, const cv::Rect& roi) {
+        Result result;
+
+        if (depthImage.type() != CV_16UC1 ||
+                depthImage.cols != (int)columnRays_.size() ||
+                depthImage.rows != (int)rowRays_.size()) {
+            return result;
+        }
+
+        cv::Rect clipped = roi & cv::Rect(0, 0, depthImage.cols, depthImage.rows);
+        if (clipped.area() <= 0) {
+            return result;
+        }
+
+        int rowStep = std::max(1, (int)std::ceil(
+                (double)clipped.area() / maxSamples_));
+
+        //
+        // Robust range from the histogram of the sampled depths
+        //
+        result.samples = fillHistogram(depthImage, clipped, rowStep);
+        if (result.samples == 0) {
+            return result;
+        }
+
+        double range = estimateRange(result.samples);
+        result.range = range * depthScale_;
+
+        //
+        // Centroid of the pixels around that range
+        //
+        double band = inlierBand_ / depthScale_;
+        uint16_t low = (uint16_t)std::max(1.0, std::floor(range - band));
+        uint16_t high = (uint16_t)std::min(65535.0, std::ceil(range + band));
+
+        double sumDepth = 0;
+        double sumColumnRayDepth = 0;
+        double sumRowRayDepth = 0;
+        int inliers = 0;
+
+        for (int v = clipped.y; v < clipped.y + clipped.height; v += rowStep) {
+            float rowDepth = 0;
+            float rowColumnRayDepth = 0;
+            int rowInliers = accumulateRow(depthImage.ptr<uint16_t>(v),
+                    clipped.x, clipped.x + clipped.width, low, high,
+                    rowDepth, rowColumnRayDepth);
+
+            sumDepth += rowDepth;
+            sumColumnRayDepth += rowColumnRayDepth;
+            sumRowRayDepth += (double)rowRays_[v] * rowDepth;
+            inliers += rowInliers;
+        }
+
+        if (inliers == 0) {
+            return result;
+        }
+
+        result.valid = true;
+        result.inliers = inliers;
+        result.centroid = cv::Point3d(sumColumnRayDepth, sumRowRayDepth, sumDepth) *
+                (depthScale_ / inliers);
+
+        return result;
+    }
+
+private:
+
+    int fillHistogram(const cv::Mat& depthImage, const cv::Rect& roi, int rowStep) {
+        binDepth_ = std::max(1, (int)std::lround(binSize_ / depthScale_));
+        int maxDepth = (int)std::min(65536.0, maxDepth_ / depthScale_);
+
+        size_t binsCount = maxDepth / binDepth_ + 1;
+        binCounts_.assign(binsCount, 0);
+        binSums_.assign(binsCount, 0);
+
+        int samples = 0;
+
+        for (int v = roi.y; v < roi.y + roi.height; v += rowStep) {
+            const uint16_t* row = depthImage.ptr<uint16_t>(v);
+            for (int u = roi.x; u < roi.x + roi.width; u++) {
+                int depth = row[u];
+                if (depth == 0 || depth >= maxDepth) {
+                    continue;
+                }
+                int bin = depth / binDepth_;
+                binCounts_[bin]++;
+                binSums_[bin] += depth;
+                samples++;
+            }
+        }
+
+        return samples;
+    }
+
+    /**
+     * @return Range in depth image units
+     */
+    double estimateRange(int samples) const {
+        switch (estimator_) {
+
+            case RANGE_MEAN: {
+                double sum = 0;
+                for (size_t bin = 0; bin < binSums_.size(); bin++) {
+                    sum += binSums_[bin];
+                }
+                return sum / samples;
+            }
+
+            case RANGE_MEDIAN: {
+                int cumulative = 0;
+                for (size_t bin = 0; bin < binCounts_.size(); bin++) {
+                    cumulative += binCounts_[bin];
+                    if (2 * cumulative > samples) {
+                        return binMean(bin);
+                    }
+                }
+                break;
+            }
+
+            case RANGE_TRIMMED_MEAN: {
+                //
+                // Samples [begin, end) of the sorted order are kept, a bin
+                // partially kept contributes with its mean
+                //
+                double begin = samples * trimRatio_;
+                double end = samples - begin;
+                double sum = 0;
+                double weight = 0;
+                int cumulative = 0;
+                for (size_t bin = 0; bin < binCounts_.size(); bin++) {
+                    double first = std::max<double>(cumulative, begin);
+                    cumulative += binCounts_[bin];
+                    double last = std::min<double>(cumulative, end);
+                    if (last > first) {
+                        sum += (last - first) * binMean(bin);
+                        weight += last - first;
+                    }
+                }
+                if (weight > 0) {
+                    return sum / weight;
+                }
+                break;
+            }
+
+            case RANGE_HISTOGRAM_MODE: {
+                //
+                // Densest window of 3 bins, robust to a depth edge splitting
+                // the object into neighbouring bins
+                //
+                size_t best = 0;
+                int bestCount = -1;
+                for (size_t bin = 0; bin < binCounts_.size(); bin++) {
+                    int count = windowCount(bin);
+                    if (count > bestCount) {
+                        bestCount = count;
+                        best = bin;
+                    }
+                }
+                double sum = 0;
+                for (size_t bin = best > 0 ? best - 1 : 0;
+                        bin <= best + 1 && bin < binSums_.size(); bin++) {
+                    sum += binSums_[bin];
+                }
+                return sum / bestCount;
+            }
+        }
+
+        return 0;
+    }
+
+    double binMean(size_t bin) const {
+        return binCounts_[bin] > 0 ? binSums_[bin] / binCounts_[bin] :
+                (bin + 0.5) * binDepth_;
+    }
+
+    int windowCount(size_t bin) const {
+        int count = binCounts_[bin];
+        if (bin > 0) {
+            count += binCounts_[bin - 1];
+        }
+        if (bin + 1 < binCounts_.size()) {
+            count += binCounts_[bin + 1];
+        }
+        return count;
+    }
+
+    /**
+     * Sums depth and column ray * depth of the pixels in [low, high] of
+     * columns [begin, end) of a row
+     * @return Number of these pixels
+     */
+    int accumulateRow(const uint16_t* row, int begin, int end,
+            uint16_t low, uint16_t high, float& sumDepth, float& sumRayDepth) const {
+        const float* rays = columnRays_.data();
+        int inliers = 0;
+        int u = begin;
+        sumDepth = 0;
+        sumRayDepth = 0;
+
+#ifdef __SSE2__
+        //
+        // 8 pixels at once, a pixel is in [low, high] when
+        // saturate(pixel - low - (high - low)) == 0, with pixel - low wrapping
+        //
+        const __m128i zero = _mm_setzero_si128();
+        const __m128i lowVector = _mm_set1_epi16((short)low);
+        const __m128i spanVector = _mm_set1_epi16((short)(high - low));
+        __m128i inlierCounts = zero;
+        __m128 depthSums = _mm_setzero_ps();
+        __m128 rayDepthSums = _mm_setzero_ps();
+
+        for (; u + 8 <= end; u += 8) {
+            __m128i depth = _mm_loadu_si128((const __m128i*)(row + u));
+            __m128i inlier = _mm_cmpeq_epi16(_mm_subs_epu16(
+                    _mm_sub_epi16(depth, lowVector), spanVector), zero);
+            depth = _mm_and_si128(depth, inlier);
+            inlierCounts = _mm_sub_epi16(inlierCounts, inlier);
+
+            __m128 depthLow = _mm_cvtepi32_ps(_mm_unpacklo_epi16(depth, zero));
+            __m128 depthHigh = _mm_cvtepi32_ps(_mm_unpackhi_epi16(depth, zero));
+            depthSums = _mm_add_ps(depthSums, _mm_add_ps(depthLow, depthHigh));
+            rayDepthSums = _mm_add_ps(rayDepthSums, _mm_add_ps(
+                    _mm_mul_ps(depthLow, _mm_loadu_ps(rays + u)),
+                    _mm_mul_ps(depthHigh, _mm_loadu_ps(rays + u + 4))));
+        }
+
+        float depthLanes[4];
+        float rayDepthLanes[4];
+        uint16_t countLanes[8];
+        _mm_storeu_ps(depthLanes, depthSums);
+        _mm_storeu_ps(rayDepthLanes, rayDepthSums);
+        _mm_storeu_si128((__m128i*)countLanes, inlierCounts);
+
+        for (int lane = 0; lane < 4; lane++) {
+            sumDepth += depthLanes[lane];
+            sumRayDepth += rayDepthLanes[lane];
+        }
+        for (int lane = 0; lane < 8; lane++) {
+            inliers += countLanes[lane];
+        }
+#endif
+
+        for (; u < end; u++) {
+            uint16_t depth = row[u];
+            if (depth >= low && depth <= high) {
+                sumDepth += depth;
+                sumRayDepth += rays[u] * depth;
+                inliers++;
+            }
+        }
+
+        return inliers;
+    }
+
+private:
+
+    RangeEstimator estimator_;
+
+    double depthScale_;
+
+    double binSize_;
+
+    double maxDepth_;
+
+    double inlierBand_;
+
+    double trimRatio_;
+
+    int maxSamples_;
+
+    std::vector<float> columnRays_;
+
+    std::vector<float> rowRays_;
+
+    int binDepth_ = 1;
+
+    std::vector<int> binCounts_;
+
+    std::vector<double> binSums_;
+
+};
+
+#endif /* HUPSTER_DETECTION_DEPTH_ROI_STATS_H_ */
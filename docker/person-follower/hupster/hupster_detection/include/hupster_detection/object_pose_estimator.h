@@ -0,0 +1,249 @@
+/*
+ * object_pose_estimator.h
+ *
+ *  Created on: May 13, 2019
+ *      Author: Igor Makhtes <igor@cogniteam.com>
+ *
+ *
+ * Cogniteam LTD CONFIDENTIAL
+ *
+ * Unpublished Copyright (c) 2016-2017 Cogniteam,        All Rights Reserved.
+ *
+ * NOTICE:  All information contained  herein  is,  and  remains the property
+ * of Cogniteam.   The   intellectual   and   technical   concepts  contained
+ * herein are proprietary to Cogniteam and may  be  covered  by  Israeli  and
+ * Foreign Patents, patents in process,  and  are  protected  by trade secret
+ * or copyright law. Dissemination of  this  information  or  reproduction of
+ * this material is strictly forbidden unless  prior  written  permission  is
+ * obtained  from  Cogniteam.  Access  to  the  source  code contained herein
+ * is hereby   forbidden   to   anyone  except  current  Cogniteam employees,
+ * managers   or   contractors   who   have   executed   Confidentiality  and
+ * Non-disclosure    agreements    explicitly    covering     such     access
+ *
+ * The copyright notice  above  does  not  evidence  any  actual  or intended
+ * publication  or  disclosure    of    this  source  code,   which  includes
+ * information that is confidential  and/or  proprietary,  and  is  a   trade
+ * secret, of   Cogniteam.    ANY REPRODUCTION,  MODIFICATION,  DISTRIBUTION,
+ * PUBLIC   PERFORMANCE,  OR  PUBLIC  DISPLAY  OF  OR  THROUGH USE   OF  THIS
+ * SOURCE  CODE   WITHOUT   THE  EXPRESS  WRITTEN  CONSENT  OF  Cogniteam  IS
+ * STRICTLY PROHIBITED, AND IN VIOLATION OF APPLICABLE LAWS AND INTERNATIONAL
+ * TREATIES.  THE RECEIPT OR POSSESSION OF  THIS SOURCE  CODE  AND/OR RELATED
+ * INFORMATION DOES  NOT CONVEY OR IMPLY ANY RIGHTS  TO  REPRODUCE,  DISCLOSE
+ * OR  DISTRIBUTE ITS CONTENTS, OR TO  MANUFACTURE,  USE,  OR  SELL  ANYTHING
+ * THAT      IT     MAY     DESCRIBE,     IN     WHOLE     OR     IN     PART
+ *
+ */
+
+#ifndef HUPSTER_DETECTION_OBJECT_POSE_ESTIMATOR_H_
+#define HUPSTER_DETECTION_OBJECT_POSE_ESTIMATOR_H_
+
+#include <cmath>
+#include <deque>
+
+#include <opencv2/highgui/highgui.hpp>
+
+#include <ros/ros.h>
+#include <tf/tf.h>
+#include <depth_image_proc/depth_conversions.h>
+#include <image_transport/image_transport.h>
+#include <cv_bridge/cv_bridge.h>
+#include <image_geometry/pinhole_camera_model.h>
+#include <object_msgs/ObjectsInBoxes.h>
+#include <visualization_msgs/MarkerArray.h>
+
+#include <hupster_detection/depth_roi_stats.h>
+
+
+class ObjectPoseEstimator {
+
+public:
+
+    /**
+     * @param node Node handle of the subscribed and published topics
+     * @param nodePrivate Node handle of the parameters
+     */
+    ObjectPoseEstimator(ros::NodeHandle node, ros::NodeHandle nodePrivate) {
+
+        std::string rangeEstimator;
+        double inlierBand;
+        double histogramBin;
+        int maxSamples;
+
+        nodePrivate.param("range_estimator", rangeEstimator, std::string("median"));
+        nodePrivate.param("inlier_band", inlierBand, 0.3);
+        nodePrivate.param("histogram_bin", histogramBin, 0.02);
+        nodePrivate.param("max_samples", maxSamples, 4096);
+        nodePrivate.param("depth_buffer_size", depthBufferSize_, 15);
+        nodePrivate.param("max_stamp_offset", maxStampOffset_, 0.05);
+
+        DepthRoiStats::RangeEstimator estimator;
+        if (!DepthRoiStats::parseEstimator(rangeEstimator, estimator)) {
+            ROS_WARN("Unknown range estimator '%s', using median", rangeEstimator.c_str());
+            estimator = DepthRoiStats::RANGE_MEDIAN;
+        }
+
+        depthStats_.setEstimator(estimator);
+        depthStats_.setInlierBand(inlierBand);
+        depthStats_.setHistogram(histogramBin, 10.0);
+        depthStats_.setMaxSamples(maxSamples);
+
+        image_transport::ImageTransport it(node);
+
+        depthSubscriber_ = it.subscribe("camera/aligned_depth_to_color/image_raw", 1,
+                &ObjectPoseEstimator::depthCallback, this);
+
+        objectSubscriber_ = node.subscribe("openvino_toolkit/detected_objects", 1,
+                &ObjectPoseEstimator::detectedObjectsCallback, this);
+
+        cameraInfoSubscriber_ = node.subscribe("camera/color/camera_info", 1,
+                &ObjectPoseEstimator::cameraInfoCallback, this);
+
+        markerPublisher_ = node.advertise<visualization_msgs::MarkerArray>(
+                "detected_objects", 10, true);
+        
+    }
+
+    virtual ~ObjectPoseEstimator() {
+
+    }
+
+private:
+
+    void cameraInfoCallback(const sensor_msgs::CameraInfo::ConstPtr& cameraInfo) {
+        if (cameraModel_.fromCameraInfo(*cameraInfo)) {
+            depthStats_.updateCameraModel(cameraModel_);
+        }
+    }
+
+    void depthCallback(const sensor_msgs::Image::ConstPtr& depthImage) {
+
+        //
+        // Keep the message alive along with the image sharing its buffer
+        //
+        depthFrames_.push_back(cv_bridge::toCvShare(depthImage));
+
+        while (depthFrames_.size() > (size_t)std::max(depthBufferSize_, 1)) {
+            depthFrames_.pop_front();
+        }
+    }
+
+    /**
+     * Depth frame closest in time to the stamp, or null if none is within
+     * max_stamp_offset
+     */
+    cv_bridge::CvImageConstPtr findDepthFrame(const ros::Time& stamp) const {
+        cv_bridge::CvImageConstPtr closest;
+        double closestOffset = maxStampOffset_;
+
+        for (auto&& frame : depthFrames_) {
+            double offset = fabs((frame->header.stamp - stamp).toSec());
+            if (offset <= closestOffset) {
+                closestOffset = offset;
+                closest = frame;
+            }
+        }
+
+        return closest;
+    }
+
+    void detectedObjectsCallback(const object_msgs::ObjectsInBoxes::ConstPtr& objects) {
+
+        if (!cameraModel_.initialized() || depthFrames_.empty()) {
+            return;
+        }
+
+        //
+        // Depth of the same moment as the detections, not the latest one
+        //
+        auto depthFrame = findDepthFrame(objects->header.stamp);
+
+        if (!depthFrame) {
+            ROS_WARN_THROTTLE(1.0, "No depth frame within %f sec of the detections "
+                    "[%f], latest depth [%f]", maxStampOffset_, objects->header.stamp.toSec(),
+                    depthFrames_.back()->header.stamp.toSec());
+            return;
+        }
+
+        const cv::Mat& depthImage = depthFrame->image;
+
+        //
+        // Published by pointer, in-process subscribers get it without a copy
+        //
+        visualization_msgs::MarkerArray::Ptr markers(new visualization_msgs::MarkerArray());
+
+        for (auto&& object : objects->objects_vector) {
+
+            int OFFSET_X = object.roi.width * 0.4;
+            int OFFSET_Y = object.roi.height * 0.4;
+
+            cv::Rect roi(object.roi.x_offset + OFFSET_X, object.roi.y_offset + OFFSET_Y,
+                    object.roi.width - 2 * OFFSET_X, object.roi.height - 2 * OFFSET_Y);
+
+            auto stats = depthStats_.compute(depthImage, roi);
+
+            if (stats.valid) {
+
+                auto centerOfMass = stats.centroid;
+
+                cv::Point2d centerPixel(object.roi.x_offset + object.roi.width / 2, 
+                        object.roi.y_offset + object.roi.height / 2);
+                auto objectRay = cameraModel_.projectPixelTo3dRay(centerPixel);
+                double bearing = atan2(objectRay.z, -objectRay.x);
+                // The centroid is metric, its norm is the euclidean range
+                double distance = cv::norm(centerOfMass) - 0.6;
+
+                tf::Vector3 objectVector(distance * sin(bearing), 
+                        distance * cos(bearing), 0);
+
+                ROS_INFO("%s at [%f, %f, %f]", object.object.object_name.c_str(), 
+                        centerOfMass.x, centerOfMass.y, centerOfMass.z);
+
+                visualization_msgs::Marker marker;
+                marker.lifetime = ros::Duration(0.2);
+                marker.action = visualization_msgs::Marker::ADD;
+                marker.type = visualization_msgs::Marker::TEXT_VIEW_FACING;
+                marker.header.frame_id = cameraModel_.tfFrame();
+                marker.header.stamp = objects->header.stamp;
+                marker.id = rand();
+                marker.pose.orientation.w = 1.0;
+                marker.pose.position.x = -objectVector.y();
+                marker.pose.position.y = 0;
+                marker.pose.position.z = objectVector.x();
+                marker.scale.z = 0.1;
+                marker.color.a = 1.0;
+                marker.color.r = 1.0;
+                marker.text = object.object.object_name;
+
+                markers->markers.push_back(marker);
+            }
+
+        }
+
+        markerPublisher_.publish(markers);
+
+    }
+
+private:
+
+    image_transport::Subscriber depthSubscriber_;
+
+    ros::Subscriber objectSubscriber_;
+
+    ros::Subscriber cameraInfoSubscriber_;
+
+    ros::Publisher markerPublisher_;
+
+    image_geometry::PinholeCameraModel cameraModel_;
+
+    DepthRoiStats depthStats_;
+
+    std::deque<cv_bridge::CvImageConstPtr> depthFrames_;
+
+    int depthBufferSize_;
+
+    double maxStampOffset_;
+
+};
+
+
+#endif /* HUPSTER_DETECTION_OBJECT_POSE_ESTIMATOR_H_ */
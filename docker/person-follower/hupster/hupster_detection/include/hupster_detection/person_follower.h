@@ -0,0 +1,446 @@
+/*
+ * person_follower.h
+ *
+ *  Created on: May 13, 2019
+ *      Author: Igor Makhtes <igor@cogniteam.com>
+ *
+ *
+ * Cogniteam LTD CONFIDENTIAL
+ *
+ * Unpublished Copyright (c) 2016-2017 Cogniteam,        All Rights Reserved.
+ *
+ * NOTICE:  All information contained  herein  is,  and  remains the property
+ * of Cogniteam.   The   intellectual   and   technical   concepts  contained
+ * herein are proprietary to Cogniteam and may  be  covered  by  Israeli  and
+ * Foreign Patents, patents in process,  and  are  protected  by trade secret
+ * or copyright law. Dissemination of  this  information  or  reproduction of
+ * this material is strictly forbidden unless  prior  written  permission  is
+ * obtained  from  Cogniteam.  Access  to  the  source  code contained herein
+ * is hereby   forbidden   to   anyone  except  current  Cogniteam employees,
+ * managers   or   contractors   who   have   executed   Confidentiality  and
+ * Non-disclosure    agreements    explicitly    covering     such     access
+ *
+ * The copyright notice  above  does  not  evidence  any  actual  or intended
+ * publication  or  disclosure    of    this  source  code,   which  includes
+ * information that is confidential  and/or  proprietary,  and  is  a   trade
+ * secret, of   Cogniteam.    ANY REPRODUCTION,  MODIFICATION,  DISTRIBUTION,
+ * PUBLIC   PERFORMANCE,  OR  PUBLIC  DISPLAY  OF  OR  THROUGH USE   OF  THIS
+ * SOURCE  CODE   WITHOUT   THE  EXPRESS  WRITTEN  CONSENT  OF  Cogniteam  IS
+ * STRICTLY PROHIBITED, AND IN VIOLATION OF APPLICABLE LAWS AND INTERNATIONAL
+ * TREATIES.  THE RECEIPT OR POSSESSION OF  THIS SOURCE  CODE  AND/OR RELATED
+ * INFORMATION DOES  NOT CONVEY OR IMPLY ANY RIGHTS  TO  REPRODUCE,  DISCLOSE
+ * OR  DISTRIBUTE ITS CONTENTS, OR TO  MANUFACTURE,  USE,  OR  SELL  ANYTHING
+ * THAT      IT     MAY     DESCRIBE,     IN     WHOLE     OR     IN     PART
+ *
+ */
+
+#ifndef HUPSTER_DETECTION_PERSON_FOLLOWER_H_
+#define HUPSTER_DETECTION_PERSON_FOLLOWER_H_
+
+#include <ros/ros.h>
+#include <tf/tf.h>
+#include <std_msgs/Bool.h>
+#include <tf/transform_listener.h>
+#include <angles/angles.h>
+#include <visualization_msgs/MarkerArray.h>
+#include <ackermann_msgs/AckermannDriveStamped.h>
+#include <object_msgs/ObjectInBox.h>
+#include <geometry_msgs/Twist.h>
+
+#include <algorithm>
+#include <map>
+#include <string>
+#include <vector>
+
+#include <hupster_detection/person_tracker.h>
+
+
+class PersonFollower {
+
+public:
+
+    /**
+     * @param node Node handle of the topics, timer and publishers
+     * @param nodePrivate Node handle of the parameters
+     */
+    PersonFollower(ros::NodeHandle node, ros::NodeHandle nodePrivate)
+        : target_(0, 0, 0), targetInTrackingFrame_(0, 0, 0) {
+
+        nodePrivate.param("min_distance", minDistance_, 1.5);
+        nodePrivate.param("max_distance", maxDistance_, 5.0);
+        nodePrivate.param("max_speed", maxSpeed_, 110.0);
+        nodePrivate.param("min_speed", minSpeed_, 110.0);
+        nodePrivate.param("steering_factor", steeringFactor_, 3.0);
+        nodePrivate.param("enable", enable_, false);
+        nodePrivate.param("zero_speed", zeroSpeed_, true);
+        nodePrivate.param("base_frame", baseFrame_, std::string("camera_link"));
+        nodePrivate.param("target", trackingTarget_, std::string("person"));
+        nodePrivate.param("tracking_frame", trackingFrame_, std::string("odom"));
+        nodePrivate.param("transform_timeout", transformTimeout_, 0.5);
+
+        double maxAssociationDistance;
+        double trackTimeout;
+        int minHits;
+        double accelerationNoise;
+        double measurementNoise;
+
+        nodePrivate.param("max_association_distance", maxAssociationDistance, 1.0);
+        nodePrivate.param("track_timeout", trackTimeout, 1.0);
+        nodePrivate.param("track_min_hits", minHits, 2);
+        nodePrivate.param("acceleration_noise", accelerationNoise, 2.0);
+        nodePrivate.param("measurement_noise", measurementNoise, 0.15);
+
+        tracker_.setAssociation(maxAssociationDistance, trackTimeout, minHits);
+        tracker_.setNoise(accelerationNoise, measurementNoise);
+
+        detectedObjectsSubscriber_ = node.subscribe("detected_objects", 1, 
+                &PersonFollower::detectedObjectsCallback, this);
+
+        enableSubscriber_ = node.subscribe("commands/person_follower/enable", 1, 
+                &PersonFollower::enableCallback, this);
+
+        commandPublisher_ = node.advertise<ackermann_msgs::AckermannDriveStamped>(
+                "ackermann_cmd", 1, true);
+
+        twistCommandPublisher_ = node.advertise<geometry_msgs::Twist>("mobile_base/commands/velocity", 1, false);
+                        
+        statePublisher_ = node.advertise<std_msgs::Bool>(
+                "events/person_follower/state", 1, true);
+                        
+        targetPublisher_ = node.advertise<geometry_msgs::PoseStamped>(
+                "debug/person_follower/target", 1, false);
+
+        updateTimer_ = node.createTimer(ros::Rate(20), 
+                &PersonFollower::updateTimerCallback, this);
+
+        lastTargetUpdateTime_ = ros::Time::now() - ros::Duration(1000);
+
+        publishState();
+    }
+
+    virtual ~PersonFollower() {
+
+    }
+
+private:
+
+    void publishState() {
+        std_msgs::Bool state;
+        state.data = enable_;
+        statePublisher_.publish(state);
+    }
+
+    void detectedObjectsCallback(const visualization_msgs::MarkerArray::ConstPtr& objects) {
+
+        //
+        // All detected persons in the tracking frame, one transform lookup
+        // per source frame
+        //
+        std::vector<tf::Vector3> detections;
+        ros::Time stamp = ros::Time::now();
+
+        for (auto&& object : objects->markers) {
+
+            if (object.text != trackingTarget_) {
+                continue;
+            }
+
+            tf::StampedTransform transform;
+
+            if (!lookupTransform(trackingFrame_, object.header.frame_id, 
+                    object.header.stamp, transform)) {
+                continue;
+            }
+
+            tf::Vector3 position;
+            tf::pointMsgToTF(object.pose.position, position);
+            detections.push_back(transform * position);
+            stamp = object.header.stamp;
+        }
+
+        auto updatedIds = tracker_.update(detections, stamp);
+
+        //
+        // Keep following the same person, otherwise pick the confirmed
+        // track closest to the previous target
+        //
+        const PersonTracker::Track* target = tracker_.find(targetId_);
+
+        if (!target) {
+            target = tracker_.findClosest(targetInTrackingFrame_, stamp);
+            targetId_ = target ? target->id : -1;
+        }
+
+        //
+        // Person found, continue following
+        //
+        if (target && tracker_.isConfirmed(*target) &&
+                std::find(updatedIds.begin(), updatedIds.end(), target->id) != updatedIds.end()) {
+            targetInTrackingFrame_ = target->filter.position(stamp);
+            updateTarget(*target);
+        } else {
+            targetPublisher_.publish(geometry_msgs::PoseStamped());
+        }
+
+    }
+
+    void enableCallback(const std_msgs::Bool::ConstPtr& enable) {
+        enable_ = enable->data;
+
+        publishState();
+    }
+
+    /**
+     * Transform at the stamp if available, the latest one otherwise, never
+     * waits for tf. The last transform of each frame pair is kept and used
+     * while tf has none within transform_timeout.
+     */
+    bool lookupTransform(const std::string& targetFrame, const std::string& sourceFrame,
+            const ros::Time& stamp, tf::StampedTransform& transform) {
+
+        auto&& cached = transformCache_[sourceFrame + " -> " + targetFrame];
+
+        try {
+            if (tfListener_.canTransform(targetFrame, sourceFrame, stamp)) {
+                tfListener_.lookupTransform(targetFrame, sourceFrame, stamp, transform);
+            } else {
+                tfListener_.lookupTransform(targetFrame, sourceFrame, ros::Time(0), transform);
+            }
+
+            cached = transform;
+            return true;
+
+        } catch (const tf::TransformException& e) {
+
+            //
+            // Static transforms have a zero stamp and never expire
+            //
+            if (cached.frame_id_ == targetFrame && (cached.stamp_.isZero() ||
+                    fabs((stamp - cached.stamp_).toSec()) <= transformTimeout_)) {
+                transform = cached;
+                return true;
+            }
+
+            ROS_ERROR_THROTTLE(1.0, "Failed to transform from %s to %s: %s", 
+                    sourceFrame.c_str(), targetFrame.c_str(), e.what());
+            return false;
+        }
+    }
+
+    void updateTarget(const PersonTracker::Track& target) {
+        ROS_INFO("Target %i updated [%f, %f]", target.id, 
+                targetInTrackingFrame_.x(), targetInTrackingFrame_.y());
+        lastTargetUpdateTime_ = ros::Time::now();
+
+        geometry_msgs::PoseStamped targetMsg;
+        targetMsg.header.frame_id = trackingFrame_;
+        targetMsg.header.stamp = ros::Time::now();
+        targetMsg.pose.position.x = targetInTrackingFrame_.x();
+        targetMsg.pose.position.y = targetInTrackingFrame_.y();
+        targetMsg.pose.orientation.w = 1.0;
+        targetPublisher_.publish(targetMsg);
+    }
+
+    /**
+     * Position of the target track predicted to now, in the base frame
+     */
+    bool predictTarget(tf::Vector3& target) {
+        const PersonTracker::Track* track = tracker_.find(targetId_);
+
+        if (!track) {
+            return false;
+        }
+
+        ros::Time now = ros::Time::now();
+        tf::Vector3 predicted = track->filter.position(now);
+
+        if (trackingFrame_ == baseFrame_) {
+            target = predicted;
+            return true;
+        }
+
+        tf::StampedTransform transform;
+
+        if (!lookupTransform(baseFrame_, trackingFrame_, now, transform)) {
+            return false;
+        }
+
+        target = transform * predicted;
+        target.setZ(0);
+
+        return true;
+    }
+
+    void updateTimerCallback(const ros::TimerEvent&) {
+
+        //
+        // Stop the robot if there were no detections for this amount of time
+        //
+        const ros::Duration detectionTimeout(0.3);
+
+        auto lastDetectionAge = ros::Time::now() - lastTargetUpdateTime_;
+        
+        if (lastDetectionAge > detectionTimeout) {
+
+            if (detectionActive_) {
+                ROS_WARN("Person lost, stopping");
+                publishCommand(0, 0);
+                detectionActive_ = false;
+            } else {
+                // Waiting for detections...
+                ROS_INFO_THROTTLE(1.0, "Waiting for detections...");
+            }
+
+            publishCommand(0, 0);
+
+            return;
+
+        } else {
+            detectionActive_ = true;
+        }
+
+        //
+        // Steer toward where the person is now, not where it was detected
+        //
+        if (!predictTarget(target_)) {
+            publishCommand(0, 0);
+            return;
+        }
+
+        //
+        // Calculate velocity command
+        //
+
+        double distanceToTarget = target_.length();
+
+        //
+        // Compute speed 
+        //
+
+        // Ease in and out function (from min speed to max speed)
+
+        // Range [0, 1]
+        double targetDistanceRatio = (distanceToTarget - minDistance_) / (maxDistance_ - minDistance_);
+        double speedRange = maxSpeed_ - minSpeed_;
+        double easeFunction = -0.5 * (cos(M_PI * targetDistanceRatio) - 1);
+        double speed = minSpeed_ + speedRange * easeFunction;
+        
+        // 
+        // Person is too close
+        //
+        if (distanceToTarget < minDistance_) {
+            ROS_INFO("Person is close, stop [%f]", distanceToTarget);
+            speed = 0.0;
+        }
+
+        //
+        // Person is too far
+        //
+        if (distanceToTarget > maxDistance_) {
+            ROS_INFO("Person too far, stop [%f]", distanceToTarget);
+            speed = 0.0;
+        }
+
+        // Distance is OK - following
+
+        double bearing = atan2(target_.y(), target_.x());
+        double steeringAngle = angles::to_degrees(bearing) * steeringFactor_;
+
+        ROS_INFO("Following [Distance = %f, Angle = %i]", distanceToTarget, (int)angles::to_degrees(bearing));
+
+        publishCommand(speed, steeringAngle);
+
+    }
+
+    void publishCommand(double speed, double steeringAngle) {
+
+        if (!enable_) {
+            return;
+        }
+
+        ackermann_msgs::AckermannDriveStamped cmd;
+        cmd.header.stamp = ros::Time::now();
+
+        if (!zeroSpeed_ && fabs(speed) < 0.001) {
+            speed = 0;
+            steeringAngle = 0;
+        }
+
+        cmd.drive.speed = speed;
+        cmd.drive.steering_angle = steeringAngle;
+        commandPublisher_.publish(cmd);
+
+        //Pengo publisher
+
+        geometry_msgs::Twist command;
+        command.linear.x = speed;
+        command.angular.z = steeringAngle;
+        twistCommandPublisher_.publish(command);
+    }
+
+private:
+
+    std::string baseFrame_ = "camera_link";
+
+private:
+
+    ros::Publisher commandPublisher_;
+
+    ros::Publisher targetPublisher_;
+
+    ros::Publisher statePublisher_;
+
+    ros::Publisher twistCommandPublisher_;
+
+    ros::Subscriber detectedObjectsSubscriber_;
+
+    ros::Subscriber enableSubscriber_;
+
+    tf::TransformListener tfListener_;
+
+    ros::Time lastTargetUpdateTime_;
+
+    /**
+     * Target predicted to the last control update, in the base frame
+     */
+    tf::Vector3 target_;
+
+    /**
+     * Target at the last detection, in the tracking frame
+     */
+    tf::Vector3 targetInTrackingFrame_;
+
+    int targetId_ = -1;
+
+    PersonTracker tracker_;
+
+    std::string trackingFrame_;
+
+    double transformTimeout_;
+
+    std::map<std::string, tf::StampedTransform> transformCache_;
+
+    ros::Timer updateTimer_;
+
+    bool detectionActive_ = false;
+
+    bool zeroSpeed_;
+
+    double minDistance_;
+
+    double maxDistance_;
+
+    double minSpeed_;
+
+    double maxSpeed_;
+
+    double steeringFactor_;
+
+    bool enable_;
+
+    std::string trackingTarget_;
+
+};
+
+
+#endif /* HUPSTER_DETECTION_PERSON_FOLLOWER_H_ */
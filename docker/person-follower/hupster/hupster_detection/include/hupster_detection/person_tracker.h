@@ -0,0 +1,349 @@
+/*
+ * person_tracker.h
+ *
+ * Cogniteam LTD CONFIDENTIAL
+ *
+ * Unpublished Copyright (c) 2016-2017 Cogniteam,        All Rights Reserved.
+ *
+ * NOTICE:  All information contained  herein  is,  and  remains the property
+ * of Cogniteam.   The   intellectual   and   technical   concepts  contained
+ * herein are proprietary to Cogniteam and may  be  covered  by  Israeli  and
+ * Foreign Patents, patents in process,  and  are  protected  by trade secret
+ * or copyright law. Dissemination of  this  information  or  reproduction of
+ * this material is strictly forbidden unless  prior  written  permission  is
+ * obtained  from  Cogniteam.  Access  to  the  source  code contained herein
+ * is hereby   forbidden   to   anyone  except  current  Cogniteam employees,
+ * managers   or   contractors   who   have   executed   Confidentiality  and
+ * Non-disclosure    agreements    explicitly    covering     such     access
+ *
+ * The copyright notice  above  does  not  evidence  any  actual  or intended
+ * publication  or  disclosure    of    this  source  code,   which  includes
+ * information that is confidential  and/or  proprietary,  and  is  a   trade
+ * secret, of   Cogniteam.    ANY REPRODUCTION,  MODIFICATION,  DISTRIBUTION,
+ * PUBLIC   PERFORMANCE,  OR  PUBLIC  DISPLAY  OF  OR  THROUGH USE   OF  THIS
+ * SOURCE  CODE   WITHOUT   THE  EXPRESS  WRITTEN  CONSENT  OF  Cogniteam  IS
+ * STRICTLY PROHIBITED, AND IN VIOLATION OF APPLICABLE LAWS AND INTERNATIONAL
+ * TREATIES.  THE RECEIPT OR POSSESSION OF  THIS SOURCE  CODE  AND/OR RELATED
+ * INFORMATION DOES  NOT CONVEY OR IMPLY ANY RIGHTS  TO  REPRODUCE,  DISCLOSE
+ * OR  DISTRIBUTE ITS CONTENTS, OR TO  MANUFACTURE,  USE,  OR  SELL  ANYTHING
+ * THAT      IT     MAY     DESCRIBE,     IN     WHOLE     OR     IN     PART
+ *
+ */
+#ifndef HUPSTER_DETECTION_PERSON_TRACKER_H_
+#define HUPSTER_DETECTION_PERSON_TRACKER_H_
+
+#include <algorithm>
+#include <vector>
+
+#include <opencv2/core/core.hpp>
+#include <ros/ros.h>
+#include <tf/tf.h>
+
+#include <hupster_detection/linear_assignment.hpp>
+
+
+/**
+ * Constant velocity Kalman filter of a position on the ground plane,
+ * state is [x, y, vx, vy]
+ */
+class ConstantVelocityFilter {
+
+public:
+
+    /**
+     * @param accelerationNoise Standard deviation of the unmodeled
+     *        acceleration [m/s^2]
+     * @param measurementNoise Standard deviation of a measured position [m]
+     */
+    ConstantVelocityFilter(const tf::Vector3& position, const ros::Time& stamp,
+            double accelerationNoise, double measurementNoise)
+        : state_(position.x(), position.y(), 0, 0), stamp_(stamp),
+          accelerationVariance_(accelerationNoise * accelerationNoise),
+          measurementVariance_(measurementNoise * measurementNoise) {
+
+        //
+        // Velocity of a new track is unknown
+        //
+        covariance_ = cv::Matx44d::zeros();
+        covariance_(0, 0) = covariance_(1, 1) = measurementVariance_;
+        covariance_(2, 2) = covariance_(3, 3) = 1.0;
+    }
+
+public:
+
+    /**
+     * Propagates the state to the stamp
+     */
+    void predict(const ros::Time& stamp) {
+        double dt = (stamp - stamp_).toSec();
+        if (dt <= 0) {
+            return;
+        }
+
+        cv::Matx44d transition = cv::Matx44d::eye();
+        transition(0, 2) = transition(1, 3) = dt;
+
+        //
+        // Piecewise white acceleration
+        //
+        double dt2 = dt * dt;
+        cv::Matx44d processNoise = cv::Matx44d::zeros();
+        processNoise(0, 0) = processNoise(1, 1) = dt2 * dt2 / 4 * accelerationVariance_;
+        processNoise(0, 2) = processNoise(2, 0) = dt2 * dt / 2 * accelerationVariance_;
+        processNoise(1, 3) = processNoise(3, 1) = dt2 * dt / 2 * accelerationVariance_;
+        processNoise(2, 2) = processNoise(3, 3) = dt2 * accelerationVariance_;
+
+        state_ = transition * state_;
+        covariance_ = transition * covariance_ * transition.t() + processNoise;
+        stamp_ = stamp;
+    }
+
+    /**
+     * Corrects the state, already predicted to the measurement stamp, with
+     * a measured position
+     */
+    void update(const tf::Vector3& position) {
+        cv::Matx22d innovationCovariance(
+                covariance_(0, 0) + measurementVariance_, covariance_(0, 1),
+                covariance_(1, 0), covariance_(1, 1) + measurementVariance_);
+
+        cv::Matx<double, 4, 2> crossCovariance;
+        for (int i = 0; i < 4; i++) {
+            crossCovariance(i, 0) = covariance_(i, 0);
+            crossCovariance(i, 1) = covariance_(i, 1);
+        }
+
+        cv::Matx<double, 4, 2> gain = crossCovariance * innovationCovariance.inv();
+        cv::Vec2d innovation(position.x() - state_[0], position.y() - state_[1]);
+
+        state_ += gain * innovation;
+
+        cv::Matx<double, 2, 4> measurement = cv::Matx<double, 2, 4>::zeros();
+        measurement(0, 0) = measurement(1, 1) = 1;
+        covariance_ = (cv::Matx44d::eye() - gain * measurement) * covariance_;
+    }
+
+    /**
+     * Position extrapolated to the stamp, without changing the state
+     */
+    tf::Vector3 position(const ros::Time& stamp) const {
+        double dt = std::max(0.0, (stamp - stamp_).toSec());
+        return tf::Vector3(state_[0] + state_[2] * dt, state_[1] + state_[3] * dt, 0);
+    }
+
+    tf::Vector3 velocity() const {
+        return tf::Vector3(state_[2], state_[3], 0);
+    }
+
+private:
+
+    cv::Vec4d state_;
+
+    cv::Matx44d covariance_;
+
+    ros::Time stamp_;
+
+    double accelerationVariance_;
+
+    double measurementVariance_;
+
+};
+
+
+/**
+ * Tracks persons on the ground plane, detections are assigned to the
+ * predicted tracks by the linear assignment solver of the demos
+ * (linear_assignment.hpp is a copy of demos/common/samples/linear_assignment.hpp)
+ */
+class PersonTracker {
+
+public:
+
+    struct Track {
+
+        Track(int id, const tf::Vector3& position, const ros::Time& stamp,
+                double accelerationNoise, double measurementNoise)
+            : id(id), filter(position, stamp, accelerationNoise, measurementNoise),
+              hits(1), lastUpdate(stamp) {
+        }
+
+        int id;
+
+        ConstantVelocityFilter filter;
+
+        /**
+         * Number of detections assigned to the track
+         */
+        int hits;
+
+        ros::Time lastUpdate;
+    };
+
+public:
+
+    PersonTracker()
+        : maxAssociationDistance_(1.0), trackTimeout_(1.0), minHits_(3),
+          accelerationNoise_(2.0), measurementNoise_(0.15), nextId_(0) {
+    }
+
+    virtual ~PersonTracker() {
+
+    }
+
+public:
+
+    /**
+     * @param maxAssociationDistance Detections farther from a predicted
+     *        track are not assigned to it [m]
+     * @param trackTimeout Tracks without detections for this time are
+     *        removed [sec]
+     * @param minHits Detections needed before a track is confirmed
+     */
+    void setAssociation(double maxAssociationDistance, double trackTimeout, int minHits) {
+        maxAssociationDistance_ = maxAssociationDistance;
+        trackTimeout_ = trackTimeout;
+        minHits_ = minHits;
+    }
+
+    /**
+     * @see ConstantVelocityFilter
+     */
+    void setNoise(double accelerationNoise, double measurementNoise) {
+        accelerationNoise_ = accelerationNoise;
+        measurementNoise_ = measurementNoise;
+    }
+
+    /**
+     * Assigns the detections of one frame to the tracks, unassigned
+     * detections start new tracks, tracks not updated for trackTimeout are
+     * removed
+     * @return Ids of the tracks updated by the detections
+     */
+    std::vector<int> update(const std::vector<tf::Vector3>& detections,
+            const ros::Time& stamp) {
+
+        std::vector<int> updatedIds;
+
+        for (auto&& track : tracks_) {
+            track.filter.predict(stamp);
+        }
+
+        std::vector<bool> assigned(detections.size(), false);
+
+        if (!tracks_.empty() && !detections.empty()) {
+
+            //
+            // Pairs farther apart than the max association distance are
+            // gated, their tracks and detections are left unassigned
+            //
+            costs_.resize(tracks_.size() * detections.size());
+
+            for (size_t t = 0; t < tracks_.size(); t++) {
+                tf::Vector3 predicted = tracks_[t].filter.position(stamp);
+                for (size_t d = 0; d < detections.size(); d++) {
+                    costs_[t * detections.size() + d] = (float)predicted.distance(
+                            tf::Vector3(detections[d].x(), detections[d].y(), 0));
+                }
+            }
+
+            assignment_.resize(tracks_.size());
+            solver_.solve(costs_.data(), tracks_.size(), detections.size(),
+                    assignment_.data(), (float)maxAssociationDistance_);
+
+            for (size_t t = 0; t < tracks_.size(); t++) {
+                if (assignment_[t] == linear_assignment::kUnassigned) {
+                    continue;
+                }
+                size_t d = assignment_[t];
+
+                tracks_[t].filter.update(detections[d]);
+                tracks_[t].hits++;
+                tracks_[t].lastUpdate = stamp;
+                assigned[d] = true;
+                updatedIds.push_back(tracks_[t].id);
+            }
+        }
+
+        for (size_t d = 0; d < detections.size(); d++) {
+            if (!assigned[d]) {
+                tracks_.push_back(Track(nextId_++, detections[d], stamp,
+                        accelerationNoise_, measurementNoise_));
+                updatedIds.push_back(tracks_.back().id);
+            }
+        }
+
+        tracks_.erase(std::remove_if(tracks_.begin(), tracks_.end(),
+                [&](const Track& track) {
+                    return (stamp - track.lastUpdate).toSec() > trackTimeout_;
+                }), tracks_.end());
+
+        return updatedIds;
+    }
+
+    /**
+     * @return Track of the id, or null if it was removed
+     */
+    const Track* find(int id) const {
+        for (auto&& track : tracks_) {
+            if (track.id == id) {
+                return &track;
+            }
+        }
+        return nullptr;
+    }
+
+    /**
+     * @return Confirmed track predicted closest to the position at the
+     *         stamp, or null if there are no confirmed tracks
+     */
+    const Track* findClosest(const tf::Vector3& position, const ros::Time& stamp) const {
+        const Track* closest = nullptr;
+        double closestDistance = 0;
+
+        for (auto&& track : tracks_) {
+            if (!isConfirmed(track)) {
+                continue;
+            }
+            double distance = track.filter.position(stamp).distance(position);
+            if (!closest || distance < closestDistance) {
+                closest = &track;
+                closestDistance = distance;
+            }
+        }
+
+        return closest;
+    }
+
+    bool isConfirmed(const Track& track) const {
+        return track.hits >= minHits_;
+    }
+
+    const std::vector<Track>& tracks() const {
+        return tracks_;
+    }
+
+private:
+
+    double maxAssociationDistance_;
+
+    double trackTimeout_;
+
+    int minHits_;
+
+    double accelerationNoise_;
+
+    double measurementNoise_;
+
+    int nextId_;
+
+    std::vector<Track> tracks_;
+
+    linear_assignment::AssignmentSolver solver_;
+
+    std::vector<float> costs_;
+
+    std::vector<int> assignment_;
+
+};
+
+#endif /* HUPSTER_DETECTION_PERSON_TRACKER_H_ */
@@ -0,0 +1,85 @@
+/*
+ * nodelets.cpp
+ *
+ * Cogniteam LTD CONFIDENTIAL
+ *
+ * Unpublished Copyright (c) 2016-2017 Cogniteam,        All Rights Reserved.
+ *
+ * NOTICE:  All information contained  herein  is,  and  remains the property
+ * of Cogniteam.   The   intellectual   and   technical   concepts  contained
+ * herein are proprietary to Cogniteam and may  be  covered  by  Israeli  and
+ * Foreign Patents, patents in process,  and  are  protected  by trade secret
+ * or copyright law. Dissemination of  this  information  or  reproduction of
+ * this material is strictly forbidden unless  prior  written  permission  is
+ * obtained  from  Cogniteam.  Access  to  the  source  code contained herein
+ * is hereby   forbidden   to   anyone  except  current  Cogniteam employees,
+ * managers   or   contractors   who   have   executed   Confidentiality  and
+ * Non-disclosure    agreements    explicitly    covering     such     access
+ *
+ * The copyright notice  above  does  not  evidence  any  actual  or intended
+ * publication  or  disclosure    of    this  source  code,   which  includes
+ * information that is confidential  and/or  proprietary,  and  is  a   trade
+ * secret, of   Cogniteam.    ANY REPRODUCTION,  MODIFICATION,  DISTRIBUTION,
+ * PUBLIC   PERFORMANCE,  OR  PUBLIC  DISPLAY  OF  OR  THROUGH USE   OF  THIS
+ * SOURCE  CODE   WITHOUT   THE  EXPRESS  WRITTEN  CONSENT  OF  Cogniteam  IS
+ * STRICTLY PROHIBITED, AND IN VIOLATION OF APPLICABLE LAWS AND INTERNATIONAL
+ * TREATIES.  THE RECEIPT OR POSSESSION OF  THIS SOURCE  CODE  AND/OR RELATED
+ * INFORMATION DOES  NOT CONVEY OR IMPLY ANY RIGHTS  TO  REPRODUCE,  DISCLOSE
+ * OR  DISTRIBUTE ITS CONTENTS, OR TO  MANUFACTURE,  USE,  OR  SELL  ANYTHING
+ * THAT      IT     MAY     DESCRIBE,     IN     WHOLE     OR     IN     PART
+ *
+ */
+
+
+#include <memory>
+
+#include <nodelet/nodelet.h>
+#include <pluginlib/class_list_macros.h>
+
+#include <hupster_detection/object_pose_estimator.h>
+#include <hupster_detection/person_follower.h>
+
+
+namespace hupster_detection {
+
+/**
+ * Runs ObjectPoseEstimator inside a nodelet manager, detections and depth
+ * images published in the same manager are received without a copy
+ */
+class ObjectPoseEstimatorNodelet : public nodelet::Nodelet {
+
+private:
+
+    virtual void onInit() {
+        estimator_.reset(new ObjectPoseEstimator(getNodeHandle(), getPrivateNodeHandle()));
+    }
+
+private:
+
+    std::unique_ptr<ObjectPoseEstimator> estimator_;
+
+};
+
+
+/**
+ * Runs PersonFollower inside a nodelet manager
+ */
+class PersonFollowerNodelet : public nodelet::Nodelet {
+
+private:
+
+    virtual void onInit() {
+        follower_.reset(new PersonFollower(getNodeHandle(), getPrivateNodeHandle()));
+    }
+
+private:
+
+    std::unique_ptr<PersonFollower> follower_;
+
+};
+
+} /* namespace hupster_detection */
+
+
+PLUGINLIB_EXPORT_CLASS(hupster_detection::ObjectPoseEstimatorNodelet, nodelet::Nodelet)
+PLUGINLIB_EXPORT_CLASS(hupster_detection::PersonFollowerNodelet, nodelet::Nodelet)